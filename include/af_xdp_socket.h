@@ -0,0 +1,57 @@
+/**
+ * @file af_xdp_socket.h
+ * @brief AF_XDP socket with an XDP program steering one UDP port into it
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <memory>
+#include <functional>
+
+/**
+ * @brief Receives the UDP datagrams of one port through AF_XDP.
+ *
+ * The UMEM is the packet pool: the handler gets a pointer to the UDP payload
+ * inside the UMEM frame, and the frame goes back to the fill ring once the
+ * batch has been handled. Only available when built with
+ * RTP_PLAYER_ENABLE_AF_XDP (libxdp + libbpf).
+ */
+class AfXdpSocket {
+public:
+    struct Config {
+        std::string interface;
+        uint32_t queue_id = 0;
+        uint16_t udp_port = 5600;
+        std::string object_path;        // Compiled xdp_rtp_steer.bpf.o
+        uint32_t frame_count = 4096;
+        uint32_t frame_size = 2048;
+        bool zero_copy = true;          // Falls back to copy mode if the driver lacks support
+    };
+
+    using PacketHandler = std::function<void(const uint8_t* payload, size_t size)>;
+
+    explicit AfXdpSocket(const Config& config);
+    ~AfXdpSocket();
+
+    AfXdpSocket(const AfXdpSocket&) = delete;
+    AfXdpSocket& operator=(const AfXdpSocket&) = delete;
+
+    [[nodiscard]] bool open();
+    void close();
+
+    // File descriptor to poll for POLLIN
+    [[nodiscard]] int fd() const;
+
+    /**
+     * @brief Handle all packets currently in the RX ring
+     * @return number of packets handled
+     */
+    size_t receive(const PacketHandler& handler);
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> impl_;
+};
@@ -0,0 +1,46 @@
+/**
+ * @file async_decoder.h
+ * @brief Awaitable decoder and display events for coroutines on a Reactor
+ */
+
+#pragma once
+
+#include "reactor.h"
+#include "v4l2_decoder.h"
+
+namespace coro {
+
+// An OUTPUT (bitstream) buffer came back; retry trySubmitData(). 0 after
+// the timeout too: a decoder that returns no buffers must not park the caller
+inline Reactor::ReadyAwaiter outputBufferFree(Reactor& reactor, V4L2Decoder& decoder,
+                                              std::chrono::milliseconds timeout) {
+    return reactor.ready(decoder.deviceFd(), EPOLLOUT, timeout);
+}
+
+// A CAPTURE buffer holds a decoded frame, or a V4L2 event is pending; call collectFrames()
+inline Reactor::ReadyAwaiter captureReady(Reactor& reactor, V4L2Decoder& decoder) {
+    return reactor.ready(decoder.deviceFd(), EPOLLIN | EPOLLPRI);
+}
+
+// Only a V4L2 event (source change, end of stream)
+inline Reactor::ReadyAwaiter decoderEvent(Reactor& reactor, V4L2Decoder& decoder) {
+    return reactor.ready(decoder.deviceFd(), EPOLLPRI);
+}
+
+inline Reactor::ReadyAwaiter socketReadable(Reactor& reactor, int fd) {
+    return reactor.ready(fd, EPOLLIN);
+}
+
+// The pending page flip completed; false on shutdown
+inline Task<bool> pageFlipComplete(Reactor& reactor, V4L2Decoder& decoder) {
+    while (decoder.displayBusy()) {
+        uint32_t events = co_await reactor.ready(decoder.displayEventFd(), EPOLLIN);
+        if (!events) {
+            co_return false;
+        }
+        decoder.dispatchDisplayEvents();
+    }
+    co_return true;
+}
+
+} // namespace coro
@@ -4,6 +4,80 @@
 #include <cstdint>
 #include <linux/videodev2.h>
 
+// How decoded frames reach scanout
+enum class PresentMode {
+    VSYNC,  // Page flip on vblank: no tearing, up to one refresh period of extra latency
+    ASYNC   // Tearing flip as soon as the frame is decoded (DRM_MODE_PAGE_FLIP_ASYNC)
+};
+
+// How the decoded frame is fitted onto each output
+enum class ScaleMode {
+    FIT,        // Preserve aspect ratio, letterbox / pillarbox
+    STRETCH     // Fill the whole output
+};
+
+// Where decoded frames are shown
+enum class DisplayOutput {
+    DRM,        // KMS planes; needs DRM master (console / kiosk)
+    WAYLAND,    // Client of a Wayland compositor via zwp_linux_dmabuf_v1
+    NONE        // Headless: frames only go to the frame consumers
+};
+
+// Capture of what the CRTC actually scanned out, through a DRM writeback
+// connector (vkms and many SoCs); atomic modesetting only
+struct WritebackConfig {
+    bool enabled = false;
+    uint32_t buffer_count = 3;      // Captures that may be in flight at once
+
+    // Per-capture CSV log (sequence, timestamps, latency, checksum) goes here
+    std::string output_dir;
+    bool dump_frames = false;       // Also write each capture as raw XRGB8888
+};
+
+// Display outputs and presentation
+struct DisplayConfig {
+    DisplayOutput output = DisplayOutput::DRM;
+    PresentMode present_mode = PresentMode::VSYNC;
+
+    // Drive every connected connector (each on its own CRTC) from the same
+    // framebuffer; needs atomic modesetting
+    bool mirror_outputs = false;
+    ScaleMode scale_mode = ScaleMode::FIT;
+
+    // Video wall: split each frame into wall_columns x wall_rows tiles, one
+    // per connected output in connector order (0 = disabled); needs atomic
+    // modesetting and takes precedence over mirroring
+    uint32_t wall_columns = 0;
+    uint32_t wall_rows = 0;
+
+    // Orientation for rotated/mirrored mounting, done by the plane's
+    // "rotation" property; the decoder is asked only if the plane cannot
+    uint32_t rotation = 0;      // Degrees clockwise: 0, 90, 180 or 270
+    bool reflect_x = false;
+    bool reflect_y = false;
+
+    WritebackConfig writeback;
+};
+
+// On-screen display rendered on a separate overlay plane
+struct OsdConfig {
+    bool enabled = false;
+
+    // Minimum interval between plane updates; unchanged text is never redrawn
+    uint32_t update_interval_ms = 250;
+
+    // Text grid and placement on the display
+    uint32_t columns = 32;
+    uint32_t rows = 8;
+    uint32_t scale = 2;         // Integer glyph magnification
+    int32_t x = 16;
+    int32_t y = 16;
+
+    // Premultiplied ARGB8888
+    uint32_t text_color = 0xFFFFFFFF;
+    uint32_t background_color = 0x99000000;
+};
+
 // Structure for storing all decoder settings
 struct DecoderConfig {
     // Path to V4L2 device
@@ -21,4 +95,10 @@ struct DecoderConfig {
 
     // Default input buffer size if not reported by the driver
     size_t default_input_buffer_size = 2 * 1024 * 1024; // 2MB
+
+    // Display outputs and presentation
+    DisplayConfig display;
+
+    // Telemetry overlay
+    OsdConfig osd;
 };
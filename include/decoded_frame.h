@@ -0,0 +1,32 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+/**
+ * @brief A decoded CAPTURE buffer shared with in-process consumers
+ *
+ * Handles are reference counted: the buffer goes back to the decoder once
+ * the display and every copy of the handle have let go of it. The pixels are
+ * read-only. dma_fd and data belong to the handles, so they stay valid across
+ * V4L2Decoder::resetBuffers(); the old buffer is then freed with the last handle.
+ */
+struct DecodedFrame {
+    int dma_fd = -1;                // Whole-frame DMA-buf (planes are contiguous)
+    const void* data = nullptr;     // CPU mapping of the same buffer
+    size_t size = 0;                // Bytes used
+    uint32_t width = 0;
+    uint32_t height = 0;
+    uint32_t format = 0;            // V4L2 fourcc, e.g. V4L2_PIX_FMT_YUV420
+    uint32_t stride = 0;            // Luma bytes per line
+    uint64_t sequence = 0;          // Decoder CAPTURE sequence number
+    uint32_t rtp_timestamp = 0;     // Of the access unit it was decoded from
+    std::chrono::microseconds timestamp{0};         // Media time: rtp_timestamp extended, on the 90 kHz clock
+    std::chrono::steady_clock::time_point decoded_at;
+    unsigned int buffer_index = 0;
+    uint32_t buffer_generation = 0; // Changes when the decoder reallocates its buffers
+};
+
+using DecodedFrameRef = std::shared_ptr<const DecodedFrame>;
@@ -0,0 +1,109 @@
+/**
+ * @file display_backend.h
+ * @brief Common interface of the zero-copy display outputs
+ */
+
+#pragma once
+
+#include "config.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Presents decoded DMA-buf frames without copying them.
+ * Implemented by the DRM/KMS output (needs DRM master) and by the Wayland
+ * client output (runs inside a desktop session).
+ */
+class DisplayBackend {
+public:
+    struct FrameInfo {
+        void* data;         // Pointer to frame data
+        int dma_fd;         // DMA-buf file descriptor (if available)
+        uint32_t width;     // Frame width
+        uint32_t height;    // Frame height
+        uint32_t format;    // Pixel format (fourcc)
+        size_t size;        // Data size
+        bool is_dmabuf;     // DMA-buf flag
+        uint32_t stride;    // Luma bytes per line (CAPTURE bytesperline)
+    };
+
+    // Single-buffer I420 as the decoder writes it: chroma lines are half the luma stride
+    struct I420Layout {
+        uint32_t pitches[3];
+        uint32_t offsets[3];
+        size_t size;
+    };
+    [[nodiscard]] static I420Layout i420Layout(uint32_t stride, uint32_t height) {
+        uint32_t y_size = stride * height;
+        uint32_t chroma_size = (stride / 2) * ((height + 1) / 2);
+        return {{stride, stride / 2, stride / 2}, {0, y_size, y_size + chroma_size}, size_t{y_size} + 2 * chroma_size};
+    }
+
+    // Presentation timing; latencies are from submission to the flip / presentation event
+    struct Statistics {
+        uint64_t flips = 0;
+        uint64_t async_flips = 0;
+        uint64_t discarded = 0;                 // Frames replaced before they reached the screen
+        double avg_flip_latency_us = 0.0;
+        uint64_t max_flip_latency_us = 0;
+        double avg_vsync_wait_saved_us = 0.0;   // Estimated wait to the next vblank avoided by async flips
+        uint64_t flip_timeouts = 0;             // Flips whose event never arrived (not counted in flips)
+    };
+
+    virtual ~DisplayBackend() = default;
+
+    // Must be called before initialize(); ASYNC falls back to VSYNC if unsupported
+    virtual void setConfig(const DisplayConfig& config) = 0;
+
+    // True when the output applies the configured rotation/reflection (or none is configured)
+    [[nodiscard]] virtual bool transformApplied() const = 0;
+
+    virtual bool initialize(uint32_t width, uint32_t height) = 0;
+    virtual bool displayFrame(const FrameInfo& frame) = 0;
+    virtual void cleanup() noexcept = 0;
+    virtual std::string getDisplayInfo() const = 0;
+
+    // Import a decoder buffer once so later frames in it are shown without copies
+    virtual bool setupZeroCopyBuffer(int dma_fd, uint32_t width, uint32_t height, uint32_t stride) = 0;
+
+    /**
+     * @brief DMA-buf fds that left the screen since the last call
+     *
+     * A frame handed to displayFrame() stays in use until a later frame has
+     * replaced it on screen; only then may the decoder write into it again.
+     */
+    virtual std::vector<int> takeReleasedBuffers() = 0;
+
+    virtual Statistics getStatistics() const = 0;
+
+    /**
+     * @brief Presentation events for callers running an event loop
+     *
+     * While presentPending() is true, displayFrame() would block on the
+     * previous flip; wait for eventFd() to become readable and call
+     * dispatchEvents() instead. Outputs without such an fd return -1.
+     */
+    [[nodiscard]] virtual int eventFd() const { return -1; }
+    [[nodiscard]] virtual bool presentPending() const { return false; }
+    virtual void dispatchEvents() {}
+
+    // Re-establish presentation with the next frame (watchdog); thread-safe
+    virtual void requestRecovery() {}
+
+    // Take the last frame off the screen until the next one (no signal);
+    // outputs that cannot keep showing it
+    virtual void blank() {}
+
+    /**
+     * @brief Idle: keep a copy of the last frame on screen (or blank) and
+     * forget every imported decoder buffer; the next frame is imported again
+     * @return false if decoder buffers are still in use (outputs without it)
+     */
+    virtual bool suspend(bool /*blank_screen*/) { return false; }
+
+    // Telemetry overlay (after initialize); outputs without one return false
+    virtual bool enableOsd(const OsdConfig& /*config*/) { return false; }
+    virtual void setOsdText(const std::vector<std::string>& /*lines*/) {}
+};
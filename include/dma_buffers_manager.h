@@ -19,6 +19,7 @@ public:
     void deallocate();
 
     [[nodiscard]] size_t count() const { return count_; }
+    [[nodiscard]] bool allocated() const { return !buffers_.empty(); }
     [[nodiscard]] const DmaBufAllocator::DmaBufInfo& get_info(size_t index) const;
     [[nodiscard]] DmaBufAllocator::DmaBufInfo& get_info(size_t index);
 
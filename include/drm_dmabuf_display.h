@@ -1,32 +1,56 @@
 #pragma once
 
+#include "display_backend.h"
 #include <memory>
 #include <string>
+#include <vector>
 #include <cstdint>
 
 // TRUE Zero-Copy DRM/DMA-buf display manager
-class DrmDmaBufDisplayManager {
+//
+// With atomic modesetting available, every output (one per connected
+// connector when mirroring) scans out the same imported framebuffer from its
+// CRTC's primary plane, scaled per output, and all outputs are updated in a
+// single commit. In video-wall mode each plane's SRC rectangle selects that
+// output's tile of the frame instead of the whole frame. Drivers without
+// atomic support use the legacy single-output path.
+//
+// Final so that callers holding the concrete type (DrmFrameProcessor) call
+// it directly instead of through the vtable.
+class DrmDmaBufDisplayManager final : public DisplayBackend {
 public:
-    struct FrameInfo {
-        void* data;         // Pointer to frame data
-        int dma_fd;         // DMA-buf file descriptor (if available)
-        uint32_t width;     // Frame width
-        uint32_t height;    // Frame height
-        uint32_t format;    // Pixel format (fourcc)
-        size_t size;        // Data size
-        bool is_dmabuf;     // DMA-buf flag
-    };
-
     DrmDmaBufDisplayManager();
-    ~DrmDmaBufDisplayManager();
-    
-    bool initialize(uint32_t width, uint32_t height);
-    bool displayFrame(const FrameInfo& frame);
-    void cleanup() noexcept;
-    std::string getDisplayInfo() const;
-    
-    // Special methods for DMA-buf
-    bool setupZeroCopyBuffer(int dma_fd, uint32_t width, uint32_t height);
+    ~DrmDmaBufDisplayManager() override;
+
+    void setConfig(const DisplayConfig& config) override;
+    [[nodiscard]] bool transformApplied() const override;
+
+    bool initialize(uint32_t width, uint32_t height) override;
+    bool displayFrame(const FrameInfo& frame) override;
+    void cleanup() noexcept override;
+    std::string getDisplayInfo() const override;
+
+    bool setupZeroCopyBuffer(int dma_fd, uint32_t width, uint32_t height, uint32_t stride) override;
+    std::vector<int> takeReleasedBuffers() override;
+    Statistics getStatistics() const override;
+
+    // Page flip completions on the DRM fd
+    [[nodiscard]] int eventFd() const override;
+    [[nodiscard]] bool presentPending() const override;
+    void dispatchEvents() override;
+
+    // Re-probe outputs and set the mode again on the next frame
+    void requestRecovery() override;
+
+    // Disable the video planes (atomic only); the next frame sets the mode again
+    void blank() override;
+
+    // Idle: show a copy of the last frame from a dumb buffer and drop the imports
+    bool suspend(bool blank_screen) override;
+
+    // Telemetry overlay on a separate plane
+    bool enableOsd(const OsdConfig& config) override;
+    void setOsdText(const std::vector<std::string>& lines) override;
 
 private:
     class Impl;
@@ -0,0 +1,130 @@
+/**
+ * @file flight_recorder.h
+ * @brief In-memory per-frame event ring, dumped to a file on anomalies
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+/**
+ * @brief Compact record of one pipeline event
+ *
+ * sequence counts in the recording component's own terms: frames received
+ * (session), access units submitted (decoder), the driver's CAPTURE
+ * sequence (dequeue) or frames decoded (session).
+ */
+struct FlightRecord {
+    int64_t time_ns = 0;                // steady_clock
+    uint32_t sequence = 0;
+    uint32_t rtp_timestamp = 0;         // Links a submission to the frame dequeued from it
+    uint32_t size = 0;                  // Bytes
+    int32_t value = 0;                  // Per event: latency (us), errno, recovery step
+    int16_t buffer = -1;                // V4L2 buffer index
+    uint8_t event = 0;                  // FlightRecorder::Event
+    uint8_t flags = 0;                  // FlightRecorder::Flag
+};
+
+/**
+ * @brief Lock-free ring of the most recent FlightRecords
+ *
+ * record() is wait-free and safe from any thread: it claims a slot with one
+ * atomic increment and publishes it with a per-slot stamp, so a dump skips
+ * slots that are being overwritten instead of locking writers out.
+ *
+ * trigger() marks an anomaly. A background thread waits post_trigger_ms so
+ * the aftermath is captured too, then appends the whole ring to dump_path
+ * (or stderr). Dumps closer than min_dump_interval_ms to the previous one,
+ * or beyond max_dumps, are counted but not written.
+ */
+class FlightRecorder {
+public:
+    enum class Event : uint8_t {
+        RECEIVED,           // Access unit complete (session)
+        SUBMITTED,          // Queued on an OUTPUT buffer (decoder)
+        DEQUEUED,           // CAPTURE buffer out of the driver (decoder)
+        DECODED,            // Receive-to-decoded latency known (session)
+        DECODE_ERROR,       // Submission failed (session)
+        DEVICE_ERROR,       // POLLERR from the decoder (decoder)
+        RECOVERY,           // One step of the recovery ladder (decoder)
+        STALL,              // Recovery requested from outside, e.g. the watchdog (decoder)
+        STREAM_LOST,        // (session)
+        IDLE                // (session)
+    };
+    static constexpr size_t EVENTS = 10;
+    [[nodiscard]] static const char* eventName(Event event);
+
+    enum Flag : uint8_t {
+        DISCONTINUITY = 1 << 0,     // First frame after a sequence jump or SSRC change
+        BUFFER_ERROR = 1 << 1,      // V4L2_BUF_FLAG_ERROR
+        DISPLAYED = 1 << 2,
+        EXPORTED = 1 << 3,          // Handed to frame consumers
+        RECOVERED = 1 << 4,
+        LATENCY_SPIKE = 1 << 5
+    };
+
+    struct Config {
+        size_t capacity = 4096;             // Records; rounded up to a power of two
+        uint32_t latency_spike_ms = 100;    // Receive-to-decoded latency that triggers a dump (0: never)
+        uint32_t post_trigger_ms = 250;
+        uint32_t min_dump_interval_ms = 5000;
+        uint32_t max_dumps = 20;
+        std::string dump_path;              // Appended to; empty: stderr
+    };
+
+    struct Statistics {
+        uint64_t records = 0;
+        uint64_t triggers = 0;
+        uint64_t dumps = 0;
+        uint64_t suppressed = 0;            // Rate-limited or over max_dumps
+    };
+
+    explicit FlightRecorder(const Config& config);
+    ~FlightRecorder();
+
+    FlightRecorder(const FlightRecorder&) = delete;
+    FlightRecorder& operator=(const FlightRecorder&) = delete;
+
+    void record(Event event, uint32_t sequence, uint32_t size = 0, int32_t value = 0, int16_t buffer = -1,
+                uint8_t flags = 0, uint32_t rtp_timestamp = 0) noexcept {
+        uint64_t index = head_.fetch_add(1, std::memory_order_relaxed);
+        Slot& slot = slots_[index & mask_];
+        // Odd stamp: being written
+        slot.stamp.store(index * 2 + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        slot.record.time_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+        slot.record.sequence = sequence;
+        slot.record.rtp_timestamp = rtp_timestamp;
+        slot.record.size = size;
+        slot.record.value = value;
+        slot.record.buffer = buffer;
+        slot.record.event = static_cast<uint8_t>(event);
+        slot.record.flags = flags;
+        slot.stamp.store(index * 2 + 2, std::memory_order_release);
+    }
+
+    // Schedule a dump; reason must be a string literal. Cheap while one is pending
+    void trigger(const char* reason) noexcept;
+
+    [[nodiscard]] const Config& config() const { return config_; }
+    [[nodiscard]] Statistics getStatistics() const;
+
+private:
+    struct Slot {
+        std::atomic<uint64_t> stamp{0};
+        FlightRecord record;
+    };
+
+    class Impl;
+
+    Config config_;
+    uint64_t mask_ = 0;
+    std::unique_ptr<Slot[]> slots_;
+    std::atomic<uint64_t> head_{0};
+    std::unique_ptr<Impl> impl_;        // Dump thread
+};
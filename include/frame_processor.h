@@ -1,47 +1,76 @@
 #pragma once
 
-#include "v4l2_decoder.h" // For V4L2Decoder::DisplayType
+#include "pipeline.h"
+#include "display_backend.h"
+#include "drm_dmabuf_display.h"
 #include <linux/videodev2.h>
-#include <memory>
+#include <concepts>
+#include <cstdint>
 #include <vector>
-#include <functional>
 
 // Forward declarations
-class DrmDmaBufDisplayManager;
 class DmaBuffersManager;
 
-class FrameProcessor {
+// What the display stage needs from a display
+template <typename Display>
+concept FrameDisplay = requires(Display& display, const DisplayBackend::FrameInfo& frame, int fd, uint32_t size) {
+    { display.displayFrame(frame) } -> std::convertible_to<bool>;
+    { display.setupZeroCopyBuffer(fd, size, size, size) } -> std::convertible_to<bool>;
+    { display.takeReleasedBuffers() } -> std::same_as<std::vector<int>>;
+};
+
+/**
+ * @brief Display stage: validates decoded CAPTURE buffers and shows them
+ *
+ * Owns its per-buffer state (zero-copy import, buffers held for scanout,
+ * frame count); the decoder only tells it about format and display changes.
+ *
+ * Display is the static display type. FrameProcessor works with any
+ * DisplayBackend through virtual calls; DrmFrameProcessor is bound to the
+ * (final) DRM manager, so its per-frame display calls are direct.
+ */
+template <FrameDisplay Display>
+class BasicFrameProcessor {
 public:
-    using ZeroCopySetupCallback = std::function<void(unsigned int)>;
-
-    FrameProcessor(
-        DrmDmaBufDisplayManager* display_manager,
-        DmaBuffersManager* output_buffers,
-        uint32_t& frame_width,
-        uint32_t& frame_height,
-        V4L2Decoder::DisplayType& display_type,
-        std::vector<bool>& zero_copy_initialized,
-        int& decoded_frame_count,
-        ZeroCopySetupCallback cb = nullptr
-    );
-
-    // Returns true if the buffer should be re-queued
+    explicit BasicFrameProcessor(DmaBuffersManager* output_buffers);
+
+    // Returns true if the buffer should be re-queued; false while it is held for scanout
     [[nodiscard]] bool processDecodedFrame(const v4l2_buffer& out_buf);
 
-    // Update the DisplayManager pointer
-    void setDisplayManager(DrmDmaBufDisplayManager* display_manager);
+    // Indices of held buffers that the display no longer scans out
+    [[nodiscard]] std::vector<unsigned int> takeReleasedBuffers();
+
+    // Forget held buffers and imports (after the buffers were reallocated)
+    void resetHeldBuffers();
+
+    // Display to show frames on (nullptr: validate and count only)
+    void setDisplay(Display* display);
+
+    // Size and luma bytes per line of the decoded frames, from the CAPTURE format
+    void setFrameSize(uint32_t width, uint32_t height, uint32_t stride);
+
+    [[nodiscard]] int decodedFrameCount() const noexcept { return decoded_frame_count_; }
+    [[nodiscard]] pipeline::StageMetrics metrics() const { return metrics_.snapshot("display"); }
 
 private:
     [[nodiscard]] bool validateOutputBuffer(const v4l2_buffer& out_buf) const;
     [[nodiscard]] bool displayFrame(const v4l2_buffer& out_buf);
     void setupZeroCopyBuffer(unsigned int index);
 
-    DrmDmaBufDisplayManager* display_manager_;
+    Display* display_ = nullptr;
     DmaBuffersManager* output_buffers_;
-    uint32_t& frame_width_;
-    uint32_t& frame_height_;
-    V4L2Decoder::DisplayType& display_type_;
-    std::vector<bool>& zero_copy_initialized_;
-    int& decoded_frame_count_;
-    ZeroCopySetupCallback zero_copy_setup_callback_;
+    uint32_t frame_width_ = 0;
+    uint32_t frame_height_ = 0;
+    uint32_t frame_stride_ = 0;
+    int decoded_frame_count_ = 0;
+    std::vector<bool> zero_copy_initialized_;
+    std::vector<unsigned int> held_buffers_;
+    pipeline::MetricsRecorder metrics_;
 };
+
+// Instantiated in frame_processor.cpp
+extern template class BasicFrameProcessor<DisplayBackend>;
+extern template class BasicFrameProcessor<DrmDmaBufDisplayManager>;
+
+using FrameProcessor = BasicFrameProcessor<DisplayBackend>;
+using DrmFrameProcessor = BasicFrameProcessor<DrmDmaBufDisplayManager>;
@@ -0,0 +1,66 @@
+/**
+ * @file frame_server.h
+ * @brief Shares decoded frames with local processes over a Unix socket
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+class V4L2Decoder;
+
+/**
+ * @brief Publishes every decoded frame to local subscribers without copies
+ *
+ * Decoder buffers are passed to each subscriber once as dma-buf fds
+ * (SCM_RIGHTS); per frame only a slot in a shared-memory ring is written
+ * (see frame_server_protocol.h). Each subscriber holds at most
+ * max_held_frames decoder buffers: a subscriber that is behind misses frames
+ * instead of stalling the decoder and the display, and one that keeps a
+ * frame longer than hold_timeout_ms is disconnected.
+ */
+class FrameServer {
+public:
+    struct Config {
+        std::string socket_path = "/tmp/rtp_player.sock";
+        uint32_t max_subscribers = 4;
+        uint32_t max_held_frames = 1;
+        uint32_t hold_timeout_ms = 1000;
+    };
+
+    struct Statistics {
+        uint32_t subscribers = 0;
+        uint64_t published = 0;         // Frames delivered, summed over subscribers
+        uint64_t dropped = 0;           // Frames a subscriber was too busy for
+        uint64_t disconnected = 0;      // Subscribers dropped for holding frames too long
+    };
+
+    explicit FrameServer(const Config& config);
+    ~FrameServer();
+
+    FrameServer(const FrameServer&) = delete;
+    FrameServer& operator=(const FrameServer&) = delete;
+
+    // Create the listening socket
+    [[nodiscard]] bool initialize();
+
+    // Start publishing; the decoder must outlive stop()
+    [[nodiscard]] bool start(V4L2Decoder& decoder);
+    void stop() noexcept;
+
+    /**
+     * @brief Decoder buffers the server may keep away from the decoder at once
+     *
+     * Add this to DecoderConfig::output_buffer_count so subscribers never
+     * starve the decoder.
+     */
+    [[nodiscard]] uint32_t maxHeldBuffers() const noexcept;
+
+    [[nodiscard]] Statistics getStatistics() const;
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> impl_;
+};
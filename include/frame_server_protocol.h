@@ -0,0 +1,75 @@
+/**
+ * @file frame_server_protocol.h
+ * @brief Wire format between FrameServer and its local subscribers
+ *
+ * A subscriber connects to the server's SOCK_SEQPACKET Unix socket and
+ * receives a Hello carrying two fds: a memfd holding a FrameRing and an
+ * eventfd that is signalled after each publish. Every decoder buffer is
+ * announced once (per reallocation) with a BufferAnnounce carrying its
+ * dma-buf fd; after that only FrameSlots go through the ring. A published
+ * frame stays valid until the subscriber sends a Release for its frame_id.
+ *
+ * Subscriber loop: wait on the eventfd, drain the socket (announcements
+ * precede the slots that use them), then consume the ring from tail to head.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+namespace frame_server {
+
+constexpr uint32_t PROTOCOL_VERSION = 1;
+constexpr uint32_t RING_SLOTS = 16;     // Power of two
+
+enum class MessageType : uint32_t {
+    HELLO = 1,      // Server -> subscriber; fds: ring memfd, eventfd
+    BUFFER = 2,     // Server -> subscriber; fd: dma-buf
+    RELEASE = 3     // Subscriber -> server
+};
+
+struct Hello {
+    MessageType type = MessageType::HELLO;
+    uint32_t version = PROTOCOL_VERSION;
+    uint32_t ring_slots = RING_SLOTS;
+    uint32_t max_held_frames = 0;       // Frames beyond this are dropped for the subscriber
+};
+
+struct BufferAnnounce {
+    MessageType type = MessageType::BUFFER;
+    uint32_t buffer_index = 0;
+    uint32_t buffer_generation = 0;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    uint32_t format = 0;                // V4L2 fourcc
+    uint32_t stride = 0;                // Luma bytes per line
+    uint32_t reserved = 0;
+};
+
+struct Release {
+    MessageType type = MessageType::RELEASE;
+    uint32_t reserved = 0;
+    uint64_t frame_id = 0;
+};
+
+struct FrameSlot {
+    uint64_t frame_id = 0;              // Server-assigned, echoed in Release
+    uint64_t sequence = 0;              // Decoder CAPTURE sequence number
+    int64_t timestamp_us = 0;           // Media time from the RTP timestamp
+    int64_t decoded_at_ns = 0;          // CLOCK_MONOTONIC
+    uint64_t size = 0;                  // Bytes used
+    uint32_t buffer_index = 0;
+    uint32_t buffer_generation = 0;
+};
+
+// Single-producer (server) / single-consumer (subscriber) ring in shared memory
+struct FrameRing {
+    alignas(64) std::atomic<uint64_t> head{0};     // Written by the server
+    alignas(64) std::atomic<uint64_t> tail{0};     // Written by the subscriber
+    alignas(64) FrameSlot slots[RING_SLOTS];
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "FrameRing needs lock-free 64-bit atomics");
+
+} // namespace frame_server
@@ -0,0 +1,96 @@
+/**
+ * @file h264_depacketizer.h
+ * @brief RFC 6184 H.264 RTP depacketizer producing Annex B access units
+ */
+
+#pragma once
+
+#include "h264_frame.h"
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <functional>
+
+/**
+ * @brief Reassembles H.264 RTP packets (single NAL, STAP-A, FU-A) into
+ * complete access units. Used by receive paths that see raw RTP packets
+ * (RTSP interleaved transport) instead of frames reassembled by uvgRTP.
+ *
+ * Not thread-safe: packets must be pushed from a single thread.
+ */
+class H264Depacketizer {
+public:
+    using FrameCallback = std::function<void(std::unique_ptr<H264Frame>)>;
+
+    struct RtpPacketInfo {
+        uint8_t payload_type = 0;
+        bool marker = false;
+        uint16_t seq = 0;
+        uint32_t timestamp = 0;
+        uint32_t ssrc = 0;
+        uint16_t extension_profile = 0;
+        const uint8_t* extension = nullptr;  // Header extension payload (if present)
+        size_t extension_length = 0;         // In bytes
+        const uint8_t* payload = nullptr;
+        size_t payload_length = 0;
+    };
+
+    struct Statistics {
+        uint64_t packets_received = 0;
+        uint64_t bytes_received = 0;
+        uint64_t frames_completed = 0;
+        uint64_t packets_lost = 0;
+        uint64_t frames_dropped = 0;
+        uint64_t stream_restarts = 0;    // SSRC changes and sequence jumps
+    };
+
+    H264Depacketizer() = default;
+
+    /**
+     * @brief Parse a raw RTP header (RFC 3550)
+     * @return false if the packet is not a valid RTP version 2 packet
+     */
+    [[nodiscard]] static bool parseRtpHeader(const uint8_t* data, size_t size, RtpPacketInfo& info);
+
+    void setFrameCallback(FrameCallback callback) { frame_callback_ = std::move(callback); }
+
+    // Accept only this payload type (-1 accepts any)
+    void setPayloadType(int payload_type) { payload_type_ = payload_type; }
+
+    /**
+     * @brief Feed one RTP packet
+     * @return false if the packet was rejected
+     */
+    bool pushPacket(const uint8_t* data, size_t size);
+
+    /**
+     * @brief Feed one already parsed RTP packet
+     */
+    bool pushPacket(const RtpPacketInfo& packet);
+
+    // Drop any partially assembled access unit
+    void reset();
+
+    [[nodiscard]] const Statistics& getStatistics() const { return stats_; }
+    void resetStatistics() { stats_ = Statistics{}; }
+
+private:
+    void appendNal(const uint8_t* nal, size_t size);
+    void dropFragment();            // Discard an unfinished FU-A NAL
+    void flushAccessUnit();
+
+    FrameCallback frame_callback_;
+    int payload_type_ = -1;
+
+    std::unique_ptr<H264Frame> current_;
+    uint32_t current_timestamp_ = 0;
+    bool fu_active_ = false;
+    size_t fu_start_ = 0;               // Offset of the fragmented NAL's start code in current_->data
+
+    bool have_seq_ = false;
+    uint16_t expected_seq_ = 0;
+    uint32_t ssrc_ = 0;
+    bool discontinuity_ = false;        // Flag the next access unit
+
+    Statistics stats_;
+};
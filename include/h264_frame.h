@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <chrono>
+
+/**
+ * @brief A complete H.264 access unit in Annex B format, ready for decoding
+ */
+struct H264Frame {
+    std::vector<uint8_t> data;  // Full frame, ready for decoding
+    uint32_t timestamp;
+    uint32_t ssrc;              // RTP source (0 if unknown)
+    bool discontinuity;         // First frame after a sequence jump or SSRC change
+    std::chrono::steady_clock::time_point received_time;
+
+    H264Frame() : timestamp(0), ssrc(0), discontinuity(false) {
+        received_time = std::chrono::steady_clock::now();
+    }
+};
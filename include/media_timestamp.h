@@ -0,0 +1,58 @@
+/**
+ * @file media_timestamp.h
+ * @brief RTP timestamps carried through the decoder
+ *
+ * The decoder copies v4l2_buffer.timestamp from a bitstream buffer to the
+ * frame decoded from it, so submissions store the RTP timestamp there and
+ * decoded frames get it back whatever order the decoder returns them in.
+ * The 32-bit RTP clock is extended to 64 bits first so it survives the wrap.
+ */
+
+#pragma once
+
+#include <linux/videodev2.h>
+#include <chrono>
+#include <cstdint>
+
+class RtpTimestampUnwrapper {
+public:
+    // Extended timestamps start one cycle up so frames sent before the
+    // first one (B-frames, reordering) never go negative
+    static constexpr uint64_t FIRST_CYCLE = uint64_t{1} << 32;
+
+    [[nodiscard]] uint64_t unwrap(uint32_t timestamp) {
+        if (!valid_) {
+            valid_ = true;
+            last_ = FIRST_CYCLE + timestamp;
+        } else {
+            // The shorter way round the 32-bit clock, forwards or back
+            last_ += static_cast<int32_t>(timestamp - static_cast<uint32_t>(last_));
+        }
+        return last_;
+    }
+
+    void reset() { valid_ = false; }
+
+private:
+    bool valid_ = false;
+    uint64_t last_ = 0;
+};
+
+// The driver only copies the field: the ticks need not be a wall-clock time,
+// but tv_usec stays below a second so the kernel's conversion is exact
+[[nodiscard]] inline timeval rtpToBufferTimestamp(uint64_t extended) {
+    timeval tv{};
+    tv.tv_sec = static_cast<decltype(tv.tv_sec)>(extended / 1000000);
+    tv.tv_usec = static_cast<decltype(tv.tv_usec)>(extended % 1000000);
+    return tv;
+}
+
+[[nodiscard]] inline uint64_t rtpFromBufferTimestamp(const timeval& tv) {
+    return static_cast<uint64_t>(tv.tv_sec) * 1000000 + static_cast<uint64_t>(tv.tv_usec);
+}
+
+// Media time of an extended timestamp on the 90 kHz H.264 clock
+[[nodiscard]] inline std::chrono::microseconds rtpToMediaTime(uint64_t extended) {
+    int64_t ticks = static_cast<int64_t>(extended - RtpTimestampUnwrapper::FIRST_CYCLE);
+    return std::chrono::microseconds(ticks * 100 / 9);
+}
@@ -0,0 +1,112 @@
+/**
+ * @file native_rtp_receiver.h
+ * @brief RTP receiver on plain UDP sockets with an optional AF_XDP fast path
+ */
+
+#pragma once
+
+#include "rtp_receiver.h"
+#include "h264_depacketizer.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <chrono>
+
+class AfXdpSocket;
+
+/**
+ * @brief RTP receiver that reads raw packets itself and reassembles them with
+ * H264Depacketizer, instead of relying on uvgRTP's reception threads.
+ *
+ * The socket backend drains the UDP socket in batches with recvmmsg(). With
+ * UDP_GRO enabled the kernel coalesces back-to-back datagrams of a flow (an
+ * IDR burst) into super-packets that are split here by the segment size it
+ * reports, so a whole burst costs a handful of syscalls and one wakeup.
+ * The AF_XDP backend (built with RTP_PLAYER_ENABLE_AF_XDP) attaches a small
+ * XDP program that steers the configured UDP port into an AF_XDP socket;
+ * packets are depacketized straight from the UMEM. The UDP socket stays bound
+ * in that mode, so packets arriving on other queues - or everything, if the
+ * XDP setup fails - still take the regular socket path.
+ */
+class NativeRTPReceiver : public RtpReceiver {
+public:
+    enum class Backend {
+        SOCKET,
+        XDP     // AF_XDP socket fed by an XDP steering program
+    };
+
+    struct Config {
+        std::string local_ip = "0.0.0.0";
+        uint16_t local_port = 5600;
+        Backend backend = Backend::SOCKET;
+        int socket_receive_buffer = 8 * 1024 * 1024;
+        bool enable_gro = true;         // Request UDP_GRO coalescing on the socket
+
+        // AF_XDP settings
+        std::string xdp_interface;
+        uint32_t xdp_queue = 0;
+        std::string xdp_object_path;    // Compiled XDP steering program (empty: built-in default)
+    };
+
+    explicit NativeRTPReceiver(const Config& config);
+    ~NativeRTPReceiver() override;
+
+    NativeRTPReceiver(const NativeRTPReceiver&) = delete;
+    NativeRTPReceiver& operator=(const NativeRTPReceiver&) = delete;
+
+    bool initialize() override;
+    void setFrameCallback(FrameCallback callback) override;
+    void setTransportFeedback(TransportFeedback* feedback) override;
+
+    bool start() override;
+    void stop() override;           // Also closes the socket: initialize() again before start()
+    bool isRunning() const override { return running_; }
+
+    Statistics getStatistics() const override;
+    void resetStatistics() override;
+
+    // Backend actually in use after initialize()
+    [[nodiscard]] Backend activeBackend() const { return active_backend_; }
+
+private:
+    static constexpr size_t BATCH_SIZE = 64;
+    static constexpr size_t MAX_PACKET_SIZE = 2048;
+    static constexpr size_t GRO_BATCH_SIZE = 16;
+    static constexpr size_t MAX_GRO_PACKET_SIZE = 65536;
+
+    bool initializeSocket();
+    void receiveLoop();
+    void drainSocket();
+    void handleDatagram(const uint8_t* data, size_t size, size_t segment_size,
+                        std::chrono::steady_clock::time_point arrival);
+    void handlePacket(const uint8_t* data, size_t size, std::chrono::steady_clock::time_point arrival);
+    void publishStatistics();
+
+    Config config_;
+    Backend active_backend_ = Backend::SOCKET;
+
+    int socket_fd_ = -1;
+    bool gro_enabled_ = false;
+    size_t batch_size_ = BATCH_SIZE;
+    size_t slot_size_ = MAX_PACKET_SIZE;
+    std::vector<uint8_t> batch_buffers_;
+    std::vector<uint8_t> control_buffers_;
+
+    std::unique_ptr<AfXdpSocket> xdp_socket_;
+
+    H264Depacketizer depacketizer_;
+    TransportFeedback* transport_feedback_ = nullptr;
+
+    std::thread receive_thread_;
+    int wake_fd_ = -1;
+    std::atomic<bool> running_;
+    std::atomic<bool> initialized_;
+    std::atomic<bool> reset_statistics_{false};
+
+    mutable std::mutex stats_mutex_;
+    Statistics stats_;
+};
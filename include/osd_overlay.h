@@ -0,0 +1,64 @@
+#pragma once
+
+#include "config.h"
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+struct _drmModeAtomicReq;
+
+/**
+ * @brief Telemetry text on a DRM overlay plane
+ *
+ * Renders a small text grid into ARGB8888 dumb buffers and shows them on an
+ * overlay plane of the video CRTC, so the display hardware composites the
+ * OSD over the zero-copy video plane. Rendering happens on the overlay's own
+ * thread at most once per update interval and only when the text changed.
+ * The overlay never commits on its own, which would race the video flips:
+ * the display puts a newly rendered buffer on the plane with its next frame.
+ */
+class OsdOverlay {
+public:
+    explicit OsdOverlay(const OsdConfig& config);
+    ~OsdOverlay();
+
+    OsdOverlay(const OsdOverlay&) = delete;
+    OsdOverlay& operator=(const OsdOverlay&) = delete;
+
+    /**
+     * @brief Pick an overlay plane for the CRTC and allocate the buffers
+     * @param crtc_index Index of the CRTC in drmModeRes::crtcs (for possible_crtcs)
+     * @param atomic The display commits atomically (addToCommit()) rather than
+     *        with legacy page flips (presentLegacy())
+     */
+    [[nodiscard]] bool initialize(int drm_fd, uint32_t crtc_id, uint32_t crtc_index,
+                                  uint32_t display_width, uint32_t display_height, bool atomic);
+
+    /**
+     * @brief Add the plane to a video atomic commit (display thread)
+     *
+     * Adds the newest rendered buffer, or the full plane state on a modeset.
+     * Report the result of the commit with commitDone() either way.
+     * @return false if the commit does not need to touch the plane
+     */
+    bool addToCommit(_drmModeAtomicReq* req, bool modeset);
+
+    // Report the result of the commit prepared by addToCommit()
+    void commitDone(bool committed);
+
+    // Legacy displays: set the plane to the newest rendered buffer, if any, before a flip
+    void presentLegacy();
+
+    // Replace the displayed text (one entry per row); cheap, thread-safe
+    void setText(const std::vector<std::string>& lines);
+
+    // Disable the plane and free the buffers
+    void shutdown() noexcept;
+
+    [[nodiscard]] uint32_t planeId() const;
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> impl_;
+};
@@ -0,0 +1,438 @@
+/**
+ * @file pipeline.h
+ * @brief Building blocks for the receive → decode → display pipeline
+ *
+ * A Stage owns a bounded input queue, runs its handler on the thread model
+ * it is configured with and records its own metrics. What happens when the
+ * queue is full (block the producer or drop a frame) is part of the stage
+ * configuration, so trading latency for robustness is a config change.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <concepts>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace pipeline {
+
+// What a full input queue does with a new item
+enum class Overflow {
+    BLOCK,          // Producer waits for room (lossless, latency grows)
+    DROP_OLDEST,    // Oldest queued item is discarded (bounded latency)
+    DROP_NEWEST     // New item is discarded (keeps what is already queued)
+};
+
+// Where a stage's handler runs
+enum class Threading {
+    INLINE,         // On the producer's thread; no queue
+    OWN_THREAD,     // Dedicated thread draining the queue
+    EXECUTOR        // Shared Executor; items of one stage still run in order
+};
+
+struct StageConfig {
+    size_t capacity = 5;
+    Overflow overflow = Overflow::DROP_OLDEST;
+    Threading threading = Threading::OWN_THREAD;
+    int realtime_priority = 0;      // SCHED_FIFO priority for OWN_THREAD (0 = inherit)
+};
+
+struct StageMetrics {
+    std::string name;
+    uint64_t accepted = 0;
+    uint64_t processed = 0;
+    uint64_t dropped = 0;
+    size_t depth = 0;
+    size_t max_depth = 0;
+    double avg_wait_us = 0.0;       // Time spent queued
+    double avg_process_us = 0.0;
+    uint64_t max_process_us = 0;
+};
+
+// Lock-free counters behind StageMetrics; safe to update from any thread
+class MetricsRecorder {
+public:
+    void accepted(size_t depth) {
+        accepted_.fetch_add(1, std::memory_order_relaxed);
+        size_t max = max_depth_.load(std::memory_order_relaxed);
+        while (depth > max && !max_depth_.compare_exchange_weak(max, depth, std::memory_order_relaxed)) {}
+    }
+
+    void dropped() { dropped_.fetch_add(1, std::memory_order_relaxed); }
+
+    void processed(std::chrono::nanoseconds wait, std::chrono::nanoseconds process) {
+        processed_.fetch_add(1, std::memory_order_relaxed);
+        wait_ns_.fetch_add(static_cast<uint64_t>(wait.count()), std::memory_order_relaxed);
+        uint64_t ns = static_cast<uint64_t>(process.count());
+        process_ns_.fetch_add(ns, std::memory_order_relaxed);
+        uint64_t max = max_process_ns_.load(std::memory_order_relaxed);
+        while (ns > max && !max_process_ns_.compare_exchange_weak(max, ns, std::memory_order_relaxed)) {}
+    }
+
+    [[nodiscard]] StageMetrics snapshot(const std::string& name, size_t depth = 0) const {
+        StageMetrics m;
+        m.name = name;
+        m.accepted = accepted_.load(std::memory_order_relaxed);
+        m.processed = processed_.load(std::memory_order_relaxed);
+        m.dropped = dropped_.load(std::memory_order_relaxed);
+        m.depth = depth;
+        m.max_depth = max_depth_.load(std::memory_order_relaxed);
+        if (m.processed > 0) {
+            m.avg_wait_us = wait_ns_.load(std::memory_order_relaxed) / 1000.0 / m.processed;
+            m.avg_process_us = process_ns_.load(std::memory_order_relaxed) / 1000.0 / m.processed;
+        }
+        m.max_process_us = max_process_ns_.load(std::memory_order_relaxed) / 1000;
+        return m;
+    }
+
+private:
+    std::atomic<uint64_t> accepted_{0};
+    std::atomic<uint64_t> processed_{0};
+    std::atomic<uint64_t> dropped_{0};
+    std::atomic<size_t> max_depth_{0};
+    std::atomic<uint64_t> wait_ns_{0};
+    std::atomic<uint64_t> process_ns_{0};
+    std::atomic<uint64_t> max_process_ns_{0};
+};
+
+/**
+ * @brief Multi-producer queue with a fixed capacity and an overflow policy
+ *
+ * Items carry their enqueue time so the consumer can report queueing delay.
+ * Control items (pushControl()) are exempt from the policy: they never block,
+ * are never displaced and survive clear(), and may exceed the capacity.
+ */
+template <typename T>
+class BoundedQueue {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    BoundedQueue(size_t capacity, Overflow overflow)
+        : capacity_(std::max<size_t>(capacity, 1)), overflow_(overflow) {}
+
+    /**
+     * @brief Add an item, applying the overflow policy
+     * @param displaced Set when an item (new or old) was dropped
+     * @return false once the queue is closed
+     */
+    bool push(T item, bool& displaced) {
+        displaced = false;
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (overflow_ == Overflow::BLOCK) {
+            not_full_.wait(lock, [this] { return items_.size() < capacity_ || closed_; });
+        }
+        if (closed_) {
+            return false;
+        }
+        if (items_.size() >= capacity_) {
+            auto oldest = std::find_if(items_.begin(), items_.end(), [](const Entry& e) { return !e.control; });
+            displaced = true;
+            if (overflow_ == Overflow::DROP_NEWEST || oldest == items_.end()) {
+                return true;
+            }
+            items_.erase(oldest);
+        }
+        items_.push_back({std::move(item), Clock::now(), false});
+        lock.unlock();
+        not_empty_.notify_one();
+        return true;
+    }
+
+    // Add an item the overflow policy must not touch; false once the queue is closed
+    bool pushControl(T item) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (closed_) {
+            return false;
+        }
+        items_.push_back({std::move(item), Clock::now(), true});
+        lock.unlock();
+        not_empty_.notify_one();
+        return true;
+    }
+
+    // Wait for an item; false once the queue is closed and drained
+    bool pop(T& item, Clock::time_point& enqueued) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        not_empty_.wait(lock, [this] { return !items_.empty() || closed_; });
+        return takeFront(lock, item, enqueued);
+    }
+
+    bool tryPop(T& item, Clock::time_point& enqueued) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        return takeFront(lock, item, enqueued);
+    }
+
+    // Wake all waiters; pop() still returns the remaining items
+    void close() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            closed_ = true;
+        }
+        not_empty_.notify_all();
+        not_full_.notify_all();
+    }
+
+    // Drop everything queued and accept items again
+    void reopen() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        items_.clear();
+        closed_ = false;
+    }
+
+    // Drop everything queued but control items; returns how many items were dropped
+    size_t clear() {
+        size_t count;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            count = items_.size();
+            items_.erase(std::remove_if(items_.begin(), items_.end(), [](const Entry& e) { return !e.control; }),
+                         items_.end());
+            count -= items_.size();
+        }
+        not_full_.notify_all();
+        return count;
+    }
+
+    [[nodiscard]] size_t size() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return items_.size();
+    }
+
+private:
+    bool takeFront(std::unique_lock<std::mutex>& lock, T& item, Clock::time_point& enqueued) {
+        if (items_.empty()) {
+            return false;
+        }
+        item = std::move(items_.front().item);
+        enqueued = items_.front().enqueued;
+        items_.pop_front();
+        lock.unlock();
+        not_full_.notify_one();
+        return true;
+    }
+
+    const size_t capacity_;
+    const Overflow overflow_;
+    mutable std::mutex mutex_;
+    std::condition_variable not_empty_;
+    std::condition_variable not_full_;
+    struct Entry {
+        T item;
+        Clock::time_point enqueued;
+        bool control;
+    };
+    std::deque<Entry> items_;
+    bool closed_ = false;
+};
+
+// Fixed pool of worker threads shared by EXECUTOR stages
+class Executor {
+public:
+    explicit Executor(size_t threads);
+    ~Executor();
+
+    Executor(const Executor&) = delete;
+    Executor& operator=(const Executor&) = delete;
+
+    void post(std::function<void()> task);
+
+private:
+    void run();
+
+    std::mutex mutex_;
+    std::condition_variable condition_;
+    std::deque<std::function<void()>> tasks_;
+    std::vector<std::thread> workers_;
+    bool stopping_ = false;
+};
+
+// Give a stage thread SCHED_FIFO priority; logs and returns false if not permitted
+bool setRealtimePriority(std::thread& thread, int priority, const std::string& name);
+
+// Name a thread for /proc, top -H and ThreadSampler; truncated to the kernel's 15 characters
+void setThreadName(std::thread& thread, const std::string& name);
+
+/**
+ * @brief A pipeline stage: bounded input, handler, threading and metrics
+ *
+ * The handler always sees items one at a time and in order, whatever the
+ * threading, so stages wrapping non-thread-safe components (the decoder)
+ * need no extra locking.
+ *
+ * Handler defaults to a type-erased std::function; a stage built with a
+ * concrete function object type calls (and can inline) it directly.
+ */
+template <typename H, typename T>
+concept StageHandler = std::invocable<H&, T&>;
+
+template <typename T, StageHandler<T> H = std::function<void(T&)>>
+class Stage {
+public:
+    using Handler = H;
+
+    Stage(std::string name, const StageConfig& config, Handler handler, Executor* executor = nullptr)
+        : name_(std::move(name)), config_(config), handler_(std::move(handler)),
+          executor_(executor), queue_(config.capacity, config.overflow) {
+        if (config_.threading == Threading::EXECUTOR && !executor_) {
+            config_.threading = Threading::OWN_THREAD;
+        }
+    }
+
+    ~Stage() { stop(); }
+
+    Stage(const Stage&) = delete;
+    Stage& operator=(const Stage&) = delete;
+
+    void start() {
+        if (running_.exchange(true)) {
+            return;
+        }
+        queue_.reopen();
+        if (config_.threading == Threading::OWN_THREAD) {
+            thread_ = std::thread([this] { drainLoop(); });
+            setThreadName(thread_, name_);
+            if (config_.realtime_priority > 0) {
+                (void)setRealtimePriority(thread_, config_.realtime_priority, name_);
+            }
+        }
+    }
+
+    // Stop accepting items; items already queued are still processed
+    void stop() {
+        if (!running_.exchange(false)) {
+            return;
+        }
+        queue_.close();
+        if (thread_.joinable()) {
+            thread_.join();
+        }
+        std::unique_lock<std::mutex> lock(drain_mutex_);
+        drained_.wait(lock, [this] { return !scheduled_; });
+    }
+
+    // Hand an item to the stage; false if it was dropped or the stage is stopped
+    bool push(T item) {
+        if (!running_) {
+            return false;
+        }
+
+        if (config_.threading == Threading::INLINE) {
+            metrics_.accepted(0);
+            process(item, BoundedQueue<T>::Clock::now());
+            return true;
+        }
+
+        bool displaced = false;
+        if (!queue_.push(std::move(item), displaced)) {
+            return false;
+        }
+        if (displaced) {
+            metrics_.dropped();
+        }
+        metrics_.accepted(queue_.size());
+
+        if (config_.threading == Threading::EXECUTOR) {
+            schedule();
+        }
+        return !displaced || config_.overflow != Overflow::DROP_NEWEST;
+    }
+
+    // Hand over an item that bypasses the overflow policy (see BoundedQueue::pushControl)
+    bool pushControl(T item) {
+        if (!running_) {
+            return false;
+        }
+        if (config_.threading == Threading::INLINE) {
+            metrics_.accepted(0);
+            process(item, BoundedQueue<T>::Clock::now());
+            return true;
+        }
+        if (!queue_.pushControl(std::move(item))) {
+            return false;
+        }
+        metrics_.accepted(queue_.size());
+        if (config_.threading == Threading::EXECUTOR) {
+            schedule();
+        }
+        return true;
+    }
+
+    // Drop the queued items but control items (counted as dropped); returns how many
+    size_t flush() {
+        size_t count = queue_.clear();
+        for (size_t i = 0; i < count; ++i) {
+            metrics_.dropped();
+        }
+        return count;
+    }
+
+    [[nodiscard]] StageMetrics metrics() const { return metrics_.snapshot(name_, queue_.size()); }
+    [[nodiscard]] const std::string& name() const { return name_; }
+
+private:
+    void process(T& item, typename BoundedQueue<T>::Clock::time_point enqueued) {
+        auto begin = BoundedQueue<T>::Clock::now();
+        handler_(item);
+        metrics_.processed(begin - enqueued, BoundedQueue<T>::Clock::now() - begin);
+    }
+
+    void drainLoop() {
+        T item;
+        typename BoundedQueue<T>::Clock::time_point enqueued;
+        while (queue_.pop(item, enqueued)) {
+            process(item, enqueued);
+        }
+    }
+
+    // At most one drain task per stage is in flight, which keeps items in order
+    void schedule() {
+        {
+            std::lock_guard<std::mutex> lock(drain_mutex_);
+            if (scheduled_) {
+                return;
+            }
+            scheduled_ = true;
+        }
+        executor_->post([this] {
+            T item;
+            typename BoundedQueue<T>::Clock::time_point enqueued;
+            while (true) {
+                while (queue_.tryPop(item, enqueued)) {
+                    process(item, enqueued);
+                }
+                std::lock_guard<std::mutex> lock(drain_mutex_);
+                if (queue_.size() == 0) {
+                    scheduled_ = false;
+                    drained_.notify_all();
+                    return;
+                }
+            }
+        });
+    }
+
+    std::string name_;
+    StageConfig config_;
+    Handler handler_;
+    Executor* executor_;
+    BoundedQueue<T> queue_;
+    MetricsRecorder metrics_;
+    std::atomic<bool> running_{false};
+    std::thread thread_;
+
+    std::mutex drain_mutex_;
+    std::condition_variable drained_;
+    bool scheduled_ = false;
+};
+
+} // namespace pipeline
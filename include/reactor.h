@@ -0,0 +1,325 @@
+/**
+ * @file reactor.h
+ * @brief Single-threaded epoll reactor and C++20 coroutines on top of it
+ *
+ * Every wait is an fd becoming ready: V4L2 queues and events, the DRM fd
+ * for page flips, sockets, eventfds for cross-thread wakeups and timerfds
+ * for periodic work. Coroutines started with Reactor::spawn() run on the
+ * thread calling Reactor::run() and read as straight-line code.
+ *
+ * When the reactor stops, every pending wait completes with 0 (or false),
+ * so coroutine loops unwind on their own. Keep co_await out of loop and if
+ * conditions: GCC 12 does not resume a co_await on a temporary there.
+ */
+
+#pragma once
+
+#include "pipeline.h"
+#include <atomic>
+#include <chrono>
+#include <coroutine>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <sys/epoll.h>
+
+namespace coro {
+
+template <typename T>
+class Task;
+
+namespace detail {
+
+struct PromiseBase {
+    std::coroutine_handle<> continuation;
+    std::exception_ptr error;
+    bool detached = false;
+
+    std::suspend_always initial_suspend() noexcept { return {}; }
+
+    struct FinalAwaiter {
+        bool await_ready() noexcept { return false; }
+        template <typename Promise>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) noexcept {
+            PromiseBase& promise = handle.promise();
+            if (promise.detached) {
+                handle.destroy();
+                return std::noop_coroutine();
+            }
+            return promise.continuation ? promise.continuation : std::noop_coroutine();
+        }
+        void await_resume() noexcept {}
+    };
+    FinalAwaiter final_suspend() noexcept { return {}; }
+
+    void unhandled_exception() noexcept;
+};
+
+template <typename T>
+struct Promise : PromiseBase {
+    std::optional<T> value;
+    Task<T> get_return_object() noexcept;
+    void return_value(T result) { value = std::move(result); }
+};
+
+template <>
+struct Promise<void> : PromiseBase {
+    Task<void> get_return_object() noexcept;
+    void return_void() noexcept {}
+};
+
+} // namespace detail
+
+/**
+ * @brief Lazily started coroutine; co_await it, or hand it to Reactor::spawn()
+ */
+template <typename T = void>
+class [[nodiscard]] Task {
+public:
+    using promise_type = detail::Promise<T>;
+    using Handle = std::coroutine_handle<promise_type>;
+
+    explicit Task(Handle handle) noexcept : handle_(handle) {}
+    Task(Task&& other) noexcept : handle_(std::exchange(other.handle_, {})) {}
+    Task& operator=(Task&& other) noexcept {
+        if (this != &other) {
+            if (handle_) {
+                handle_.destroy();
+            }
+            handle_ = std::exchange(other.handle_, {});
+        }
+        return *this;
+    }
+    ~Task() {
+        if (handle_) {
+            handle_.destroy();
+        }
+    }
+
+    auto operator co_await() && noexcept {
+        struct Awaiter {
+            Handle handle;
+            bool await_ready() noexcept { return false; }
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<> caller) noexcept {
+                handle.promise().continuation = caller;
+                return handle;
+            }
+            T await_resume() {
+                if (handle.promise().error) {
+                    std::rethrow_exception(handle.promise().error);
+                }
+                if constexpr (!std::is_void_v<T>) {
+                    return std::move(*handle.promise().value);
+                }
+            }
+        };
+        return Awaiter{handle_};
+    }
+
+    // Run to completion on its own; the frame frees itself at the end
+    void detach() {
+        Handle handle = std::exchange(handle_, {});
+        handle.promise().detached = true;
+        handle.resume();
+    }
+
+private:
+    Handle handle_;
+};
+
+namespace detail {
+
+template <typename T>
+Task<T> Promise<T>::get_return_object() noexcept {
+    return Task<T>(std::coroutine_handle<Promise<T>>::from_promise(*this));
+}
+
+inline Task<void> Promise<void>::get_return_object() noexcept {
+    return Task<void>(std::coroutine_handle<Promise<void>>::from_promise(*this));
+}
+
+} // namespace detail
+
+class Reactor {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    // Wait for events on an fd; resumes with the ready events (0 on shutdown or timeout)
+    class ReadyAwaiter {
+    public:
+        ReadyAwaiter(Reactor& reactor, int fd, uint32_t events, Clock::time_point deadline = Clock::time_point::max())
+            : reactor_(reactor), fd_(fd), events_(events), deadline_(deadline) {}
+
+        bool await_ready() const noexcept { return fd_ < 0 || reactor_.stopping_; }
+        void await_suspend(std::coroutine_handle<> handle);
+        uint32_t await_resume() const noexcept { return revents_; }
+
+    private:
+        friend class Reactor;
+        Reactor& reactor_;
+        int fd_;
+        uint32_t events_;
+        Clock::time_point deadline_;
+        uint32_t revents_ = 0;
+        std::coroutine_handle<> handle_;
+    };
+
+    Reactor();
+    ~Reactor();
+
+    Reactor(const Reactor&) = delete;
+    Reactor& operator=(const Reactor&) = delete;
+
+    [[nodiscard]] bool valid() const noexcept { return epoll_fd_ >= 0 && wake_fd_ >= 0; }
+
+    // Dispatch until stop(), then complete every pending wait with 0
+    void run();
+
+    // Thread-safe
+    void stop();
+    void post(std::function<void()> work);
+
+    // Start a coroutine on the reactor thread (or before run())
+    void spawn(Task<void> task) { task.detach(); }
+
+    [[nodiscard]] ReadyAwaiter ready(int fd, uint32_t events) { return ReadyAwaiter(*this, fd, events); }
+    [[nodiscard]] ReadyAwaiter ready(int fd, uint32_t events, std::chrono::milliseconds timeout) {
+        return ReadyAwaiter(*this, fd, events, Clock::now() + timeout);
+    }
+    [[nodiscard]] bool stopping() const noexcept { return stopping_; }
+
+    // Wait for the interval on a timerfd; false on shutdown
+    Task<bool> sleep(std::chrono::milliseconds interval);
+
+private:
+    struct Interest {
+        uint32_t registered = 0;
+        std::vector<ReadyAwaiter*> waiters;
+    };
+
+    void addWaiter(ReadyAwaiter* waiter);
+    void updateInterest(int fd, Interest& interest);
+    void dispatch(int fd, uint32_t revents);
+    void runPosted();
+    int nextTimeoutMs() const;
+    void expireWaiters();
+
+    int epoll_fd_ = -1;
+    int wake_fd_ = -1;
+    std::atomic<bool> stopping_{false};
+    std::map<int, Interest> interests_;
+
+    std::mutex post_mutex_;
+    std::vector<std::function<void()>> posted_;
+};
+
+/**
+ * @brief eventfd-backed wakeup: notify() from any thread, wait() on the reactor
+ */
+class Event {
+public:
+    Event();
+    ~Event();
+
+    Event(const Event&) = delete;
+    Event& operator=(const Event&) = delete;
+
+    void notify();
+
+    // False on reactor shutdown
+    Task<bool> wait(Reactor& reactor);
+
+private:
+    int fd_ = -1;
+};
+
+/**
+ * @brief Bounded queue from producer threads to one coroutine on the reactor
+ */
+template <typename T>
+class Channel {
+public:
+    Channel(size_t capacity, pipeline::Overflow overflow) : queue_(capacity, overflow), overflow_(overflow) {}
+
+    // Any thread; false if the item was dropped or the channel is closed
+    bool push(T item) {
+        bool displaced = false;
+        if (!queue_.push(std::move(item), displaced)) {
+            return false;
+        }
+        if (displaced) {
+            metrics_.dropped();
+        }
+        metrics_.accepted(queue_.size());
+        ready_.notify();
+        return !displaced || overflow_ != pipeline::Overflow::DROP_NEWEST;
+    }
+
+    // Any thread; exempt from the overflow policy, false once the channel is closed
+    bool pushControl(T item) {
+        if (!queue_.pushControl(std::move(item))) {
+            return false;
+        }
+        metrics_.accepted(queue_.size());
+        ready_.notify();
+        return true;
+    }
+
+    void close() {
+        closed_ = true;
+        queue_.close();
+        ready_.notify();
+    }
+
+    // Drop everything queued and accept items again
+    void reopen() {
+        queue_.reopen();
+        closed_ = false;
+    }
+
+    // Drop the queued items but control items (counted as dropped); returns how many
+    size_t flush() {
+        size_t count = queue_.clear();
+        for (size_t i = 0; i < count; ++i) {
+            metrics_.dropped();
+        }
+        return count;
+    }
+
+    // Next item with the time it was queued; nullopt once closed or on shutdown
+    Task<std::optional<std::pair<T, std::chrono::steady_clock::time_point>>> pop(Reactor& reactor) {
+        T item;
+        std::chrono::steady_clock::time_point enqueued;
+        while (true) {
+            if (queue_.tryPop(item, enqueued)) {
+                co_return std::make_pair(std::move(item), enqueued);
+            }
+            if (closed_) {
+                co_return std::nullopt;
+            }
+            bool woken = co_await ready_.wait(reactor);
+            if (!woken) {
+                co_return std::nullopt;
+            }
+        }
+    }
+
+    [[nodiscard]] size_t size() const { return queue_.size(); }
+    pipeline::MetricsRecorder& metrics() { return metrics_; }
+    [[nodiscard]] const pipeline::MetricsRecorder& metrics() const { return metrics_; }
+
+private:
+    pipeline::BoundedQueue<T> queue_;
+    pipeline::Overflow overflow_;
+    pipeline::MetricsRecorder metrics_;
+    Event ready_;
+    std::atomic<bool> closed_{false};
+};
+
+} // namespace coro
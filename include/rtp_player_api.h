@@ -0,0 +1,114 @@
+/**
+ * @file rtp_player_api.h
+ * @brief C interface of the zero-copy RTP player for embedding applications
+ *
+ * Configure a session with the setters, then rtp_session_start(); settings
+ * cannot change while it runs. Functions returning int give RTP_OK or a
+ * negative RTP_ERR_* code; no C++ exception ever leaves the library. A
+ * session may be used from one thread at a time, except for
+ * rtp_session_get_stats(), which may be called from any thread.
+ *
+ * Compatibility: within a major version, functions and enum values are only
+ * added, and structs only grow at the end (callers pass struct_size).
+ */
+
+#ifndef RTP_PLAYER_API_H
+#define RTP_PLAYER_API_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define RTP_PLAYER_API_VERSION_MAJOR 1
+#define RTP_PLAYER_API_VERSION_MINOR 0
+
+#define RTP_OK              0
+#define RTP_ERR_INVALID    -1   /* Bad argument */
+#define RTP_ERR_STATE      -2   /* Not allowed while running (or not running) */
+#define RTP_ERR_INIT       -3   /* Decoder, display or receiver failed to open */
+#define RTP_ERR_UNSUPPORTED -4  /* Not built into this library */
+#define RTP_ERR_NOMEM      -5   /* Out of memory */
+#define RTP_ERR_INTERNAL   -6   /* Unexpected failure inside the library */
+
+typedef struct rtp_session rtp_session_t;
+
+typedef enum {
+    RTP_DISPLAY_DRM = 0,        /* KMS planes (needs DRM master) */
+    RTP_DISPLAY_WAYLAND = 1,    /* Window on a Wayland compositor */
+    RTP_DISPLAY_NONE = 2        /* Headless: frames only go to the frame callback */
+} rtp_display_t;
+
+/* A decoded frame; pixels are read-only and stay valid until released */
+typedef struct {
+    int dma_fd;                 /* Whole-frame dma-buf, owned by the library */
+    const void* data;           /* CPU mapping of the same buffer */
+    size_t size;
+    uint32_t width;
+    uint32_t height;
+    uint32_t format;            /* V4L2 fourcc */
+    uint32_t stride;            /* Luma bytes per line */
+    uint64_t sequence;
+    int64_t timestamp_us;       /* Media time from the RTP timestamp (90 kHz clock) */
+    int64_t decoded_at_ns;      /* CLOCK_MONOTONIC */
+} rtp_frame_t;
+
+/*
+ * Called on the decoding thread for every decoded frame; return quickly.
+ * Return nonzero to keep the frame, then hand it back with
+ * rtp_frame_release() from any thread, and before rtp_session_stop().
+ * Held frames are buffers the decoder cannot reuse, so keep as few as
+ * possible. Frames are dropped without a call when memory runs out.
+ */
+typedef int (*rtp_frame_callback_t)(const rtp_frame_t* frame, void* user_data);
+
+typedef struct {
+    size_t struct_size;         /* Set to sizeof(rtp_session_stats_t) */
+    uint64_t decoded_frames;
+    uint64_t dropped_frames;
+    int64_t decode_latency_us;
+    uint64_t packets_received;
+    uint64_t packets_lost;
+    uint64_t bytes_received;
+    uint64_t display_flips;
+    double avg_flip_latency_us;
+    /* Worst thread of the process per telemetry interval */
+    double run_delay_us;                /* Last interval: average wait for a CPU */
+    uint64_t involuntary_switches;      /* Last interval: preemptions */
+    double max_run_delay_us;            /* Worst interval since start */
+    uint64_t max_involuntary_switches;
+} rtp_session_stats_t;
+
+/* Version the library was built as: (major << 16) | minor */
+uint32_t rtp_player_api_version(void);
+
+rtp_session_t* rtp_session_create(void);
+void rtp_session_destroy(rtp_session_t* session);
+
+int rtp_session_set_decoder(rtp_session_t* session, const char* device_path);
+
+/* Plain RTP on a local address; ip may be NULL for 0.0.0.0 */
+int rtp_session_set_source_rtp(rtp_session_t* session, const char* ip, uint16_t port);
+
+/* Pull the stream from a camera; RTP still arrives on the local port unless TCP is used */
+int rtp_session_set_source_rtsp(rtp_session_t* session, const char* url, int force_tcp);
+
+int rtp_session_set_display(rtp_session_t* session, rtp_display_t display);
+
+/* Pass NULL to remove the callback */
+int rtp_session_set_frame_callback(rtp_session_t* session, rtp_frame_callback_t callback, void* user_data);
+
+int rtp_session_start(rtp_session_t* session);
+void rtp_session_stop(rtp_session_t* session);
+
+int rtp_session_get_stats(const rtp_session_t* session, rtp_session_stats_t* stats);
+
+void rtp_frame_release(const rtp_frame_t* frame);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* RTP_PLAYER_API_H */
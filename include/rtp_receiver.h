@@ -0,0 +1,46 @@
+/**
+ * @file rtp_receiver.h
+ * @brief Common interface of the RTP receive paths
+ */
+
+#pragma once
+
+#include "h264_frame.h"
+#include <cstdint>
+#include <memory>
+#include <functional>
+
+class TransportFeedback;
+
+/**
+ * @brief Source of complete H.264 access units received over RTP.
+ * Implemented by the uvgRTP receiver and by the native socket / AF_XDP receiver.
+ */
+class RtpReceiver {
+public:
+    using FrameCallback = std::function<void(std::unique_ptr<H264Frame>)>;
+
+    // Statistics
+    struct Statistics {
+        uint64_t packets_received = 0;
+        uint64_t bytes_received = 0;
+        uint64_t frames_completed = 0;
+        uint64_t packets_lost = 0;
+        uint64_t frames_dropped = 0;
+    };
+
+    virtual ~RtpReceiver() = default;
+
+    virtual bool initialize() = 0;
+    virtual void setFrameCallback(FrameCallback callback) = 0;
+
+    // Optional TWCC/REMB feedback; must outlive the receiver
+    virtual void setTransportFeedback(TransportFeedback* feedback) = 0;
+
+    virtual bool start() = 0;
+    virtual void stop() = 0;
+    virtual bool isRunning() const = 0;
+
+    virtual Statistics getStatistics() const = 0;
+    virtual void resetStatistics() = 0;
+};
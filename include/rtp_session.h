@@ -0,0 +1,140 @@
+/**
+ * @file rtp_session.h
+ * @brief Receive → decode → display pipeline for embedding the player
+ */
+
+#pragma once
+
+#include "config.h"
+#include "rtp_receiver.h"
+#include "v4l2_decoder.h"
+#include "native_rtp_receiver.h"
+#include "transport_feedback.h"
+#include "rtsp_client.h"
+#include "frame_server.h"
+#include "watchdog.h"
+#include "flight_recorder.h"
+#include "pipeline.h"
+#include "thread_metrics.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * @brief One RTP/RTSP H.264 stream decoded on a V4L2 device and shown on a
+ * display backend
+ *
+ * Stages: the receiver (its own threads) feeds the decode stage, whose
+ * queue, overflow policy and threading come from Config::decode_stage; the
+ * decoder then runs capture, display and the frame consumers inline on the
+ * decode stage's thread. With Config::use_reactor the decode stage is
+ * replaced by coroutines waiting on the decoder and display fds from a
+ * single reactor thread. start() returns once the stream is being received;
+ * decoded frames can be tapped with addFrameConsumer() after initialize().
+ */
+class RtpSession {
+public:
+    struct Config {
+        std::string device_path = "/dev/video10";
+        std::string local_ip = "0.0.0.0";
+        uint16_t local_port = 5600;
+
+        TransportFeedback::Config feedback;     // Enabled when remote_port is set
+        std::vector<uint8_t> srtp_key;          // uvgRTP receiver only
+        RtspClient::Config rtsp;                // Enabled when url is set
+        bool native_receiver = false;
+        NativeRTPReceiver::Config native;
+
+        OsdConfig osd;
+        DisplayConfig display;
+        FrameServer::Config frame_server;       // Enabled when socket_path is set
+        bool watchdog_enabled = false;
+        Watchdog::Config watchdog;
+        bool flight_recorder_enabled = false;
+        FlightRecorder::Config flight_recorder;  // Dumps on errors, stalls, stream loss and latency spikes
+
+        // Between reception and the decoder: drop the oldest frame when
+        // full (latency) or BLOCK the receiver (completeness)
+        pipeline::StageConfig decode_stage{5, pipeline::Overflow::DROP_OLDEST,
+                                           pipeline::Threading::OWN_THREAD, 99};
+        size_t executor_threads = 2;            // For stages using Threading::EXECUTOR
+
+        // Run decoding, display and telemetry as coroutines on one epoll
+        // thread (reactor.h) instead of the decode stage; the queue keeps
+        // decode_stage's capacity and overflow policy
+        bool use_reactor = false;
+
+        // Stream loss: no frames for stream_timeout_ms (0: never), a new
+        // SSRC or a sequence jump drops the queued frames, restarts the
+        // decoder and waits for the next SPS, asking for a keyframe (PLI).
+        // Off by default: without a feedback channel nothing asks for the
+        // keyframe, and a sender pausing briefly would cost the GOP
+        uint32_t stream_timeout_ms = 0;
+        uint32_t keyframe_request_interval_ms = 500;    // While frames arrive without an SPS
+        bool blank_on_loss = false;                     // Instead of holding the last frame
+
+        // Low-power idle after idle_timeout_ms without frames (0: never):
+        // streaming stops, the display keeps a still copy of the last frame
+        // (or blanks) and periodic work pauses until packets return
+        uint32_t idle_timeout_ms = 0;
+        bool idle_release_buffers = false;              // Free the decoder's DMA-bufs while idle
+    };
+
+    // Scheduling of the process's threads per telemetry interval, worst thread
+    struct Scheduling {
+        double run_delay_us = 0.0;              // Last interval: highest average wait for a CPU
+        uint64_t involuntary_switches = 0;      // Last interval: most preemptions
+        double max_run_delay_us = 0.0;          // Worst interval since start
+        uint64_t max_involuntary_switches = 0;
+        std::string max_run_delay_thread;
+        std::string max_switches_thread;
+    };
+
+    struct Statistics {
+        uint64_t decoded_frames = 0;
+        uint64_t dropped_frames = 0;            // Frames pushed out of a full decode queue
+        int64_t decode_latency_us = 0;          // Smoothed receive-to-decoded latency
+        size_t queue_depth = 0;
+        RtpReceiver::Statistics receiver;
+        DisplayBackend::Statistics display;
+        std::vector<pipeline::StageMetrics> stages;
+        V4L2Decoder::RecoveryStatistics recovery;
+        Watchdog::Statistics watchdog;
+        FlightRecorder::Statistics flight_recorder;
+        uint64_t stream_losses = 0;
+        uint64_t keyframe_requests = 0;
+        int64_t last_reacquisition_ms = -1;     // First frame after a loss to the first decoded frame
+        bool stream_lost = false;
+        uint64_t idle_entries = 0;
+        bool idle = false;
+        Scheduling scheduling;
+    };
+
+    explicit RtpSession(const Config& config);
+    ~RtpSession();
+
+    RtpSession(const RtpSession&) = delete;
+    RtpSession& operator=(const RtpSession&) = delete;
+
+    // Open the decoder, the display and the receiver
+    [[nodiscard]] bool initialize();
+
+    // Start receiving and decoding; does not block
+    [[nodiscard]] bool start();
+    void stop();
+    [[nodiscard]] bool isRunning() const;
+
+    // See V4L2Decoder::addFrameConsumer(); -1 before initialize()
+    [[nodiscard]] int addFrameConsumer(V4L2Decoder::FrameConsumer consumer);
+    void removeFrameConsumer(int id);
+
+    [[nodiscard]] Statistics getStatistics() const;
+
+    // Every thread of the process (uvgRTP's included); rates are since the previous call
+    [[nodiscard]] std::vector<pipeline::ThreadMetrics> getThreadMetrics();
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> impl_;
+};
@@ -0,0 +1,142 @@
+/**
+ * @file rtsp_client.h
+ * @brief Minimal RTSP client with pipelined session setup for fast startup
+ */
+
+#pragma once
+
+#include "h264_frame.h"
+#include "h264_depacketizer.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <memory>
+#include <functional>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <map>
+
+/**
+ * @brief RTSP client (RFC 2326) that opens an H.264 session on a camera.
+ *
+ * Startup is optimized for time-to-first-frame:
+ *  - SETUP and PLAY are pipelined on the connection, so the stream starts
+ *    one round trip after DESCRIBE. A server that needs the session id from
+ *    the SETUP response answers the early PLAY with an error; PLAY is then
+ *    resent with the id (two round trips, as without pipelining) and not
+ *    sent early to that server again;
+ *  - SPS/PPS from the SDP sprop-parameter-sets are delivered as the first
+ *    frame so the decoder is primed before the first RTP packet;
+ *  - a keyframe is requested (RTCP PLI) as soon as PLAY is acknowledged.
+ *
+ * RTP is received over UDP by the regular receiver on client_rtp_port. If the
+ * server refuses UDP (461) or TCP is forced, RTP is interleaved on the RTSP
+ * connection and depacketized here.
+ */
+class RtspClient {
+public:
+    using FrameCallback = std::function<void(std::unique_ptr<H264Frame>)>;
+
+    enum class Transport {
+        AUTO,   // UDP, falling back to interleaved TCP
+        UDP,
+        TCP
+    };
+
+    struct Config {
+        std::string url;                // rtsp://[user:pass@]host[:port]/path
+        uint16_t client_rtp_port = 5600;
+        Transport transport = Transport::AUTO;
+        uint32_t timeout_ms = 5000;
+    };
+
+    explicit RtspClient(const Config& config);
+    ~RtspClient();
+
+    RtspClient(const RtspClient&) = delete;
+    RtspClient& operator=(const RtspClient&) = delete;
+
+    // Frames received over the interleaved transport, plus the SDP parameter sets
+    void setFrameCallback(FrameCallback callback);
+
+    /**
+     * @brief Connect, DESCRIBE, SETUP + PLAY and request a keyframe
+     * @return true once the server acknowledged PLAY
+     */
+    bool start();
+    void stop();
+
+    // Ask the sender for a new IDR frame
+    bool requestKeyframe();
+
+    [[nodiscard]] bool isInterleaved() const { return interleaved_; }
+    [[nodiscard]] bool isRunning() const { return running_; }
+
+private:
+    enum class SetupResult {
+        OK,
+        UNSUPPORTED_TRANSPORT,
+        FAILED
+    };
+
+    struct Response {
+        std::string version;                        // "RTSP/1.0", "RTSP/2.0"
+        int status = 0;
+        int cseq = -1;
+        std::map<std::string, std::string> headers;  // Lower-case names
+        std::string body;
+    };
+
+    bool parseUrl();
+    bool connectSocket();
+    bool sendRequest(const std::string& method, const std::string& url,
+                     const std::vector<std::string>& extra_headers, int& cseq);
+    bool readResponse(Response& response, uint32_t timeout_ms);
+    bool extractResponse(Response& response);
+    bool readMore(uint32_t timeout_ms);
+    bool handleInterleavedData();
+    bool describe();
+    SetupResult setupAndPlay(bool tcp);
+    bool sendKeepAlive();
+    bool parseSdp(const std::string& sdp);
+    void deliverParameterSets();
+    void sendUdpRtcp(const std::vector<uint8_t>& packet);
+    void readerLoop();
+
+    Config config_;
+
+    // Parsed URL
+    std::string host_;
+    uint16_t port_ = 554;
+    std::string request_url_;
+    std::string authorization_;
+
+    int socket_fd_ = -1;
+    int rtcp_socket_fd_ = -1;
+    bool connection_closed_ = false;
+    std::mutex send_mutex_;
+    std::vector<uint8_t> rx_buffer_;
+    int next_cseq_ = 1;
+
+    // Session state
+    std::string content_base_;
+    std::string control_url_;
+    std::string session_id_;
+    bool speculative_play_ = true;          // PLAY before the SETUP response; off once the server rejects it
+    uint32_t session_timeout_s_ = 60;
+    int payload_type_ = 96;
+    uint32_t local_ssrc_ = 0;
+    uint32_t media_ssrc_ = 0;
+    uint16_t server_rtcp_port_ = 0;
+    std::vector<uint8_t> parameter_sets_;   // Annex B SPS/PPS from the SDP
+    bool interleaved_ = false;
+    uint8_t rtp_channel_ = 0;
+    uint8_t rtcp_channel_ = 1;
+
+    H264Depacketizer depacketizer_;
+    FrameCallback frame_callback_;
+
+    std::thread reader_thread_;
+    std::atomic<bool> running_;
+};
@@ -2,6 +2,7 @@
 #define STREAMING_MANAGER_H
 
 #include <memory>
+#include <vector>
 
 // Forward declarations to avoid circular dependencies
 class V4L2Device;
@@ -13,13 +14,15 @@ public:
     ~StreamingManager();
 
     [[nodiscard]] bool start();
+    // Queue only these CAPTURE buffers; the others are still held (displayed or exported)
+    [[nodiscard]] bool start(const std::vector<unsigned int>& capture_buffers);
     [[nodiscard]] bool stop();
     [[nodiscard]] bool is_active() const;
     void set_inactive();
 
 
 private:
-    [[nodiscard]] bool queueOutputBuffers();
+    [[nodiscard]] bool queueOutputBuffers(const std::vector<unsigned int>& indices);
     [[nodiscard]] bool queueOutputBuffer(unsigned int index);
     [[nodiscard]] bool enableStreaming();
 
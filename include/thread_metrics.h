@@ -0,0 +1,62 @@
+/**
+ * @file thread_metrics.h
+ * @brief Per-thread CPU time, context switches and scheduling delay
+ */
+
+#pragma once
+
+#include <sys/types.h>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace pipeline {
+
+struct ThreadMetrics {
+    pid_t tid = 0;
+    std::string name;                       // Thread name (see setThreadName())
+    int cpu = -1;                           // CPU it last ran on
+    int policy = 0;                         // SCHED_OTHER, SCHED_FIFO, ...
+    int priority = 0;                       // Real-time priority (0 for SCHED_OTHER)
+
+    // Totals since the thread started
+    uint64_t cpu_time_us = 0;
+    uint64_t run_delay_us = 0;              // Runnable but waiting for a CPU
+    uint64_t voluntary_switches = 0;        // Blocked (I/O, locks, sleeps)
+    uint64_t involuntary_switches = 0;      // Preempted
+
+    // Since the previous sample
+    double cpu_percent = 0.0;               // Of one CPU
+    double avg_run_delay_us = 0.0;          // Per time slice: wakeup (or preemption) to running
+    uint64_t new_involuntary_switches = 0;
+};
+
+/**
+ * @brief Samples every thread of the process from /proc/self/task
+ *
+ * CPU time and run delay come from schedstat (time on CPU, time waiting on
+ * a run queue, time slices), context switches from status. Rates are
+ * relative to the previous sample() call; the first call reports totals
+ * only, so sample once as a baseline. Thread-safe.
+ */
+class ThreadSampler {
+public:
+    [[nodiscard]] std::vector<ThreadMetrics> sample();
+
+private:
+    struct Previous {
+        uint64_t cpu_ns = 0;
+        uint64_t run_delay_ns = 0;
+        uint64_t slices = 0;
+        uint64_t involuntary_switches = 0;
+    };
+
+    std::mutex mutex_;
+    std::chrono::steady_clock::time_point last_sample_;
+    std::map<pid_t, Previous> previous_;
+};
+
+} // namespace pipeline
@@ -0,0 +1,143 @@
+/**
+ * @file transport_feedback.h
+ * @brief Transport-wide congestion control feedback (TWCC) and REMB sender
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <map>
+#include <deque>
+#include <string>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+
+/**
+ * @brief Records arrival times per transport-wide sequence number and reports
+ * them back to the sender as RTCP transport-cc feedback
+ * (draft-holmer-rmcat-transport-wide-cc-extensions-01), optionally
+ * together with a REMB message carrying a receiver-side delay-based estimate.
+ *
+ * Feedback is sent from a dedicated thread at a fixed interval so that the
+ * receive path only pays for a map insertion per packet. The thread sleeps
+ * while no packets arrive (idle stream) and wakes with the first one.
+ */
+class TransportFeedback {
+public:
+    struct Config {
+        std::string remote_ip;              // Sender RTCP address
+        uint16_t remote_port = 0;           // Sender RTCP port (usually RTP port + 1)
+        uint8_t extension_id = 5;           // Negotiated id of the transport-cc header extension
+        bool enable_twcc = true;
+        bool enable_remb = false;
+        uint32_t feedback_interval_ms = 50;
+        uint32_t min_bitrate_bps = 300000;
+        uint32_t max_bitrate_bps = 50000000;
+    };
+
+    struct Statistics {
+        uint64_t packets_recorded = 0;
+        uint64_t feedback_packets_sent = 0;
+        uint64_t remb_packets_sent = 0;
+        uint32_t estimated_bitrate_bps = 0;
+        uint32_t incoming_bitrate_bps = 0;
+        double delay_trend = 0.0;
+    };
+
+    explicit TransportFeedback(const Config& config);
+    ~TransportFeedback();
+
+    TransportFeedback(const TransportFeedback&) = delete;
+    TransportFeedback& operator=(const TransportFeedback&) = delete;
+
+    bool initialize();
+    bool start();
+    void stop();
+
+    /**
+     * @brief Record the arrival of an RTP packet
+     * @param transport_seq transport-wide sequence number from the header extension
+     * @param media_ssrc SSRC of the media stream
+     * @param rtp_timestamp RTP timestamp (90 kHz) used by the delay estimator
+     * @param size packet size in bytes
+     * @param arrival local arrival time
+     */
+    void onPacketArrival(uint16_t transport_seq, uint32_t media_ssrc, uint32_t rtp_timestamp,
+                         size_t size, std::chrono::steady_clock::time_point arrival);
+
+    /**
+     * @brief Extract the transport-wide sequence number from a raw RTP header extension
+     * @param profile extension profile (0xBEDE one-byte or 0x100x two-byte header)
+     * @param data extension payload
+     * @param length payload length in bytes
+     * @param extension_id negotiated extension element id
+     * @param transport_seq result
+     * @return true if the element was found
+     */
+    static bool parseTransportSequence(uint16_t profile, const uint8_t* data, size_t length,
+                                       uint8_t extension_id, uint16_t& transport_seq);
+
+    /**
+     * @brief Send an RTCP Picture Loss Indication asking the sender for a keyframe
+     */
+    bool sendPictureLossIndication(uint32_t media_ssrc);
+
+    /**
+     * @brief Build a compound RTCP packet (empty RR + PLI) for transports that
+     * carry RTCP themselves, e.g. RTSP interleaved channels
+     */
+    static std::vector<uint8_t> buildPictureLossIndication(uint32_t sender_ssrc, uint32_t media_ssrc);
+
+    uint8_t extensionId() const { return config_.extension_id; }
+
+    Statistics getStatistics() const;
+
+private:
+    void feedbackLoop();
+    void sendFeedback();
+    void buildTwccPackets(std::vector<std::vector<uint8_t>>& packets);
+    void buildRemb(std::vector<uint8_t>& packet) const;
+    void updateDelayEstimate(uint32_t rtp_timestamp, int64_t arrival_us, size_t size);
+    bool sendPacket(const std::vector<uint8_t>& packet);
+
+    Config config_;
+    int socket_fd_ = -1;
+    uint32_t sender_ssrc_ = 0;
+    uint32_t media_ssrc_ = 0;
+
+    std::thread feedback_thread_;
+    std::atomic<bool> running_;
+    std::mutex wake_mutex_;
+    std::condition_variable wake_condition_;
+    std::atomic<bool> arrivals_pending_{false};    // Since the last report; set under wake_mutex_
+
+    mutable std::mutex mutex_;
+
+    // Arrival times (microseconds) keyed by unwrapped transport sequence number
+    std::map<int64_t, int64_t> arrivals_;
+    int64_t last_unwrapped_seq_ = -1;
+    int64_t next_feedback_seq_ = -1;
+    uint8_t feedback_count_ = 0;
+
+    // Delay-based estimator state
+    struct DelaySample {
+        double arrival_ms;
+        double smoothed_delay_ms;
+    };
+    std::deque<DelaySample> delay_window_;
+    std::deque<std::pair<int64_t, size_t>> rate_window_;
+    bool have_group_ = false;
+    uint32_t group_rtp_timestamp_ = 0;
+    int64_t group_arrival_us_ = 0;
+    int64_t first_arrival_us_ = 0;
+    double accumulated_delay_ms_ = 0.0;
+    double smoothed_delay_ms_ = 0.0;
+    double estimated_bitrate_ = 0.0;
+    int64_t last_estimate_update_us_ = 0;
+
+    Statistics stats_;
+};
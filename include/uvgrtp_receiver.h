@@ -5,6 +5,7 @@
 
 #pragma once
 
+#include "rtp_receiver.h"
 #include <uvgrtp/lib.hh>
 #include <cstdint>
 #include <vector>
@@ -16,53 +17,43 @@
 #include <string>
 #include <chrono>
 
-/**
- * @brief A complete H.264 frame (already defragmented by uvgRTP)
- */
-struct H264Frame {
-    std::vector<uint8_t> data;  // Full frame, ready for decoding
-    uint32_t timestamp;
-    std::chrono::steady_clock::time_point received_time;
-
-    H264Frame() : timestamp(0) {
-        received_time = std::chrono::steady_clock::now();
-    }
-};
-
 /**
  * @brief RTP receiver based on uvgRTP with automatic defragmentation.
  * uvgRTP automatically reassembles fragmented RTP packets into complete H.264 frames.
  */
-class UvgRTPReceiver {
+class UvgRTPReceiver : public RtpReceiver {
 public:
-    using FrameCallback = std::function<void(std::unique_ptr<H264Frame>)>;
-
     UvgRTPReceiver(const std::string& local_ip = "0.0.0.0", uint16_t local_port = 5600);
-    ~UvgRTPReceiver();
+    ~UvgRTPReceiver() override;
 
-    bool initialize();
-    void setFrameCallback(FrameCallback callback);
+    bool initialize() override;
+    void setFrameCallback(FrameCallback callback) override;
+    void setTransportFeedback(TransportFeedback* feedback) override;
 
-    bool start();
-    void stop();
+    /**
+     * @brief Enable SRTP (AES-CM 128, HMAC-SHA1) with a user-managed master key.
+     * Must be called before initialize(). Packets are decrypted in place by uvgRTP.
+     * @param master_key_and_salt 16-byte master key followed by the 14-byte master salt
+     * @return false if the key has the wrong size or SRTP support is not compiled in
+     */
+    bool setSrtpMasterKey(const std::vector<uint8_t>& master_key_and_salt);
 
-    bool isRunning() const { return running_; }
+    static constexpr size_t SRTP_MASTER_KEY_SIZE = 16;
+    static constexpr size_t SRTP_MASTER_SALT_SIZE = 14;
 
-    // Statistics
-    struct Statistics {
-        uint64_t packets_received = 0;
-        uint64_t bytes_received = 0;
-        uint64_t frames_completed = 0;
-        uint64_t packets_lost = 0;
-        uint64_t frames_dropped = 0;
-    };
+    bool start() override;
+    void stop() override;
+
+    bool isRunning() const override { return running_; }
 
-    Statistics getStatistics() const;
-    void resetStatistics();
+    Statistics getStatistics() const override;
+    void resetStatistics() override;
 
 private:
     static void frameReceiveHook(void* arg, uvgrtp::frame::rtp_frame* frame);
     void processFrame(uvgrtp::frame::rtp_frame* frame);
+    void recordTransportFeedback(const uvgrtp::frame::rtp_frame* frame);
+    bool detectRestart(uint16_t seq, uint32_t ssrc);
 
     // uvgRTP objects
     std::unique_ptr<uvgrtp::context> ctx_;
@@ -73,6 +64,10 @@ private:
     std::string local_ip_;
     uint16_t local_port_;
 
+    // SRTP master key and salt (empty when SRTP is disabled)
+    std::vector<uint8_t> srtp_key_;
+    std::vector<uint8_t> srtp_salt_;
+
     // State
     std::atomic<bool> running_;
     std::atomic<bool> initialized_;
@@ -80,6 +75,14 @@ private:
     // Callback for complete frames
     FrameCallback frame_callback_;
 
+    // Sequence of the newest frame, for restart detection (receive thread only)
+    bool have_seq_ = false;
+    uint16_t last_seq_ = 0;
+    uint32_t last_ssrc_ = 0;
+
+    // Congestion control feedback
+    TransportFeedback* transport_feedback_ = nullptr;
+
     // Statistics
     mutable std::mutex stats_mutex_;
     Statistics stats_;
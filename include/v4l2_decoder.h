@@ -1,11 +1,20 @@
 #pragma once
 
 #include "config.h"
+#include "display_backend.h"
+#include "decoded_frame.h"
+#include "pipeline.h"
+#include <array>
+#include <cstdint>
+#include <functional>
 #include <memory>
 #include <string_view>
+#include <string>
+#include <vector>
 
 class V4L2DecoderImpl;
 class DmaBufAllocator;
+class FlightRecorder;
 
 /**
  * @brief V4L2 Hardware H.264 Decoder
@@ -18,7 +27,8 @@ class V4L2Decoder {
 public:
     enum class DisplayType {
         NONE,       // No display
-        DRM_DMABUF  // TRUE Zero-Copy via DMA-buf
+        DRM_DMABUF, // TRUE Zero-Copy via DMA-buf
+        WAYLAND     // DMA-buf handed to a Wayland compositor
     };
 
 private:
@@ -29,12 +39,117 @@ public:
     ~V4L2Decoder();
 
     [[nodiscard]] bool initialize(const DecoderConfig& config);
-    [[nodiscard]] bool setDisplay();
-    [[nodiscard]] bool decodeData(const uint8_t* data, size_t size);
+    [[nodiscard]] bool setDisplay();   // Output chosen by DecoderConfig::display.output
+    // rtp_timestamp comes back on the decoded frame (DecodedFrame::rtp_timestamp)
+    [[nodiscard]] bool decodeData(const uint8_t* data, size_t size, uint32_t rtp_timestamp);
+
+    /**
+     * @brief Non-blocking halves of decodeData() for event loops (reactor.h)
+     *
+     * trySubmitData() leaves submitted false while every OUTPUT buffer is
+     * queued: wait for deviceFd() to become writable and retry. Call
+     * collectFrames() when deviceFd() is readable (frame) or has a priority
+     * event. While displayBusy(), collecting would block on the previous
+     * page flip: wait for displayEventFd() and dispatchDisplayEvents() first.
+     * collectFrames() returns after the first frame that starts a page flip,
+     * so a call never blocks on the flip it caused.
+     */
+    [[nodiscard]] bool trySubmitData(const uint8_t* data, size_t size, uint32_t rtp_timestamp, bool& submitted);
+    [[nodiscard]] bool collectFrames();
+    [[nodiscard]] int deviceFd() const;
+    [[nodiscard]] int displayEventFd() const;  // -1 if the display has none
+    [[nodiscard]] bool displayBusy() const;
+    void dispatchDisplayEvents();
+
     [[nodiscard]] bool flushDecoder();  // Force flush decoder buffers
+
+    /**
+     * @brief Start over for a new stream (decoding thread only)
+     *
+     * Discards queued bitstream and undisplayed frames by restarting both
+     * queues; decoding resumes at the next keyframe. The last frame stays
+     * on screen unless blank_display is set.
+     */
+    [[nodiscard]] bool resetStream(bool blank_display);
+
+    /**
+     * @brief Low-power idle (decoding thread only)
+     *
+     * Stops streaming; the display shows a copy of the last frame (or
+     * blanks). With release_buffers the DMA-bufs are freed too, unless a
+     * consumer still holds one. The next submission reallocates them and
+     * restarts streaming; decoding resumes at the next keyframe.
+     */
+    [[nodiscard]] bool suspend(bool blank_display, bool release_buffers);
     [[nodiscard]] bool resetBuffers();  // Full reset and recreation of buffers
     [[nodiscard]] int getDecodedFrameCount() const;
 
+    /**
+     * @brief Recovery ladder run before the next submission after POLLERR
+     *
+     * Steps are tried in order until the device stops reporting the error.
+     * An error soon after a recovery starts one step higher than the step
+     * that last worked, so a cheap step that keeps failing is skipped.
+     */
+    enum class RecoveryStep {
+        REQUEUE,            // Give idle CAPTURE buffers back to the driver
+        RESTART_CAPTURE,    // STREAMOFF/STREAMON of the CAPTURE queue only
+        RESTART_DECODER,    // Both queues; decoding resumes at the next keyframe
+        REALLOCATE          // resetBuffers() and restart streaming
+    };
+    static constexpr size_t RECOVERY_STEPS = 4;
+    [[nodiscard]] static const char* recoveryStepName(RecoveryStep step);
+
+    struct RecoveryStatistics {
+        std::array<uint64_t, RECOVERY_STEPS> attempts{};
+        std::array<uint64_t, RECOVERY_STEPS> recovered{};   // Step cleared the error
+        std::array<uint64_t, RECOVERY_STEPS> total_us{};
+        std::array<uint64_t, RECOVERY_STEPS> max_us{};
+        uint64_t failures = 0;                              // Every step failed
+    };
+    [[nodiscard]] RecoveryStatistics getRecoveryStatistics() const;
+
+    // Run the ladder from at least this step before the next submission; thread-safe
+    void requestRecovery(RecoveryStep from);
+
+    // Ask the display to re-establish presentation; thread-safe
+    void requestDisplayRecovery();
+
+    // Monotonic progress counters for stall detection; safe from any thread
+    struct Progress {
+        uint64_t submitted = 0;         // Access units queued on OUTPUT
+        uint64_t submit_waits = 0;      // Submissions that found every OUTPUT buffer busy
+        uint64_t dequeued = 0;          // CAPTURE buffers dequeued
+        uint64_t presented = 0;         // Flips confirmed by the display
+        bool has_display = false;
+    };
+    [[nodiscard]] Progress getProgress() const;
+
+    // Metrics of the capture and display stages run on the decoding thread
+    [[nodiscard]] std::vector<pipeline::StageMetrics> getStageMetrics() const;
+
+    // Presentation timing of the display (zeroes without one)
+    [[nodiscard]] DisplayBackend::Statistics getDisplayStatistics() const;
+
+    // Text for the telemetry overlay (DecoderConfig::osd); no-op without one
+    void setOsdText(const std::vector<std::string>& lines);
+
+    /**
+     * @brief Zero-copy access to decoded frames next to the display
+     *
+     * Consumers run on the decoding thread for every decoded frame and must
+     * return quickly; keeping a copy of the handle keeps the buffer out of
+     * the decoder until it is dropped (from any thread). Do not add or remove
+     * consumers from inside a consumer.
+     * @return Id for removeFrameConsumer()
+     */
+    using FrameConsumer = std::function<void(const DecodedFrameRef&)>;
+    [[nodiscard]] int addFrameConsumer(FrameConsumer consumer);
+    void removeFrameConsumer(int id);
+
+    // Record submissions, dequeues, errors and recoveries (nullptr: off); set before decoding starts
+    void setFlightRecorder(FlightRecorder* recorder);
+
     V4L2Decoder(const V4L2Decoder&) = delete;
     V4L2Decoder& operator=(const V4L2Decoder&) = delete;
 };
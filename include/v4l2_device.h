@@ -33,6 +33,7 @@ public:
     [[nodiscard]] bool request_buffers(v4l2_requestbuffers& req);
     [[nodiscard]] bool queue_buffer(v4l2_buffer& buf);
     [[nodiscard]] bool dequeue_buffer(v4l2_buffer& buf);
+    [[nodiscard]] bool query_buffer(v4l2_buffer& buf);
     [[nodiscard]] bool stream_on(enum v4l2_buf_type type);
     [[nodiscard]] bool stream_off(enum v4l2_buf_type type);
     [[nodiscard]] bool subscribe_to_events();
@@ -0,0 +1,59 @@
+/**
+ * @file watchdog.h
+ * @brief Detects decoder and display stalls and triggers recovery
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+class V4L2Decoder;
+
+/**
+ * @brief Watches the decoder's progress counters from its own thread
+ *
+ * A stage is stalled when work keeps arriving but its output counter stops
+ * moving for stall_frames frame intervals (measured from the decoded frame
+ * rate, never less than min_stall_ms):
+ *  - decoder: access units are submitted (or wait for a free OUTPUT buffer)
+ *    but no CAPTURE buffer is dequeued;
+ *  - display: frames are decoded but no flip is confirmed.
+ *
+ * On a stall a diagnostic snapshot is logged (and appended to
+ * snapshot_path) and a recovery is requested: a decoder restart first, a
+ * full reallocation if the next check finds it still stalled; a display
+ * re-probe for the display. Recovery runs on the decoding thread.
+ */
+class Watchdog {
+public:
+    struct Config {
+        uint32_t check_interval_ms = 100;
+        uint32_t stall_frames = 15;
+        uint32_t min_stall_ms = 500;
+        std::string snapshot_path;      // Empty: log only
+    };
+
+    struct Statistics {
+        uint64_t decoder_stalls = 0;
+        uint64_t display_stalls = 0;
+        uint64_t escalations = 0;       // Stalls that outlived a decoder restart
+    };
+
+    explicit Watchdog(const Config& config);
+    ~Watchdog();
+
+    Watchdog(const Watchdog&) = delete;
+    Watchdog& operator=(const Watchdog&) = delete;
+
+    // The decoder must outlive stop()
+    [[nodiscard]] bool start(V4L2Decoder& decoder);
+    void stop() noexcept;
+
+    [[nodiscard]] Statistics getStatistics() const;
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> impl_;
+};
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "display_backend.h"
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+/**
+ * @brief Zero-copy output as a client of a Wayland compositor
+ *
+ * Decoder buffers are wrapped once as wl_buffers through zwp_linux_dmabuf_v1
+ * and attached to a fullscreen xdg_toplevel, so the compositor scans out or
+ * samples them directly. wp_presentation feedback provides the presentation
+ * latency; wp_fifo_v1 (VSYNC mode) and wp_commit_timing_v1 pace the commits
+ * when the compositor offers them. Does not need DRM master, so the player
+ * can run inside a desktop session (or against a headless Weston).
+ */
+class WaylandDisplay : public DisplayBackend {
+public:
+    WaylandDisplay();
+    ~WaylandDisplay() override;
+
+    WaylandDisplay(const WaylandDisplay&) = delete;
+    WaylandDisplay& operator=(const WaylandDisplay&) = delete;
+
+    void setConfig(const DisplayConfig& config) override;
+
+    // Rotation/reflection is a wl_surface buffer transform, always available
+    [[nodiscard]] bool transformApplied() const override;
+
+    bool initialize(uint32_t width, uint32_t height) override;
+    bool displayFrame(const FrameInfo& frame) override;
+    void cleanup() noexcept override;
+    std::string getDisplayInfo() const override;
+
+    bool setupZeroCopyBuffer(int dma_fd, uint32_t width, uint32_t height, uint32_t stride) override;
+    std::vector<int> takeReleasedBuffers() override;
+    Statistics getStatistics() const override;
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> impl_;
+};
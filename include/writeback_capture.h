@@ -0,0 +1,74 @@
+#pragma once
+
+#include "config.h"
+#include <memory>
+#include <cstdint>
+
+struct _drmModeAtomicReq;
+
+/**
+ * @brief Captures the scanned-out picture through a DRM writeback connector
+ *
+ * The connector is attached to the video CRTC and every atomic flip carries
+ * a free capture buffer (dumb XRGB8888, exported as a dma-buf) plus an
+ * out-fence. A worker thread waits for the fence, timestamps the capture
+ * with the fence's signal time, checksums it and optionally logs/dumps it,
+ * so scanout content, ordering and commit-to-writeback latency can be
+ * checked without a camera.
+ *
+ * Scanning out testPatternFb() verifies the path itself: the capture of that
+ * known frame must checksum the same as the frame (X byte ignored).
+ */
+class WritebackCapture {
+public:
+    struct Statistics {
+        uint64_t captured = 0;
+        uint64_t skipped = 0;       // Flips without a free capture buffer
+        uint64_t repeated = 0;      // Captures identical to the previous one
+        double avg_latency_us = 0.0;
+        uint64_t max_latency_us = 0;
+        uint64_t verified = 0;      // Test pattern captures that matched
+        uint64_t mismatches = 0;    // ... and that did not
+    };
+
+    explicit WritebackCapture(const WritebackConfig& config);
+    ~WritebackCapture();
+
+    WritebackCapture(const WritebackCapture&) = delete;
+    WritebackCapture& operator=(const WritebackCapture&) = delete;
+
+    /**
+     * @brief Find a writeback connector for the CRTC and allocate capture buffers
+     * @param crtc_index Index of the CRTC in drmModeRes::crtcs (for possible_crtcs)
+     */
+    [[nodiscard]] bool initialize(int drm_fd, uint32_t crtc_id, uint32_t crtc_index,
+                                  uint32_t display_width, uint32_t display_height);
+
+    /**
+     * @brief Add the writeback state to an atomic request
+     * @param modeset The commit (re)binds the connector to the CRTC
+     * @return false when no capture buffer is free (the flip goes uncaptured)
+     */
+    bool addToCommit(_drmModeAtomicReq* req, bool modeset, uint32_t source_fb_id);
+
+    // Report the result of the commit prepared by addToCommit()
+    void commitDone(bool committed);
+
+    // Detach the connector from the CRTC (a modeset commit); the next modeset rebinds it
+    void addUnbind(_drmModeAtomicReq* req);
+
+    // Display-sized XRGB8888 framebuffer with a known pattern, kept until shutdown (0 on failure)
+    [[nodiscard]] uint32_t testPatternFb();
+
+    // Wait until every committed capture has been processed
+    bool drain(int timeout_ms);
+
+    [[nodiscard]] Statistics getStatistics() const;
+
+    // Stop the worker and free the buffers
+    void shutdown() noexcept;
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> impl_;
+};
@@ -3,243 +3,35 @@
  * @brief RTP Player for receiving and decoding H.264 RTP stream in real-time
  */
 
-#include "v4l2_decoder.h"
-#include "config.h"
-#include "uvgrtp_receiver.h"
+#include "rtp_session.h"
 #include <iostream>
-#include <thread>
-#include <atomic>
 #include <memory>
 #include <string>
 #include <vector>
-#include <queue>
-#include <mutex>
-#include <condition_variable>
-#include <chrono>
 #include <cstdint>
-#include <sched.h>
 #include <cstring>
+#include <cstdlib>
+#include <cstdio>
+#include <algorithm>
+#include <sched.h>
 
-class RTPPlayer {
-public:
-    RTPPlayer(const std::string& device_path, const std::string& local_ip, uint16_t local_port)
-        : device_path_(device_path), local_ip_(local_ip), local_port_(local_port), 
-          running_(false), decoded_frames_(0), has_sps_(false) {}
-
-    ~RTPPlayer() {
-        stop();
+// Parse a hex string ("00ff...") into bytes
+bool parseHexKey(const std::string& hex, std::vector<uint8_t>& out) {
+    if (hex.size() % 2 != 0) {
+        return false;
     }
-
-    bool initialize() {
-        // Create configuration
-        DecoderConfig config;
-        config.device_path = device_path_;
-        // Other parameters remain default
-
-        // Initialize V4L2 decoder
-        decoder_ = std::make_unique<V4L2Decoder>();
-        if (!decoder_->initialize(config)) {
-            std::cerr << "Error initializing V4L2 decoder" << std::endl;
-            return false;
-        }
-
-        // Configure display
-        if (!decoder_->setDisplay()) {
-            std::cerr << "Error configuring display" << std::endl;
+    out.clear();
+    for (size_t i = 0; i < hex.size(); i += 2) {
+        char* end = nullptr;
+        std::string byte = hex.substr(i, 2);
+        long value = std::strtol(byte.c_str(), &end, 16);
+        if (*end != '\0') {
             return false;
         }
-
-        // Initialize RTP receiver
-        rtp_receiver_ = std::make_unique<UvgRTPReceiver>(local_ip_, local_port_);
-        if (!rtp_receiver_->initialize()) {
-            std::cerr << "Error initializing RTP receiver" << std::endl;
-            return false;
-        }
-
-        // Set callback for frame processing
-        rtp_receiver_->setFrameCallback([this](std::unique_ptr<H264Frame> frame) {
-            this->onFrameReceived(std::move(frame));
-        });
-
-        std::cout << "RTP Player initialized: " << local_ip_ << ":" << local_port_ << std::endl;
-        return true;
-    }
-
-    void start() {
-        if (!rtp_receiver_) {
-            std::cerr << "RTP receiver not initialized" << std::endl;
-            return;
-        }
-
-        running_ = true;
-        
-        // Start the decoding thread
-        decoder_thread_ = std::thread(&RTPPlayer::decoderLoop, this);
-
-        // Set real-time priority for the decoder thread
-        sched_param sch_params;
-        sch_params.sched_priority = sched_get_priority_max(SCHED_FIFO);
-        if (pthread_setschedparam(decoder_thread_.native_handle(), SCHED_FIFO, &sch_params) != 0) {
-            std::cerr << "⚠️ WARNING: Failed to set real-time priority for the decoder thread. "
-                      << "Run with sudo for better performance. Error: " << strerror(errno) << std::endl;
-        } else {
-            std::cout << "✅ Real-time priority (SCHED_FIFO) set for the decoder thread." << std::endl;
-        }
-        
-        // Start the RTP receiver
-        if (!rtp_receiver_->start()) {
-            std::cerr << "Error starting RTP receiver" << std::endl;
-            running_ = false;
-            return;
-        }
-        
-        std::cout << "RTP Player started, waiting for H.264 data on " << local_ip_ << ":" << local_port_ << std::endl;
-        std::cout << "Press Enter to stop..." << std::endl;
-        std::cin.get();
-        
-        stop();
-    }
-
-    void stop() {
-        running_ = false;
-        
-        // Stop the RTP receiver
-        if (rtp_receiver_) {
-            rtp_receiver_->stop();
-        }
-        
-        // Signal the decoder to terminate
-        frame_condition_.notify_all();
-        
-        if (decoder_thread_.joinable()) {
-            decoder_thread_.join();
-        }
-        
-        std::cout << "RTP Player stopped" << std::endl;
-    }
-
-    // Statistics
-    int getDecodedFrames() const { return decoded_frames_; }
-
-private:
-    void onFrameReceived(std::unique_ptr<H264Frame> frame) {
-        if (!frame || frame->data.empty()) {
-            return;
-        }
-
-        // Check for SPS/PPS in the stream if not already found
-        if (!has_sps_) {
-            const auto& data = frame->data;
-            for (size_t i = 0; i + 3 < data.size(); ) {
-                size_t start_code_len = 0;
-                if (i + 4 < data.size() && data[i] == 0x00 && data[i+1] == 0x00 && data[i+2] == 0x00 && data[i+3] == 0x01) {
-                    start_code_len = 4;
-                } else if (data[i] == 0x00 && data[i+1] == 0x00 && data[i+2] == 0x01) {
-                    start_code_len = 3;
-                }
-
-                if (start_code_len > 0) {
-                    size_t nalu_header_pos = i + start_code_len;
-                    if (nalu_header_pos < data.size()) {
-                        uint8_t nalu_type = data[nalu_header_pos] & 0x1F;
-                        if (nalu_type == 7) { // SPS
-                            std::cout << "✅ SPS frame received (NALU type 7), decoder is ready to work!" << std::endl;
-                            has_sps_ = true;
-                            break; 
-                        }
-                    }
-                    i += start_code_len;
-                } else {
-                    i++;
-                }
-            }
-        }
-
-        {
-            std::lock_guard<std::mutex> lock(frame_mutex_);
-            if (frame_queue_.size() >= MAX_QUEUE_SIZE) {
-                frame_queue_.pop(); // Remove the oldest frame if the queue is full
-            }
-            frame_queue_.push(std::move(frame));
-        }
-        
-        frame_condition_.notify_one();
-    }
-
-    void decoderLoop() {
-        std::cout << "Starting decoding loop with buffering (queue size: " << MAX_QUEUE_SIZE << ")..." << std::endl;
-        
-        // Wait for the first SPS frame
-        while (running_ && !has_sps_) {
-            std::cout << "⏳ Waiting for SPS frame..." << std::endl;
-            std::this_thread::sleep_for(std::chrono::seconds(1));
-        }
-
-        while (running_) {
-            std::unique_ptr<H264Frame> frame_to_decode;
-            
-            // Wait for a new frame
-            {
-                std::unique_lock<std::mutex> lock(frame_mutex_);
-                frame_condition_.wait(lock, [this] { return !frame_queue_.empty() || !running_; });
-                
-                if (!running_ && frame_queue_.empty()) {
-                    break;
-                }
-                
-                // Take a frame from the queue
-                frame_to_decode = std::move(frame_queue_.front());
-                frame_queue_.pop();
-            }
-            
-            if (!frame_to_decode) {
-                continue;
-            }
-            
-            try {
-                if (decoder_->decodeData(frame_to_decode->data.data(), frame_to_decode->data.size())) {
-                    decoded_frames_++;
-                    
-                    if (decoded_frames_ == 1) {
-                         std::cout << "✅ First frame successfully decoded and displayed!" << std::endl;
-                    } else if (decoded_frames_ % 100 == 0) {
-                        std::cout << "✅ Decoded " << decoded_frames_ << " frames" << std::endl;
-                    }
-                } else {
-                    std::cout << "❌ Error decoding frame (" << frame_to_decode->data.size() << " bytes)" << std::endl;
-                }
-                
-            } catch (const std::exception& e) {
-                std::cerr << "Critical error in decoding loop: " << e.what() << std::endl;
-            }
-        }
-        
-        std::cout << "Decoding loop finished" << std::endl;
+        out.push_back(static_cast<uint8_t>(value));
     }
-    
-    // Configuration
-    std::string device_path_;
-    std::string local_ip_;
-    uint16_t local_port_;
-    
-    // Components
-    std::unique_ptr<V4L2Decoder> decoder_;
-    std::unique_ptr<UvgRTPReceiver> rtp_receiver_;
-    
-    // Threads
-    std::thread decoder_thread_;
-    std::atomic<bool> running_;
-    
-    // Frame queue with limited size for smoothing
-    static constexpr size_t MAX_QUEUE_SIZE = 5;
-    std::queue<std::unique_ptr<H264Frame>> frame_queue_;
-    std::mutex frame_mutex_;
-    std::condition_variable frame_condition_;
-    
-    // Statistics
-    std::atomic<int> decoded_frames_;
-    std::atomic<bool> has_sps_;
-};
+    return true;
+}
 
 void printUsage(const char* program_name) {
     std::cout << "RTP Player - real-time H.264 RTP stream reception and decoding\n\n";
@@ -248,16 +40,75 @@ void printUsage(const char* program_name) {
     std::cout << "  -d, --device <device>   V4L2 device (default: /dev/video10)\n";
     std::cout << "  -i, --ip <ip>          Local IP to listen on (default: 0.0.0.0)\n";
     std::cout << "  -p, --port <port>      Local port for RTP (default: 5600)\n";
+    std::cout << "  -f, --feedback <ip:port> Send TWCC feedback to the sender's RTCP address (REMB only without --native)\n";
+    std::cout << "      --twcc-ext-id <id>  Transport-wide sequence number extension id (default: 5)\n";
+    std::cout << "      --remb             Also send REMB with a receiver-side bitrate estimate\n";
+    std::cout << "  -k, --srtp-key <hex>   SRTP master key + salt (30 bytes, 60 hex digits)\n";
+    std::cout << "  -u, --rtsp <url>       Open an RTSP session (rtsp://[user:pass@]host[:port]/path)\n";
+    std::cout << "      --rtsp-tcp         Force interleaved RTP over the RTSP connection\n";
+    std::cout << "      --native           Receive with the built-in socket receiver instead of uvgRTP\n";
+    std::cout << "      --xdp <if>[:queue] Native receiver with AF_XDP on the given interface queue\n";
+    std::cout << "      --xdp-object <path> Compiled XDP steering program (default: installed copy)\n";
+    std::cout << "      --no-gro           Disable UDP GRO coalescing in the native receiver\n";
+    std::cout << "      --async-flip       Tearing page flips: show each frame immediately, without vsync\n";
+    std::cout << "      --wayland          Show the stream in a Wayland window instead of on a DRM output\n";
+    std::cout << "      --writeback        Capture scanout through a DRM writeback connector (checksums, latency)\n";
+    std::cout << "      --writeback-dir <dir> Write the per-capture CSV log to <dir> (implies --writeback)\n";
+    std::cout << "      --writeback-dump   Also store every capture as raw XRGB8888 in the writeback dir\n";
+    std::cout << "      --mirror           Show the stream on every connected display\n";
+    std::cout << "      --wall <CxR>       Split the frame across CxR displays (video wall)\n";
+    std::cout << "      --rotate <deg>     Rotate the picture clockwise by 0, 90, 180 or 270 degrees\n";
+    std::cout << "      --reflect-x        Mirror the picture horizontally\n";
+    std::cout << "      --reflect-y        Mirror the picture vertically\n";
+    std::cout << "      --scale <fit|stretch> How frames are scaled to each display (default: fit)\n";
+    std::cout << "      --frame-server <path> Share decoded frames with local processes on a Unix socket\n";
+    std::cout << "      --frame-server-hold <n> Frames each subscriber may hold at once (default: 1)\n";
+    std::cout << "      --queue <n>        Frames buffered ahead of the decoder (default: 5)\n";
+    std::cout << "      --queue-policy <drop-oldest|drop-newest|block> What a full decode queue does (default: drop-oldest)\n";
+    std::cout << "      --reactor          Decode and display from one event-loop thread\n";
+    std::cout << "      --stream-timeout <ms> Treat the stream as lost after this long without frames (default: never)\n";
+    std::cout << "      --blank-on-loss    Blank the screen while the stream is lost instead of holding the last frame\n";
+    std::cout << "      --idle <ms>        Low-power idle after this long without frames (default: never)\n";
+    std::cout << "      --idle-release     Free the decoder buffers while idle (reallocated when frames return)\n";
+    std::cout << "      --watchdog         Detect decoder/display stalls and recover from them\n";
+    std::cout << "      --watchdog-log <path> Append stall snapshots to a file (implies --watchdog)\n";
+    std::cout << "      --flight-recorder <path> Keep recent per-frame events; append them to a file on errors, stalls,\n";
+    std::cout << "                         stream loss and latency spikes (\"-\": stderr)\n";
+    std::cout << "      --latency-spike <ms> Receive-to-decoded latency that triggers a flight recorder dump (default: 100)\n";
+    std::cout << "      --osd              Show link/decoder telemetry on an overlay plane\n";
+    std::cout << "      --osd-interval <ms> Minimum time between OSD updates (default: 250)\n";
     std::cout << "  -h, --help             Show this help\n\n";
     std::cout << "Examples:\n";
     std::cout << "  " << program_name << " -p 5600                    # Listen on port 5600\n";
     std::cout << "  " << program_name << " -i 192.168.1.100 -p 8080  # Listen on a specific IP and port\n";
+    std::cout << "  " << program_name << " -f 192.168.1.10:5601 --remb # Report bandwidth to the sender\n";
+    std::cout << "  " << program_name << " -u rtsp://192.168.1.10/stream # Pull a stream from a camera\n";
+    std::cout << "  " << program_name << " --xdp eth0:0              # Kernel-bypass receive on eth0 queue 0\n";
 }
 
 int main(int argc, char* argv[]) {
     std::string device_path = "/dev/video10";
     std::string local_ip = "0.0.0.0";
     uint16_t local_port = 5600;
+    TransportFeedback::Config feedback_config;
+    std::vector<uint8_t> srtp_key;
+    RtspClient::Config rtsp_config;
+    bool native_receiver = false;
+    NativeRTPReceiver::Config native_config;
+    OsdConfig osd_config;
+    DisplayConfig display_config;
+    FrameServer::Config frame_server_config;
+    frame_server_config.socket_path.clear();
+    pipeline::StageConfig decode_stage = RtpSession::Config{}.decode_stage;
+    bool use_reactor = false;
+    uint32_t stream_timeout_ms = 0;
+    bool blank_on_loss = false;
+    uint32_t idle_timeout_ms = 0;
+    bool idle_release_buffers = false;
+    bool watchdog_enabled = false;
+    Watchdog::Config watchdog_config;
+    bool flight_recorder_enabled = false;
+    FlightRecorder::Config flight_recorder_config;
     
     // Parse command line arguments
     for (int i = 1; i < argc; i++) {
@@ -291,6 +142,264 @@ int main(int argc, char* argv[]) {
                 return 1;
             }
         }
+        else if ((arg == "-f") || (arg == "--feedback")) {
+            if (i + 1 < argc) {
+                std::string address = argv[++i];
+                size_t colon = address.rfind(':');
+                if (colon == std::string::npos) {
+                    std::cerr << "Error: feedback address must be <ip:port>\n";
+                    return 1;
+                }
+                feedback_config.remote_ip = address.substr(0, colon);
+                feedback_config.remote_port = static_cast<uint16_t>(std::stoi(address.substr(colon + 1)));
+            } else {
+                std::cerr << "Error: option " << arg << " requires a value\n";
+                return 1;
+            }
+        }
+        else if (arg == "--twcc-ext-id") {
+            if (i + 1 < argc) {
+                feedback_config.extension_id = static_cast<uint8_t>(std::stoi(argv[++i]));
+            } else {
+                std::cerr << "Error: option " << arg << " requires a value\n";
+                return 1;
+            }
+        }
+        else if (arg == "--remb") {
+            feedback_config.enable_remb = true;
+        }
+        else if ((arg == "-u") || (arg == "--rtsp")) {
+            if (i + 1 < argc) {
+                rtsp_config.url = argv[++i];
+            } else {
+                std::cerr << "Error: option " << arg << " requires a value\n";
+                return 1;
+            }
+        }
+        else if (arg == "--rtsp-tcp") {
+            rtsp_config.transport = RtspClient::Transport::TCP;
+        }
+        else if (arg == "--native") {
+            native_receiver = true;
+        }
+        else if (arg == "--xdp") {
+            if (i + 1 < argc) {
+                std::string target = argv[++i];
+                size_t colon = target.rfind(':');
+                native_config.xdp_interface = target.substr(0, colon);
+                if (colon != std::string::npos) {
+                    native_config.xdp_queue = static_cast<uint32_t>(std::stoul(target.substr(colon + 1)));
+                }
+                native_config.backend = NativeRTPReceiver::Backend::XDP;
+                native_receiver = true;
+            } else {
+                std::cerr << "Error: option " << arg << " requires a value\n";
+                return 1;
+            }
+        }
+        else if (arg == "--async-flip") {
+            display_config.present_mode = PresentMode::ASYNC;
+        }
+        else if (arg == "--wayland") {
+            display_config.output = DisplayOutput::WAYLAND;
+        }
+        else if (arg == "--writeback") {
+            display_config.writeback.enabled = true;
+        }
+        else if (arg == "--writeback-dir") {
+            if (i + 1 < argc) {
+                display_config.writeback.output_dir = argv[++i];
+                display_config.writeback.enabled = true;
+            } else {
+                std::cerr << "Error: option " << arg << " requires a value\n";
+                return 1;
+            }
+        }
+        else if (arg == "--writeback-dump") {
+            display_config.writeback.dump_frames = true;
+        }
+        else if (arg == "--mirror") {
+            display_config.mirror_outputs = true;
+        }
+        else if (arg == "--wall") {
+            uint32_t columns = 0;
+            uint32_t rows = 0;
+            if (i + 1 < argc && std::sscanf(argv[i + 1], "%ux%u", &columns, &rows) == 2 &&
+                columns > 0 && rows > 0) {
+                display_config.wall_columns = columns;
+                display_config.wall_rows = rows;
+                ++i;
+            } else {
+                std::cerr << "Error: option " << arg << " requires <columns>x<rows>\n";
+                return 1;
+            }
+        }
+        else if (arg == "--rotate") {
+            if (i + 1 < argc) {
+                uint32_t degrees = static_cast<uint32_t>(std::stoul(argv[++i]));
+                if (degrees % 90 != 0 || degrees >= 360) {
+                    std::cerr << "Error: rotation must be 0, 90, 180 or 270\n";
+                    return 1;
+                }
+                display_config.rotation = degrees;
+            } else {
+                std::cerr << "Error: option " << arg << " requires a value\n";
+                return 1;
+            }
+        }
+        else if (arg == "--reflect-x") {
+            display_config.reflect_x = true;
+        }
+        else if (arg == "--reflect-y") {
+            display_config.reflect_y = true;
+        }
+        else if (arg == "--scale") {
+            if (i + 1 < argc) {
+                std::string mode = argv[++i];
+                if (mode == "fit") {
+                    display_config.scale_mode = ScaleMode::FIT;
+                } else if (mode == "stretch") {
+                    display_config.scale_mode = ScaleMode::STRETCH;
+                } else {
+                    std::cerr << "Error: scale mode must be fit or stretch\n";
+                    return 1;
+                }
+            } else {
+                std::cerr << "Error: option " << arg << " requires a value\n";
+                return 1;
+            }
+        }
+        else if (arg == "--frame-server") {
+            if (i + 1 < argc) {
+                frame_server_config.socket_path = argv[++i];
+            } else {
+                std::cerr << "Error: option " << arg << " requires a value\n";
+                return 1;
+            }
+        }
+        else if (arg == "--frame-server-hold") {
+            if (i + 1 < argc) {
+                frame_server_config.max_held_frames = static_cast<uint32_t>(std::stoul(argv[++i]));
+            } else {
+                std::cerr << "Error: option " << arg << " requires a value\n";
+                return 1;
+            }
+        }
+        else if (arg == "--queue") {
+            if (i + 1 < argc) {
+                decode_stage.capacity = std::max<size_t>(std::stoul(argv[++i]), 1);
+            } else {
+                std::cerr << "Error: option " << arg << " requires a value\n";
+                return 1;
+            }
+        }
+        else if (arg == "--queue-policy") {
+            if (i + 1 < argc) {
+                std::string policy = argv[++i];
+                if (policy == "drop-oldest") {
+                    decode_stage.overflow = pipeline::Overflow::DROP_OLDEST;
+                } else if (policy == "drop-newest") {
+                    decode_stage.overflow = pipeline::Overflow::DROP_NEWEST;
+                } else if (policy == "block") {
+                    decode_stage.overflow = pipeline::Overflow::BLOCK;
+                } else {
+                    std::cerr << "Error: queue policy must be drop-oldest, drop-newest or block\n";
+                    return 1;
+                }
+            } else {
+                std::cerr << "Error: option " << arg << " requires a value\n";
+                return 1;
+            }
+        }
+        else if (arg == "--reactor") {
+            use_reactor = true;
+        }
+        else if (arg == "--stream-timeout") {
+            if (i + 1 < argc) {
+                stream_timeout_ms = static_cast<uint32_t>(std::stoul(argv[++i]));
+            } else {
+                std::cerr << "Error: option " << arg << " requires a value\n";
+                return 1;
+            }
+        }
+        else if (arg == "--blank-on-loss") {
+            blank_on_loss = true;
+        }
+        else if (arg == "--idle") {
+            if (i + 1 < argc) {
+                idle_timeout_ms = static_cast<uint32_t>(std::stoul(argv[++i]));
+            } else {
+                std::cerr << "Error: option " << arg << " requires a value\n";
+                return 1;
+            }
+        }
+        else if (arg == "--idle-release") {
+            idle_release_buffers = true;
+        }
+        else if (arg == "--watchdog") {
+            watchdog_enabled = true;
+        }
+        else if (arg == "--watchdog-log") {
+            if (i + 1 < argc) {
+                watchdog_config.snapshot_path = argv[++i];
+                watchdog_enabled = true;
+            } else {
+                std::cerr << "Error: option " << arg << " requires a value\n";
+                return 1;
+            }
+        }
+        else if (arg == "--flight-recorder") {
+            if (i + 1 < argc) {
+                std::string path = argv[++i];
+                flight_recorder_config.dump_path = path == "-" ? "" : path;
+                flight_recorder_enabled = true;
+            } else {
+                std::cerr << "Error: option " << arg << " requires a value\n";
+                return 1;
+            }
+        }
+        else if (arg == "--latency-spike") {
+            if (i + 1 < argc) {
+                flight_recorder_config.latency_spike_ms = static_cast<uint32_t>(std::stoul(argv[++i]));
+            } else {
+                std::cerr << "Error: option " << arg << " requires a value\n";
+                return 1;
+            }
+        }
+        else if (arg == "--osd") {
+            osd_config.enabled = true;
+        }
+        else if (arg == "--osd-interval") {
+            if (i + 1 < argc) {
+                osd_config.update_interval_ms = static_cast<uint32_t>(std::stoul(argv[++i]));
+                osd_config.enabled = true;
+            } else {
+                std::cerr << "Error: option " << arg << " requires a value\n";
+                return 1;
+            }
+        }
+        else if (arg == "--no-gro") {
+            native_config.enable_gro = false;
+        }
+        else if (arg == "--xdp-object") {
+            if (i + 1 < argc) {
+                native_config.xdp_object_path = argv[++i];
+            } else {
+                std::cerr << "Error: option " << arg << " requires a value\n";
+                return 1;
+            }
+        }
+        else if ((arg == "-k") || (arg == "--srtp-key")) {
+            if (i + 1 < argc) {
+                if (!parseHexKey(argv[++i], srtp_key)) {
+                    std::cerr << "Error: SRTP key must be a hex string\n";
+                    return 1;
+                }
+            } else {
+                std::cerr << "Error: option " << arg << " requires a value\n";
+                return 1;
+            }
+        }
         else {
             std::cerr << "Unknown option: " << arg << "\n";
             printUsage(argv[0]);
@@ -298,22 +407,126 @@ int main(int argc, char* argv[]) {
         }
     }
     
+    if (native_receiver && !srtp_key.empty()) {
+        std::cerr << "Error: SRTP is only supported with the uvgRTP receiver\n";
+        return 1;
+    }
+    
     std::cout << "\n=== RTP Player for H.264 stream ===" << std::endl;
     std::cout << "V4L2 device: " << device_path << std::endl;
     std::cout << "Listening for RTP on: " << local_ip << ":" << local_port << std::endl;
+    if (!rtsp_config.url.empty()) {
+        std::cout << "RTSP source: " << rtsp_config.url << std::endl;
+    }
+    if (feedback_config.remote_port != 0) {
+        std::cout << "Transport feedback to: " << feedback_config.remote_ip << ":" << feedback_config.remote_port << std::endl;
+    }
     std::cout << "=====================================" << std::endl << std::endl;
     
     try {
-        RTPPlayer player(device_path, local_ip, local_port);
-        
-        if (!player.initialize()) {
+        RtpSession::Config config;
+        config.device_path = device_path;
+        config.local_ip = local_ip;
+        config.local_port = local_port;
+        config.feedback = feedback_config;
+        config.srtp_key = srtp_key;
+        config.rtsp = rtsp_config;
+        config.native_receiver = native_receiver;
+        config.native = native_config;
+        config.osd = osd_config;
+        config.display = display_config;
+        config.frame_server = frame_server_config;
+        config.decode_stage = decode_stage;
+        config.use_reactor = use_reactor;
+        config.stream_timeout_ms = stream_timeout_ms;
+        config.blank_on_loss = blank_on_loss;
+        config.idle_timeout_ms = idle_timeout_ms;
+        config.idle_release_buffers = idle_release_buffers;
+        config.watchdog_enabled = watchdog_enabled;
+        config.watchdog = watchdog_config;
+        config.flight_recorder_enabled = flight_recorder_enabled;
+        config.flight_recorder = flight_recorder_config;
+
+        RtpSession session(config);
+        if (!session.initialize()) {
             std::cerr << "RTP Player initialization failed" << std::endl;
             return 1;
         }
-        
-        player.start();
-        
-        std::cout << "Decoded frames: " << player.getDecodedFrames() << std::endl;
+
+        if (!session.start()) {
+            return 1;
+        }
+
+        (void)session.getThreadMetrics();      // Baseline for the per-thread rates below
+
+        std::cout << "Press Enter to stop..." << std::endl;
+        std::cin.get();
+        // Sampled before stop() joins the threads; rates cover the whole run
+        auto threads = session.getThreadMetrics();
+        session.stop();
+
+        std::cout << "RTP Player stopped" << std::endl;
+        auto stats = session.getStatistics();
+        std::cout << "Decoded frames: " << stats.decoded_frames << std::endl;
+        for (const auto& stage : stats.stages) {
+            std::printf("  %-8s processed %llu, dropped %llu, max depth %zu, wait %.1f us, process %.1f us (max %llu us)\n",
+                        stage.name.c_str(), static_cast<unsigned long long>(stage.processed),
+                        static_cast<unsigned long long>(stage.dropped), stage.max_depth, stage.avg_wait_us,
+                        stage.avg_process_us, static_cast<unsigned long long>(stage.max_process_us));
+        }
+        for (size_t step = 0; step < V4L2Decoder::RECOVERY_STEPS; ++step) {
+            uint64_t attempts = stats.recovery.attempts[step];
+            if (attempts > 0) {
+                std::printf("  recovery %-16s %llu/%llu recovered, avg %.1f ms (max %.1f ms)\n",
+                            V4L2Decoder::recoveryStepName(static_cast<V4L2Decoder::RecoveryStep>(step)),
+                            static_cast<unsigned long long>(stats.recovery.recovered[step]),
+                            static_cast<unsigned long long>(attempts),
+                            stats.recovery.total_us[step] / 1000.0 / attempts, stats.recovery.max_us[step] / 1000.0);
+            }
+        }
+        if (stats.recovery.failures > 0) {
+            std::printf("  recovery failed %llu time(s)\n", static_cast<unsigned long long>(stats.recovery.failures));
+        }
+        if (stats.stream_losses > 0) {
+            std::printf("  stream lost %llu time(s), %llu keyframe request(s), last reacquired in %lld ms\n",
+                        static_cast<unsigned long long>(stats.stream_losses),
+                        static_cast<unsigned long long>(stats.keyframe_requests),
+                        static_cast<long long>(stats.last_reacquisition_ms));
+        }
+        if (stats.idle_entries > 0) {
+            std::printf("  idle %llu time(s)\n", static_cast<unsigned long long>(stats.idle_entries));
+        }
+        std::printf("  %-15s %7s %-8s %6s %10s %9s %9s %11s\n", "thread", "tid", "policy", "cpu %", "cpu ms",
+                    "vol csw", "invol csw", "run delay");
+        for (const auto& thread : threads) {
+            char policy[16];
+            std::snprintf(policy, sizeof(policy), "%s %d",
+                          thread.policy == SCHED_FIFO ? "FIFO" : thread.policy == SCHED_RR ? "RR" : "OTHER",
+                          thread.priority);
+            std::printf("  %-15s %7d %-8s %6.1f %10.1f %9llu %9llu %8.1f us\n", thread.name.c_str(),
+                        static_cast<int>(thread.tid), policy, thread.cpu_percent, thread.cpu_time_us / 1000.0,
+                        static_cast<unsigned long long>(thread.voluntary_switches),
+                        static_cast<unsigned long long>(thread.involuntary_switches), thread.avg_run_delay_us);
+        }
+        if (!stats.scheduling.max_run_delay_thread.empty() || !stats.scheduling.max_switches_thread.empty()) {
+            std::printf("  worst interval: run delay %.1f us (%s), %llu involuntary switch(es) (%s)\n",
+                        stats.scheduling.max_run_delay_us, stats.scheduling.max_run_delay_thread.c_str(),
+                        static_cast<unsigned long long>(stats.scheduling.max_involuntary_switches),
+                        stats.scheduling.max_switches_thread.c_str());
+        }
+        if (watchdog_enabled) {
+            std::printf("  watchdog: %llu decoder stall(s) (%llu escalated), %llu display stall(s)\n",
+                        static_cast<unsigned long long>(stats.watchdog.decoder_stalls),
+                        static_cast<unsigned long long>(stats.watchdog.escalations),
+                        static_cast<unsigned long long>(stats.watchdog.display_stalls));
+        }
+        if (flight_recorder_enabled) {
+            std::printf("  flight recorder: %llu record(s), %llu anomaly trigger(s), %llu dump(s), %llu suppressed\n",
+                        static_cast<unsigned long long>(stats.flight_recorder.records),
+                        static_cast<unsigned long long>(stats.flight_recorder.triggers),
+                        static_cast<unsigned long long>(stats.flight_recorder.dumps),
+                        static_cast<unsigned long long>(stats.flight_recorder.suppressed));
+        }
         
     } catch (const std::exception& e) {
         std::cerr << "Exception: " << e.what() << std::endl;
@@ -0,0 +1,90 @@
+// SPDX-License-Identifier: (GPL-2.0 OR BSD-2-Clause)
+/**
+ * @file xdp_rtp_steer.bpf.c
+ * @brief XDP program redirecting the RTP UDP port into an AF_XDP socket
+ *
+ * Packets to the configured UDP port are redirected to the AF_XDP socket
+ * registered for the receiving queue. Everything else, and RTP arriving on
+ * a queue without a socket, continues through the kernel stack.
+ */
+
+#include <linux/bpf.h>
+#include <linux/if_ether.h>
+#include <linux/ip.h>
+#include <linux/ipv6.h>
+#include <linux/in.h>
+#include <linux/udp.h>
+#include <bpf/bpf_helpers.h>
+#include <bpf/bpf_endian.h>
+
+struct {
+    __uint(type, BPF_MAP_TYPE_XSKMAP);
+    __uint(max_entries, 64);
+    __type(key, __u32);
+    __type(value, __u32);
+} xsks_map SEC(".maps");
+
+// Key 0: destination UDP port in host byte order
+struct {
+    __uint(type, BPF_MAP_TYPE_ARRAY);
+    __uint(max_entries, 1);
+    __type(key, __u32);
+    __type(value, __u32);
+} config_map SEC(".maps");
+
+struct vlan_hdr {
+    __be16 tci;
+    __be16 encapsulated_proto;
+};
+
+SEC("xdp")
+int xdp_rtp_steer(struct xdp_md* ctx)
+{
+    void* data = (void*)(long)ctx->data;
+    void* data_end = (void*)(long)ctx->data_end;
+
+    struct ethhdr* eth = data;
+    if ((void*)(eth + 1) > data_end)
+        return XDP_PASS;
+
+    __u16 proto = eth->h_proto;
+    void* l3 = eth + 1;
+
+    if (proto == bpf_htons(ETH_P_8021Q)) {
+        struct vlan_hdr* vlan = l3;
+        if ((void*)(vlan + 1) > data_end)
+            return XDP_PASS;
+        proto = vlan->encapsulated_proto;
+        l3 = vlan + 1;
+    }
+
+    struct udphdr* udp;
+    if (proto == bpf_htons(ETH_P_IP)) {
+        struct iphdr* ip = l3;
+        if ((void*)(ip + 1) > data_end || ip->protocol != IPPROTO_UDP)
+            return XDP_PASS;
+        // Fragments carry no UDP header after the first one
+        if (ip->frag_off & bpf_htons(0x3FFF))
+            return XDP_PASS;
+        udp = (void*)ip + ip->ihl * 4;
+    } else if (proto == bpf_htons(ETH_P_IPV6)) {
+        struct ipv6hdr* ip6 = l3;
+        if ((void*)(ip6 + 1) > data_end || ip6->nexthdr != IPPROTO_UDP)
+            return XDP_PASS;
+        udp = (void*)(ip6 + 1);
+    } else {
+        return XDP_PASS;
+    }
+
+    if ((void*)(udp + 1) > data_end)
+        return XDP_PASS;
+
+    __u32 key = 0;
+    __u32* port = bpf_map_lookup_elem(&config_map, &key);
+    if (!port || udp->dest != bpf_htons((__u16)*port))
+        return XDP_PASS;
+
+    return bpf_redirect_map(&xsks_map, ctx->rx_queue_index, XDP_PASS);
+}
+
+char _license[] SEC("license") = "Dual BSD/GPL";
@@ -0,0 +1,315 @@
+/**
+ * @file af_xdp_socket.cpp
+ * @brief AF_XDP receive socket based on libxdp / libbpf
+ */
+
+#include "af_xdp_socket.h"
+#include <iostream>
+#include <cstring>
+#include <cerrno>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <net/if.h>
+#include <linux/if_link.h>
+#include <linux/if_xdp.h>
+#include <bpf/libbpf.h>
+#include <bpf/bpf.h>
+#include <xdp/xsk.h>
+
+namespace {
+
+constexpr uint32_t RX_BATCH_SIZE = 64;
+constexpr uint16_t ETH_TYPE_IPV4 = 0x0800;
+constexpr uint16_t ETH_TYPE_IPV6 = 0x86DD;
+constexpr uint16_t ETH_TYPE_VLAN = 0x8100;
+constexpr uint8_t IP_PROTO_UDP = 17;
+
+uint16_t read16(const uint8_t* p) {
+    return static_cast<uint16_t>((p[0] << 8) | p[1]);
+}
+
+// Locate the UDP payload of an Ethernet frame addressed to port
+bool udpPayload(const uint8_t* frame, size_t length, uint16_t port, const uint8_t*& payload, size_t& payload_size) {
+    size_t offset = 14;
+    if (length < offset) {
+        return false;
+    }
+    uint16_t eth_type = read16(frame + 12);
+    if (eth_type == ETH_TYPE_VLAN) {
+        if (length < offset + 4) {
+            return false;
+        }
+        eth_type = read16(frame + 16);
+        offset += 4;
+    }
+
+    if (eth_type == ETH_TYPE_IPV4) {
+        if (length < offset + 20 || frame[offset + 9] != IP_PROTO_UDP) {
+            return false;
+        }
+        offset += (frame[offset] & 0x0F) * 4;
+    } else if (eth_type == ETH_TYPE_IPV6) {
+        if (length < offset + 40 || frame[offset + 6] != IP_PROTO_UDP) {
+            return false;
+        }
+        offset += 40;
+    } else {
+        return false;
+    }
+
+    if (length < offset + 8 || read16(frame + offset + 2) != port) {
+        return false;
+    }
+    size_t udp_length = read16(frame + offset + 4);
+    if (udp_length < 8 || offset + udp_length > length) {
+        return false;
+    }
+
+    payload = frame + offset + 8;
+    payload_size = udp_length - 8;
+    return true;
+}
+
+} // namespace
+
+class AfXdpSocket::Impl {
+public:
+    Config config;
+
+    int ifindex = 0;
+    uint32_t xdp_flags = 0;
+    bool program_attached = false;
+    bpf_object* object = nullptr;
+
+    void* umem_area = nullptr;
+    size_t umem_size = 0;
+    xsk_umem* umem = nullptr;
+    xsk_ring_prod fill_ring = {};
+    xsk_ring_cons completion_ring = {};
+    xsk_ring_cons rx_ring = {};
+    xsk_socket* xsk = nullptr;
+
+    bool loadProgram() {
+        object = bpf_object__open_file(config.object_path.c_str(), nullptr);
+        if (!object) {
+            std::cerr << "AF_XDP: failed to open XDP object " << config.object_path << ": " << strerror(errno) << std::endl;
+            return false;
+        }
+        if (bpf_object__load(object) != 0) {
+            std::cerr << "AF_XDP: failed to load XDP object: " << strerror(errno) << std::endl;
+            return false;
+        }
+
+        bpf_program* program = bpf_object__find_program_by_name(object, "xdp_rtp_steer");
+        if (!program) {
+            std::cerr << "AF_XDP: program xdp_rtp_steer not found" << std::endl;
+            return false;
+        }
+
+        int config_fd = bpf_object__find_map_fd_by_name(object, "config_map");
+        uint32_t key = 0;
+        uint32_t port = config.udp_port;
+        if (config_fd < 0 || bpf_map_update_elem(config_fd, &key, &port, 0) != 0) {
+            std::cerr << "AF_XDP: failed to configure UDP port" << std::endl;
+            return false;
+        }
+
+        // Native (driver) mode first, generic mode for drivers without XDP support
+        int program_fd = bpf_program__fd(program);
+        for (uint32_t mode : {static_cast<uint32_t>(XDP_FLAGS_DRV_MODE), static_cast<uint32_t>(XDP_FLAGS_SKB_MODE)}) {
+            xdp_flags = mode | XDP_FLAGS_UPDATE_IF_NOEXIST;
+            if (bpf_xdp_attach(ifindex, program_fd, xdp_flags, nullptr) == 0) {
+                program_attached = true;
+                std::cout << "AF_XDP: program attached to " << config.interface << " in "
+                          << (mode == XDP_FLAGS_DRV_MODE ? "native" : "generic") << " mode" << std::endl;
+                return true;
+            }
+        }
+        std::cerr << "AF_XDP: failed to attach program to " << config.interface << ": " << strerror(errno) << std::endl;
+        return false;
+    }
+
+    bool createUmem() {
+        umem_size = static_cast<size_t>(config.frame_count) * config.frame_size;
+        umem_area = mmap(nullptr, umem_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_POPULATE, -1, 0);
+        if (umem_area == MAP_FAILED) {
+            umem_area = nullptr;
+            std::cerr << "AF_XDP: UMEM allocation failed: " << strerror(errno) << std::endl;
+            return false;
+        }
+
+        xsk_umem_config umem_config = {};
+        umem_config.fill_size = config.frame_count;
+        umem_config.comp_size = XSK_RING_CONS__DEFAULT_NUM_DESCS;
+        umem_config.frame_size = config.frame_size;
+        umem_config.frame_headroom = 0;
+        umem_config.flags = 0;
+
+        int ret = xsk_umem__create(&umem, umem_area, umem_size, &fill_ring, &completion_ring, &umem_config);
+        if (ret != 0) {
+            std::cerr << "AF_XDP: xsk_umem__create failed: " << strerror(-ret) << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    bool createSocket(bool zero_copy) {
+        xsk_socket_config socket_config = {};
+        socket_config.rx_size = config.frame_count / 2;
+        socket_config.tx_size = 0;
+        socket_config.libxdp_flags = XSK_LIBXDP_FLAGS__INHIBIT_PROG_LOAD;
+        socket_config.xdp_flags = xdp_flags;
+        socket_config.bind_flags = XDP_USE_NEED_WAKEUP | (zero_copy ? XDP_ZEROCOPY : XDP_COPY);
+
+        int ret = xsk_socket__create(&xsk, config.interface.c_str(), config.queue_id, umem,
+                                     &rx_ring, nullptr, &socket_config);
+        if (ret != 0) {
+            xsk = nullptr;
+            if (zero_copy) {
+                std::cout << "AF_XDP: zero-copy bind failed (" << strerror(-ret) << "), using copy mode" << std::endl;
+            } else {
+                std::cerr << "AF_XDP: xsk_socket__create failed: " << strerror(-ret) << std::endl;
+            }
+            return false;
+        }
+        std::cout << "AF_XDP: socket bound to " << config.interface << " queue " << config.queue_id
+                  << (zero_copy ? " (zero-copy)" : " (copy mode)") << std::endl;
+        return true;
+    }
+
+    bool fillAll() {
+        uint32_t index = 0;
+        uint32_t count = config.frame_count;
+        if (xsk_ring_prod__reserve(&fill_ring, count, &index) != count) {
+            std::cerr << "AF_XDP: failed to populate fill ring" << std::endl;
+            return false;
+        }
+        for (uint32_t i = 0; i < count; ++i) {
+            *xsk_ring_prod__fill_addr(&fill_ring, index + i) = static_cast<uint64_t>(i) * config.frame_size;
+        }
+        xsk_ring_prod__submit(&fill_ring, count);
+        return true;
+    }
+
+    bool open() {
+        ifindex = static_cast<int>(if_nametoindex(config.interface.c_str()));
+        if (ifindex == 0) {
+            std::cerr << "AF_XDP: unknown interface " << config.interface << std::endl;
+            return false;
+        }
+
+        if (!loadProgram() || !createUmem()) {
+            close();
+            return false;
+        }
+        if (!(config.zero_copy && createSocket(true)) && !createSocket(false)) {
+            close();
+            return false;
+        }
+
+        int xsks_map_fd = bpf_object__find_map_fd_by_name(object, "xsks_map");
+        if (xsks_map_fd < 0 || xsk_socket__update_xskmap(xsk, xsks_map_fd) != 0) {
+            std::cerr << "AF_XDP: failed to register socket in xsks_map" << std::endl;
+            close();
+            return false;
+        }
+
+        if (!fillAll()) {
+            close();
+            return false;
+        }
+        return true;
+    }
+
+    size_t receive(const PacketHandler& handler) {
+        size_t total = 0;
+        while (true) {
+            uint32_t rx_index = 0;
+            uint32_t received = xsk_ring_cons__peek(&rx_ring, RX_BATCH_SIZE, &rx_index);
+            if (received == 0) {
+                if (xsk_ring_prod__needs_wakeup(&fill_ring)) {
+                    recvfrom(xsk_socket__fd(xsk), nullptr, 0, MSG_DONTWAIT, nullptr, nullptr);
+                }
+                return total;
+            }
+
+            // The frames being handled go straight back to the fill ring afterwards
+            uint32_t fill_index = 0;
+            while (xsk_ring_prod__reserve(&fill_ring, received, &fill_index) != received) {
+                if (xsk_ring_prod__needs_wakeup(&fill_ring)) {
+                    recvfrom(xsk_socket__fd(xsk), nullptr, 0, MSG_DONTWAIT, nullptr, nullptr);
+                }
+            }
+
+            for (uint32_t i = 0; i < received; ++i) {
+                const xdp_desc* desc = xsk_ring_cons__rx_desc(&rx_ring, rx_index + i);
+                const uint8_t* frame = static_cast<const uint8_t*>(xsk_umem__get_data(umem_area, desc->addr));
+
+                const uint8_t* payload = nullptr;
+                size_t payload_size = 0;
+                if (udpPayload(frame, desc->len, config.udp_port, payload, payload_size)) {
+                    handler(payload, payload_size);
+                }
+
+                *xsk_ring_prod__fill_addr(&fill_ring, fill_index + i) = desc->addr & ~static_cast<uint64_t>(config.frame_size - 1);
+            }
+
+            xsk_ring_prod__submit(&fill_ring, received);
+            xsk_ring_cons__release(&rx_ring, received);
+            total += received;
+        }
+    }
+
+    void close() {
+        if (xsk) {
+            xsk_socket__delete(xsk);
+            xsk = nullptr;
+        }
+        if (umem) {
+            xsk_umem__delete(umem);
+            umem = nullptr;
+        }
+        if (umem_area) {
+            munmap(umem_area, umem_size);
+            umem_area = nullptr;
+        }
+        if (program_attached) {
+            bpf_xdp_detach(ifindex, xdp_flags, nullptr);
+            program_attached = false;
+        }
+        if (object) {
+            bpf_object__close(object);
+            object = nullptr;
+        }
+    }
+};
+
+AfXdpSocket::AfXdpSocket(const Config& config) : impl_(std::make_unique<Impl>()) {
+    impl_->config = config;
+}
+
+AfXdpSocket::~AfXdpSocket() {
+    impl_->close();
+}
+
+bool AfXdpSocket::open() {
+    if ((impl_->config.frame_size & (impl_->config.frame_size - 1)) != 0 ||
+        (impl_->config.frame_count & (impl_->config.frame_count - 1)) != 0) {
+        std::cerr << "AF_XDP: frame size and count must be powers of two" << std::endl;
+        return false;
+    }
+    return impl_->open();
+}
+
+void AfXdpSocket::close() {
+    impl_->close();
+}
+
+int AfXdpSocket::fd() const {
+    return impl_->xsk ? xsk_socket__fd(impl_->xsk) : -1;
+}
+
+size_t AfXdpSocket::receive(const PacketHandler& handler) {
+    return impl_->xsk ? impl_->receive(handler) : 0;
+}
@@ -1,5 +1,7 @@
 #include "drm_dmabuf_display.h"
 #include "dmabuf_allocator.h"
+#include "osd_overlay.h"
+#include "writeback_capture.h"
 #include <iostream>
 #include <fcntl.h>
 #include <unistd.h>
@@ -9,12 +11,22 @@
 #include <cstring>
 #include <vector>
 #include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <mutex>
+#include <poll.h>
+#include <optional>
+#include <sys/socket.h>
+#include <linux/netlink.h>
 #include <xf86drm.h>
 #include <xf86drmMode.h>
 #include <drm_fourcc.h>
 #include <linux/videodev2.h>
 
+#ifndef DRM_CAP_ATOMIC_ASYNC_PAGE_FLIP
+#define DRM_CAP_ATOMIC_ASYNC_PAGE_FLIP 0x15
+#endif
+
 class DrmDmaBufDisplayManager::Impl {
 public:
     struct ZeroCopyBuffer {
@@ -25,6 +37,38 @@ public:
         size_t size = 0;
     };
 
+    struct PlaneProperties {
+        uint32_t fb_id = 0;
+        uint32_t crtc_id = 0;
+        uint32_t src_x = 0;
+        uint32_t src_y = 0;
+        uint32_t src_w = 0;
+        uint32_t src_h = 0;
+        uint32_t crtc_x = 0;
+        uint32_t crtc_y = 0;
+        uint32_t crtc_w = 0;
+        uint32_t crtc_h = 0;
+        uint32_t rotation = 0;
+        uint64_t rotation_supported = 0;    // DRM_MODE_ROTATE_* / DRM_MODE_REFLECT_* bits
+    };
+
+    // One connector driven by its own CRTC and primary plane
+    struct Output {
+        uint32_t connector_id = 0;
+        uint32_t crtc_id = 0;
+        uint32_t crtc_index = 0;
+        drmModeModeInfo mode = {};
+        uint32_t tile_index = 0;    // Position in the video wall, row-major
+
+        // Atomic state
+        uint32_t plane_id = 0;
+        uint32_t mode_blob_id = 0;
+        uint32_t connector_crtc_prop = 0;
+        uint32_t crtc_mode_prop = 0;
+        uint32_t crtc_active_prop = 0;
+        PlaneProperties plane_props;
+    };
+
     int drm_fd = -1;
     drmModeRes* resources = nullptr;
     drmModeConnector* connector = nullptr;
@@ -33,14 +77,64 @@ public:
     drmModeModeInfo* mode = nullptr;
     uint32_t connector_id = 0;
     uint32_t crtc_id = 0;
+    uint32_t crtc_index = 0;
+
+    DisplayConfig config;
+    std::vector<Output> outputs;
+    bool atomic = false;
+    bool plane_transform = false;
+    int pending_events = 0;
     
     uint32_t width = 0;
     uint32_t height = 0;
+    uint32_t stride = 0;        // Luma bytes per line of the decoder's buffers
     
     std::vector<ZeroCopyBuffer> zero_copy_buffers;
     DmaBufAllocator dmabuf_allocator;
+
+    // Copy of the last frame shown while idle, so no decoder buffer is on screen
+    struct StillFrame {
+        uint32_t handle = 0;
+        uint32_t fb_id = 0;
+    };
+    StillFrame still;
+    std::unique_ptr<OsdOverlay> osd;
+    std::unique_ptr<WritebackCapture> writeback;
+    std::optional<OsdConfig> osd_config;    // Re-created on the new CRTC after a re-probe
+
+    // Display hotplug: kernel uevents (or a failing commit) trigger a re-probe
+    // of connectors and modes on the next frame; imported framebuffers survive
+    int uevent_fd = -1;
+    bool reprobe_needed = false;
+    std::atomic<bool> recovery_requested{false};
+    bool display_lost = false;
+    std::chrono::steady_clock::time_point last_reprobe;
     
     uint32_t frame_count = 0;
+
+    // Presentation state. The front buffer is on screen, the pending one is
+    // queued for the next flip; neither may be handed back to the decoder.
+    PresentMode present_mode = PresentMode::VSYNC;  // Effective mode after capability checks
+    bool crtc_configured = false;
+    int front_fd = -1;
+    int pending_fd = -1;
+    bool pending_async = false;
+    uint64_t pending_vsync_wait_us = 0;
+    uint64_t flip_sequence = 0;         // Of the latest flip; its events carry it as user data
+    std::vector<int> held_fds;          // Of lost flips: may be on screen until a later flip completes
+    std::chrono::steady_clock::time_point flip_submit_time;
+    std::vector<int> released_fds;
+
+    // Events are dispatched from handleFlipEvents(); user data is the flip sequence
+    static inline thread_local Impl* dispatching = nullptr;
+
+    mutable std::mutex stats_mutex;
+    Statistics stats;
+    uint64_t flip_latency_total_us = 0;
+    uint64_t vsync_saved_total_us = 0;
+
+    static constexpr int FLIP_TIMEOUT_MS = 100;
+    static constexpr auto REPROBE_INTERVAL = std::chrono::seconds(1);
     
     bool initializeDrm() {
         std::cout << "Initializing TRUE Zero-Copy DRM/DMA-buf display..." << std::endl;
@@ -93,102 +187,338 @@ public:
         std::cout << "DRM resources: " << resources->count_connectors << " connectors, " 
                   << resources->count_crtcs << " CRTC" << std::endl;
         
-        return findDisplay();
+        if (!findDisplay()) {
+            return false;
+        }
+        setupAtomic();
+        openHotplugMonitor();
+        return true;
     }
     
-    bool findDisplay() {
-        // Search for connected display
-        for (int i = 0; i < resources->count_connectors; i++) {
-            connector = drmModeGetConnector(drm_fd, resources->connectors[i]);
-            if (!connector) continue;
-            
-            std::cout << "Connector " << i << ": state=" 
-                      << (connector->connection == DRM_MODE_CONNECTED ? "connected" : "disconnected")
-                      << ", modes=" << connector->count_modes << std::endl;
-            
-            if (connector->connection == DRM_MODE_CONNECTED && connector->count_modes > 0) {
-                connector_id = connector->connector_id;
-                
-                // Search for 1080p mode
-                for (int j = 0; j < connector->count_modes; j++) {
-                    drmModeModeInfo* current_mode = &connector->modes[j];
-                    std::cout << "  Mode " << j << ": " << current_mode->hdisplay << "x" 
-                              << current_mode->vdisplay << "@" << current_mode->vrefresh << "Hz" << std::endl;
-                    
-                    if (current_mode->hdisplay == 1920 && current_mode->vdisplay == 1080) {
-                        mode = current_mode;
-                        std::cout << "  ✓ 1080p mode found!" << std::endl;
-                        break;
+    drmModeModeInfo* selectMode(drmModeConnector* conn) {
+        drmModeModeInfo* selected = nullptr;
+
+        // Search for 1080p mode
+        for (int j = 0; j < conn->count_modes; j++) {
+            drmModeModeInfo* current_mode = &conn->modes[j];
+            std::cout << "  Mode " << j << ": " << current_mode->hdisplay << "x"
+                      << current_mode->vdisplay << "@" << current_mode->vrefresh << "Hz" << std::endl;
+
+            if (current_mode->hdisplay == 1920 && current_mode->vdisplay == 1080) {
+                selected = current_mode;
+                std::cout << "  ✓ 1080p mode found!" << std::endl;
+                break;
+            }
+        }
+
+        if (!selected && conn->count_modes > 0) {
+            selected = &conn->modes[0];
+            std::cout << "Using first available mode: " << selected->hdisplay
+                      << "x" << selected->vdisplay << "@" << selected->vrefresh << "Hz" << std::endl;
+        }
+        return selected;
+    }
+
+    bool crtcInUse(uint32_t id) const {
+        return std::any_of(outputs.begin(), outputs.end(), [id](const Output& out) { return out.crtc_id == id; });
+    }
+
+    // Pick a CRTC not yet used by another output, preferring the one already driving the connector
+    bool findCrtc(drmModeConnector* conn, uint32_t& out_crtc_id, uint32_t& out_crtc_index, drmModeEncoder*& out_encoder) {
+        std::vector<uint32_t> encoder_ids;
+        if (conn->encoder_id) {
+            encoder_ids.push_back(conn->encoder_id);
+        }
+        for (int i = 0; i < conn->count_encoders; i++) {
+            encoder_ids.push_back(conn->encoders[i]);
+        }
+
+        for (uint32_t encoder_id : encoder_ids) {
+            drmModeEncoder* enc = drmModeGetEncoder(drm_fd, encoder_id);
+            if (!enc) continue;
+
+            // The CRTC currently bound to the encoder first, then any possible one
+            for (int pass = 0; pass < 2; pass++) {
+                for (int i = 0; i < resources->count_crtcs; i++) {
+                    bool candidate = pass == 0 ? enc->crtc_id == resources->crtcs[i]
+                                               : (enc->possible_crtcs & (1 << i)) != 0;
+                    if (candidate && !crtcInUse(resources->crtcs[i])) {
+                        out_crtc_id = resources->crtcs[i];
+                        out_crtc_index = i;
+                        out_encoder = enc;
+                        return true;
                     }
                 }
-                
-                if (!mode && connector->count_modes > 0) {
-                    mode = &connector->modes[0];
-                    std::cout << "Using first available mode: " << mode->hdisplay 
-                              << "x" << mode->vdisplay << "@" << mode->vrefresh << "Hz" << std::endl;
-                }
-                break; // Found suitable connector, exit
             }
-            
-            // Free connector if not suitable
-            drmModeFreeConnector(connector);
-            connector = nullptr;
+            drmModeFreeEncoder(enc);
         }
-        
-        if (!connector || !mode) {
+        return false;
+    }
+
+    bool findDisplay() {
+        // Search for connected displays; the first one is the primary output
+        for (int i = 0; i < resources->count_connectors; i++) {
+            drmModeConnector* conn = drmModeGetConnector(drm_fd, resources->connectors[i]);
+            if (!conn) continue;
+
+            std::cout << "Connector " << i << ": state="
+                      << (conn->connection == DRM_MODE_CONNECTED ? "connected" : "disconnected")
+                      << ", modes=" << conn->count_modes << std::endl;
+
+            if (conn->connection != DRM_MODE_CONNECTED || conn->count_modes == 0) {
+                drmModeFreeConnector(conn);
+                continue;
+            }
+
+            drmModeModeInfo* selected = selectMode(conn);
+            uint32_t out_crtc_id = 0;
+            uint32_t out_crtc_index = 0;
+            drmModeEncoder* enc = nullptr;
+            if (!selected || !findCrtc(conn, out_crtc_id, out_crtc_index, enc)) {
+                std::cerr << "No free CRTC for connector " << conn->connector_id << std::endl;
+                drmModeFreeConnector(conn);
+                continue;
+            }
+
+            Output output;
+            output.connector_id = conn->connector_id;
+            output.crtc_id = out_crtc_id;
+            output.crtc_index = out_crtc_index;
+            output.mode = *selected;
+            output.tile_index = static_cast<uint32_t>(outputs.size());
+            outputs.push_back(output);
+
+            if (!connector) {
+                connector = conn;
+                mode = selected;
+                encoder = enc;
+                connector_id = conn->connector_id;
+                crtc_id = out_crtc_id;
+                crtc_index = out_crtc_index;
+                crtc = drmModeGetCrtc(drm_fd, crtc_id);
+            } else {
+                drmModeFreeEncoder(enc);
+                drmModeFreeConnector(conn);
+            }
+
+            if (wallTiles() > 1 ? outputs.size() >= wallTiles() : !config.mirror_outputs) {
+                break; // Found suitable connector(s), exit
+            }
+        }
+
+        if (!connector || !mode || !crtc) {
             std::cerr << "No suitable display found" << std::endl;
             return false;
         }
-        
-        return findEncoder();
+
+        for (const auto& out : outputs) {
+            std::cout << "Output: connector " << out.connector_id << " -> CRTC " << out.crtc_id << ", "
+                      << out.mode.hdisplay << "x" << out.mode.vdisplay << "@" << out.mode.vrefresh << "Hz" << std::endl;
+        }
+
+        return true;
     }
-    
-    bool findEncoder() {
-        // Find encoder
-        if (connector->encoder_id) {
-            encoder = drmModeGetEncoder(drm_fd, connector->encoder_id);
+
+    uint32_t findPropertyId(uint32_t object_id, uint32_t object_type, const char* name) {
+        drmModeObjectProperties* props = drmModeObjectGetProperties(drm_fd, object_id, object_type);
+        if (!props) {
+            return 0;
         }
-        
-        if (!encoder) {
-            for (int i = 0; i < resources->count_encoders; i++) {
-                encoder = drmModeGetEncoder(drm_fd, resources->encoders[i]);
-                if (encoder) break;
+        uint32_t id = 0;
+        for (uint32_t i = 0; i < props->count_props && id == 0; i++) {
+            drmModePropertyRes* prop = drmModeGetProperty(drm_fd, props->props[i]);
+            if (prop) {
+                if (std::strcmp(prop->name, name) == 0) {
+                    id = prop->prop_id;
+                }
+                drmModeFreeProperty(prop);
             }
         }
-        
-        if (!encoder) {
-            std::cerr << "Error getting encoder" << std::endl;
+        drmModeFreeObjectProperties(props);
+        return id;
+    }
+
+    bool getPropertyValue(uint32_t object_id, uint32_t object_type, const char* name, uint64_t& value) {
+        drmModeObjectProperties* props = drmModeObjectGetProperties(drm_fd, object_id, object_type);
+        if (!props) {
             return false;
         }
-        
-        // Get CRTC
-        if (encoder->crtc_id) {
-            crtc = drmModeGetCrtc(drm_fd, encoder->crtc_id);
-            crtc_id = encoder->crtc_id;
-        } else {
-            // Search for free CRTC
-            for (int i = 0; i < resources->count_crtcs; i++) {
-                if (encoder->possible_crtcs & (1 << i)) {
-                    crtc_id = resources->crtcs[i];
-                    crtc = drmModeGetCrtc(drm_fd, crtc_id);
-                    if (crtc) break; // Add check for successful CRTC acquisition
+        bool found = false;
+        for (uint32_t i = 0; i < props->count_props && !found; i++) {
+            drmModePropertyRes* prop = drmModeGetProperty(drm_fd, props->props[i]);
+            if (prop) {
+                if (std::strcmp(prop->name, name) == 0) {
+                    value = props->prop_values[i];
+                    found = true;
                 }
+                drmModeFreeProperty(prop);
             }
         }
-        
-        if (!crtc) {
-            std::cerr << "Error getting CRTC" << std::endl;
+        drmModeFreeObjectProperties(props);
+        return found;
+    }
+
+    // Optional plane property; the supported bits are the bit indices of its enum values
+    uint32_t findRotationProperty(uint32_t plane_id, uint64_t& supported) {
+        supported = 0;
+        drmModeObjectProperties* props = drmModeObjectGetProperties(drm_fd, plane_id, DRM_MODE_OBJECT_PLANE);
+        if (!props) {
+            return 0;
+        }
+        uint32_t id = 0;
+        for (uint32_t i = 0; i < props->count_props && id == 0; i++) {
+            drmModePropertyRes* prop = drmModeGetProperty(drm_fd, props->props[i]);
+            if (prop) {
+                if (std::strcmp(prop->name, "rotation") == 0) {
+                    id = prop->prop_id;
+                    for (int e = 0; e < prop->count_enums; e++) {
+                        supported |= 1ULL << prop->enums[e].value;
+                    }
+                }
+                drmModeFreeProperty(prop);
+            }
+        }
+        drmModeFreeObjectProperties(props);
+        return id;
+    }
+
+    bool transformRequested() const {
+        return config.rotation != 0 || config.reflect_x || config.reflect_y;
+    }
+
+    bool quarterTurn() const {
+        return config.rotation == 90 || config.rotation == 270;
+    }
+
+    uint64_t rotationBits() const {
+        uint64_t bits = config.rotation == 90  ? DRM_MODE_ROTATE_90
+                      : config.rotation == 180 ? DRM_MODE_ROTATE_180
+                      : config.rotation == 270 ? DRM_MODE_ROTATE_270
+                                               : DRM_MODE_ROTATE_0;
+        if (config.reflect_x) bits |= DRM_MODE_REFLECT_X;
+        if (config.reflect_y) bits |= DRM_MODE_REFLECT_Y;
+        return bits;
+    }
+
+    // Primary plane of the CRTC that can scan out the decoder's YUV420 frames
+    uint32_t findPrimaryPlane(uint32_t index) {
+        drmModePlaneRes* plane_resources = drmModeGetPlaneResources(drm_fd);
+        if (!plane_resources) {
+            return 0;
+        }
+        uint32_t found = 0;
+        for (uint32_t i = 0; i < plane_resources->count_planes && found == 0; i++) {
+            drmModePlane* plane = drmModeGetPlane(drm_fd, plane_resources->planes[i]);
+            if (!plane) continue;
+
+            uint64_t type = 0;
+            bool usable = (plane->possible_crtcs & (1u << index)) &&
+                          std::find(plane->formats, plane->formats + plane->count_formats,
+                                    DRM_FORMAT_YUV420) != plane->formats + plane->count_formats &&
+                          getPropertyValue(plane->plane_id, DRM_MODE_OBJECT_PLANE, "type", type) &&
+                          type == DRM_PLANE_TYPE_PRIMARY;
+            if (usable) {
+                found = plane->plane_id;
+            }
+            drmModeFreePlane(plane);
+        }
+        drmModeFreePlaneResources(plane_resources);
+        return found;
+    }
+
+    bool setupAtomicOutput(Output& out) {
+        out.plane_id = findPrimaryPlane(out.crtc_index);
+        if (out.plane_id == 0) {
+            std::cerr << "No YUV420-capable primary plane for CRTC " << out.crtc_id << std::endl;
+            return false;
+        }
+
+        out.connector_crtc_prop = findPropertyId(out.connector_id, DRM_MODE_OBJECT_CONNECTOR, "CRTC_ID");
+        out.crtc_mode_prop = findPropertyId(out.crtc_id, DRM_MODE_OBJECT_CRTC, "MODE_ID");
+        out.crtc_active_prop = findPropertyId(out.crtc_id, DRM_MODE_OBJECT_CRTC, "ACTIVE");
+
+        PlaneProperties& pp = out.plane_props;
+        pp.fb_id = findPropertyId(out.plane_id, DRM_MODE_OBJECT_PLANE, "FB_ID");
+        pp.crtc_id = findPropertyId(out.plane_id, DRM_MODE_OBJECT_PLANE, "CRTC_ID");
+        pp.src_x = findPropertyId(out.plane_id, DRM_MODE_OBJECT_PLANE, "SRC_X");
+        pp.src_y = findPropertyId(out.plane_id, DRM_MODE_OBJECT_PLANE, "SRC_Y");
+        pp.src_w = findPropertyId(out.plane_id, DRM_MODE_OBJECT_PLANE, "SRC_W");
+        pp.src_h = findPropertyId(out.plane_id, DRM_MODE_OBJECT_PLANE, "SRC_H");
+        pp.crtc_x = findPropertyId(out.plane_id, DRM_MODE_OBJECT_PLANE, "CRTC_X");
+        pp.crtc_y = findPropertyId(out.plane_id, DRM_MODE_OBJECT_PLANE, "CRTC_Y");
+        pp.crtc_w = findPropertyId(out.plane_id, DRM_MODE_OBJECT_PLANE, "CRTC_W");
+        pp.crtc_h = findPropertyId(out.plane_id, DRM_MODE_OBJECT_PLANE, "CRTC_H");
+
+        pp.rotation = findRotationProperty(out.plane_id, pp.rotation_supported);
+
+        bool complete = out.connector_crtc_prop && out.crtc_mode_prop && out.crtc_active_prop &&
+                        pp.fb_id && pp.crtc_id && pp.src_x && pp.src_y && pp.src_w && pp.src_h &&
+                        pp.crtc_x && pp.crtc_y && pp.crtc_w && pp.crtc_h;
+        if (!complete) {
+            std::cerr << "Missing atomic properties for output on CRTC " << out.crtc_id << std::endl;
+            return false;
+        }
+
+        if (drmModeCreatePropertyBlob(drm_fd, &out.mode, sizeof(out.mode), &out.mode_blob_id) != 0) {
+            std::cerr << "Error creating mode blob: " << strerror(errno) << std::endl;
             return false;
         }
-        
-        std::cout << "Selected mode: " << mode->hdisplay << "x" << mode->vdisplay 
-                  << "@" << mode->vrefresh << "Hz" << std::endl;
-        
         return true;
     }
-    
-    bool setupZeroCopyBuffer(int dma_fd, uint32_t w, uint32_t h) {
-        std::cout << "Setting up TRUE zero-copy buffer: " << w << "x" << h 
+
+    void setupAtomic() {
+        atomic = drmSetClientCap(drm_fd, DRM_CLIENT_CAP_ATOMIC, 1) == 0;
+        if (atomic) {
+            for (auto& out : outputs) {
+                if (!setupAtomicOutput(out)) {
+                    atomic = false;
+                    break;
+                }
+            }
+        }
+
+        if (atomic && transformRequested()) {
+            uint64_t bits = rotationBits();
+            plane_transform = std::all_of(outputs.begin(), outputs.end(), [bits](const Output& out) {
+                return out.plane_props.rotation && (out.plane_props.rotation_supported & bits) == bits;
+            });
+            if (plane_transform) {
+                std::cout << "✅ Plane rotation " << config.rotation << "°"
+                          << (config.reflect_x ? " + reflect-x" : "") << (config.reflect_y ? " + reflect-y" : "") << std::endl;
+            } else {
+                std::cerr << "⚠️ WARNING: plane cannot apply the requested rotation/reflection" << std::endl;
+            }
+        }
+
+        if (atomic) {
+            std::cout << "✅ Atomic modesetting: " << outputs.size() << " output(s) in one commit" << std::endl;
+            if (wallTiles() > 1 && !wallActive()) {
+                std::cerr << "⚠️ WARNING: video wall needs " << wallTiles() << " outputs but only "
+                          << outputs.size() << " are usable, mirroring instead" << std::endl;
+            }
+            return;
+        }
+
+        destroyModeBlobs();
+        drmSetClientCap(drm_fd, DRM_CLIENT_CAP_ATOMIC, 0);
+        if (outputs.size() > 1) {
+            std::cerr << "⚠️ WARNING: multiple outputs need atomic modesetting, using the first output only" << std::endl;
+            outputs.resize(1);
+        }
+    }
+
+    void destroyModeBlobs() noexcept {
+        for (auto& out : outputs) {
+            if (out.mode_blob_id) {
+                drmModeDestroyPropertyBlob(drm_fd, out.mode_blob_id);
+                out.mode_blob_id = 0;
+            }
+        }
+    }
+
+    bool setupZeroCopyBuffer(int dma_fd, uint32_t w, uint32_t h, uint32_t pitch) {
+        pitch = pitch ? pitch : w;
+        std::cout << "Setting up TRUE zero-copy buffer: " << w << "x" << h << ", stride " << pitch
                   << ", DMA-fd=" << dma_fd << std::endl;
         
         if (dma_fd < 0) {
@@ -197,7 +527,7 @@ public:
         }
         
         // Check buffer size validity
-        if (w == 0 || h == 0 || w > 8192 || h > 8192) {
+        if (w == 0 || h == 0 || w > 8192 || h > 8192 || pitch < w || pitch > 16384) {
             std::cerr << "Invalid buffer size: " << w << "x" << h << std::endl;
             return false;
         }
@@ -210,6 +540,13 @@ public:
             }
         }
         
+        // The decoder's buffers define the frame size (a decoder-side quarter turn swaps it)
+        if (zero_copy_buffers.empty()) {
+            width = w;
+            height = h;
+            stride = pitch;
+        }
+
         // Import DMA-buf into DRM
         uint32_t handle = 0;
         if (drmPrimeFDToHandle(drm_fd, dma_fd, &handle) < 0) {
@@ -219,21 +556,11 @@ public:
         
         std::cout << "DMA-buf imported into DRM, handle=" << handle << std::endl;
         
-        // Calculate layout for YUV420 with overflow check
-        uint64_t y_size_64 = static_cast<uint64_t>(w) * h;
-        if (y_size_64 > UINT32_MAX) {
-            std::cerr << "Y plane size too large: " << y_size_64 << std::endl;
-            drmCloseBufferHandle(drm_fd, handle);
-            return false;
-        }
-        
-        uint32_t y_size = static_cast<uint32_t>(y_size_64);
-        uint32_t uv_size = y_size / 4;
-        
-        // Create framebuffer with YUV420 layout
+        // YUV420 layout at the decoder's line pitch (fits 32 bits: 16384 x 8192 x 1.5)
+        const auto layout = DisplayBackend::i420Layout(pitch, h);
         uint32_t handles[4] = {handle, handle, handle, 0};
-        uint32_t pitches[4] = {w, w/2, w/2, 0};
-        uint32_t offsets[4] = {0, y_size, y_size + uv_size, 0};
+        uint32_t pitches[4] = {layout.pitches[0], layout.pitches[1], layout.pitches[2], 0};
+        uint32_t offsets[4] = {layout.offsets[0], layout.offsets[1], layout.offsets[2], 0};
         
         uint32_t fb_id = 0;
         if (drmModeAddFB2(drm_fd, w, h, DRM_FORMAT_YUV420,
@@ -249,7 +576,7 @@ public:
         buffer.fb_id = fb_id;
         buffer.handle = handle;
         buffer.mapped_addr = nullptr;
-        buffer.size = y_size + uv_size * 2;
+        buffer.size = layout.size;
         
         zero_copy_buffers.push_back(buffer);
         
@@ -259,43 +586,711 @@ public:
         return true;
     }
     
-    bool displayZeroCopyFrame(int dma_fd) {
-        std::cout << "DrmDmaBufDisplayManager::Impl::displayZeroCopyFrame for DMA-fd " << dma_fd << std::endl;
-        auto start_time = std::chrono::high_resolution_clock::now();
-        
-        // Search for matching buffer
-        ZeroCopyBuffer* buffer = nullptr;
+    void checkAsyncSupport() {
+        if (present_mode != PresentMode::ASYNC) {
+            return;
+        }
+        // Atomic commits need their own capability for DRM_MODE_PAGE_FLIP_ASYNC
+        uint64_t cap = 0;
+        uint64_t capability = atomic ? DRM_CAP_ATOMIC_ASYNC_PAGE_FLIP : DRM_CAP_ASYNC_PAGE_FLIP;
+        if (drmGetCap(drm_fd, capability, &cap) != 0 || cap == 0) {
+            std::cerr << "⚠️ WARNING: driver has no async page flip support, using vsync flips" << std::endl;
+            present_mode = PresentMode::VSYNC;
+        } else {
+            std::cout << "✅ Async (tearing) page flips enabled" << std::endl;
+        }
+    }
+
+    // One event per CRTC; the flip is complete once every output reported.
+    // Events of a flip given up on (see flipLost()) arrive late and are dropped
+    static void onPageFlip(int /*fd*/, unsigned int /*sequence*/, unsigned int /*tv_sec*/,
+                           unsigned int /*tv_usec*/, unsigned int /*crtc_id*/, void* user_data) {
+        Impl* impl = dispatching;
+        auto sequence = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(user_data));
+        if (!impl || impl->pending_fd < 0 || sequence != impl->flip_sequence) {
+            return;
+        }
+        if (--impl->pending_events <= 0) {
+            impl->flipCompleted();
+        }
+    }
+
+    void flipCompleted() {
+        auto latency = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - flip_submit_time).count();
+
+        // The previous front buffer, and any left on screen by lost flips, have left scanout
+        if (front_fd >= 0 && front_fd != pending_fd) {
+            released_fds.push_back(front_fd);
+        }
+        front_fd = pending_fd;
+        pending_fd = -1;
+        pending_events = 0;
+        releaseHeld();
+        releaseStill();
+
+        std::lock_guard<std::mutex> lock(stats_mutex);
+        stats.flips++;
+        flip_latency_total_us += latency;
+        stats.avg_flip_latency_us = static_cast<double>(flip_latency_total_us) / stats.flips;
+        stats.max_flip_latency_us = std::max<uint64_t>(stats.max_flip_latency_us, latency);
+        if (pending_async) {
+            stats.async_flips++;
+            vsync_saved_total_us += pending_vsync_wait_us;
+            stats.avg_vsync_wait_saved_us = static_cast<double>(vsync_saved_total_us) / stats.async_flips;
+        }
+        if (stats.flips % 300 == 0) {
+            std::cout << "📺 Flips: " << stats.flips << " (" << stats.async_flips << " async), latency avg "
+                      << static_cast<int>(stats.avg_flip_latency_us) << " us, max " << stats.max_flip_latency_us << " us";
+            if (stats.async_flips > 0) {
+                std::cout << ", vsync wait saved avg " << static_cast<int>(stats.avg_vsync_wait_saved_us) << " us";
+            }
+            std::cout << std::endl;
+        }
+    }
+
+    // No event within the timeout: the flip may still complete later, so
+    // neither its buffer nor the front buffer can go back to the decoder
+    // until a later flip (or a blocking commit) is known to have completed
+    void flipLost() {
+        if (pending_fd >= 0 && pending_fd != front_fd) {
+            held_fds.push_back(pending_fd);
+        }
+        pending_fd = -1;
+        pending_events = 0;
+    }
+
+    // Buffers held for lost flips, once something else is known to be on screen
+    void releaseHeld() {
+        for (int fd : held_fds) {
+            if (fd != front_fd && fd != pending_fd) {
+                released_fds.push_back(fd);
+            }
+        }
+        held_fds.clear();
+    }
+
+    // Read the events queued on drm_fd; blocks if there are none
+    bool handleFlipEvents() {
+        drmEventContext context = {};
+        context.version = 3;
+        context.page_flip_handler2 = &Impl::onPageFlip;
+        dispatching = this;
+        int ret = drmHandleEvent(drm_fd, &context);
+        dispatching = nullptr;
+        if (ret != 0) {
+            std::cerr << "drmHandleEvent error: " << strerror(errno) << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    // Block until the in-flight flip has completed (one flip in flight at a time)
+    bool waitForPendingFlip() {
+        while (pending_fd >= 0) {
+            pollfd pfd = {drm_fd, POLLIN, 0};
+            int ret = poll(&pfd, 1, FLIP_TIMEOUT_MS);
+            if (ret < 0 && errno == EINTR) {
+                continue;
+            }
+            if (ret <= 0) {
+                std::cerr << "⚠️ Page flip event timeout, holding its buffers until a later flip completes" << std::endl;
+                {
+                    std::lock_guard<std::mutex> lock(stats_mutex);
+                    stats.flip_timeouts++;
+                }
+                flipLost();
+                return false;
+            }
+            if (!handleFlipEvents()) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Time until the next vblank, i.e. what a vsync'ed flip submitted now would wait
+    uint64_t estimateVsyncWaitUs() const {
+        if (!mode || mode->vrefresh == 0) {
+            return 0;
+        }
+        uint64_t sequence = 0;
+        uint64_t vblank_ns = 0;
+        if (drmCrtcGetSequence(drm_fd, crtc_id, &sequence, &vblank_ns) != 0) {
+            return 0;
+        }
+        timespec now = {};
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        uint64_t now_ns = static_cast<uint64_t>(now.tv_sec) * 1000000000ULL + now.tv_nsec;
+        uint64_t period_ns = 1000000000ULL / mode->vrefresh;
+        if (now_ns < vblank_ns) {
+            return 0;
+        }
+        return (period_ns - (now_ns - vblank_ns) % period_ns) / 1000;
+    }
+
+    struct Rect {
+        uint32_t x = 0;
+        uint32_t y = 0;
+        uint32_t w = 0;
+        uint32_t h = 0;
+    };
+
+    uint32_t wallTiles() const {
+        return config.wall_columns * config.wall_rows;
+    }
+
+    bool wallActive() const {
+        return atomic && wallTiles() > 1 && outputs.size() >= wallTiles();
+    }
+
+    // Part of the frame an output scans out: its wall tile, or the whole frame.
+    // Tile edges are kept even so the 4:2:0 chroma planes split cleanly.
+    Rect source(const Output& out) const {
+        if (!wallActive()) {
+            return {0, 0, width, height};
+        }
+        uint32_t column = out.tile_index % config.wall_columns;
+        uint32_t row = out.tile_index / config.wall_columns;
+        auto edge = [](uint32_t size, uint32_t i, uint32_t n) { return (size * i / n) & ~1u; };
+
+        Rect rect;
+        rect.x = edge(width, column, config.wall_columns);
+        rect.y = edge(height, row, config.wall_rows);
+        rect.w = (column + 1 == config.wall_columns ? width : edge(width, column + 1, config.wall_columns)) - rect.x;
+        rect.h = (row + 1 == config.wall_rows ? height : edge(height, row + 1, config.wall_rows)) - rect.y;
+        return rect;
+    }
+
+    // Where the source rectangle lands on an output, per the configured scale mode
+    Rect destination(const Output& out, Rect src) const {
+        if (plane_transform && quarterTurn()) {
+            std::swap(src.w, src.h);
+        }
+        const uint32_t mw = out.mode.hdisplay;
+        const uint32_t mh = out.mode.vdisplay;
+        if (config.scale_mode == ScaleMode::STRETCH || src.w == 0 || src.h == 0) {
+            return {0, 0, mw, mh};
+        }
+
+        Rect rect;
+        if (static_cast<uint64_t>(mw) * src.h > static_cast<uint64_t>(mh) * src.w) {
+            rect.w = static_cast<uint32_t>(static_cast<uint64_t>(src.w) * mh / src.h);
+            rect.h = mh;
+        } else {
+            rect.w = mw;
+            rect.h = static_cast<uint32_t>(static_cast<uint64_t>(src.h) * mw / src.w);
+        }
+        rect.x = (mw - rect.w) / 2;
+        rect.y = (mh - rect.h) / 2;
+        return rect;
+    }
+
+    void addOutputState(drmModeAtomicReq* req, const Output& out, uint32_t fb_id, bool modeset) const {
+        const PlaneProperties& pp = out.plane_props;
+        if (modeset) {
+            Rect src = source(out);
+            Rect dst = destination(out, src);
+            drmModeAtomicAddProperty(req, out.connector_id, out.connector_crtc_prop, out.crtc_id);
+            drmModeAtomicAddProperty(req, out.crtc_id, out.crtc_mode_prop, out.mode_blob_id);
+            drmModeAtomicAddProperty(req, out.crtc_id, out.crtc_active_prop, 1);
+            drmModeAtomicAddProperty(req, out.plane_id, pp.crtc_id, out.crtc_id);
+            drmModeAtomicAddProperty(req, out.plane_id, pp.src_x, static_cast<uint64_t>(src.x) << 16);
+            drmModeAtomicAddProperty(req, out.plane_id, pp.src_y, static_cast<uint64_t>(src.y) << 16);
+            drmModeAtomicAddProperty(req, out.plane_id, pp.src_w, static_cast<uint64_t>(src.w) << 16);
+            drmModeAtomicAddProperty(req, out.plane_id, pp.src_h, static_cast<uint64_t>(src.h) << 16);
+            drmModeAtomicAddProperty(req, out.plane_id, pp.crtc_x, dst.x);
+            drmModeAtomicAddProperty(req, out.plane_id, pp.crtc_y, dst.y);
+            drmModeAtomicAddProperty(req, out.plane_id, pp.crtc_w, dst.w);
+            drmModeAtomicAddProperty(req, out.plane_id, pp.crtc_h, dst.h);
+            if (pp.rotation) {
+                drmModeAtomicAddProperty(req, out.plane_id, pp.rotation,
+                                         plane_transform ? rotationBits() : DRM_MODE_ROTATE_0);
+            }
+        }
+        drmModeAtomicAddProperty(req, out.plane_id, pp.fb_id, fb_id);
+    }
+
+    // All outputs switch to the framebuffer in the same commit
+    bool commitAtomic(uint32_t fb_id, bool modeset, bool async) {
+        drmModeAtomicReq* req = drmModeAtomicAlloc();
+        if (!req) {
+            return false;
+        }
+        for (const auto& out : outputs) {
+            addOutputState(req, out, fb_id, modeset);
+        }
+        // Async commits may only change FB_ID, so tearing flips go uncaptured
+        // and OSD updates wait for the next vsync'ed flip
+        bool capturing = writeback && !async && writeback->addToCommit(req, modeset, fb_id);
+        bool with_osd = osd && !async;
+        if (with_osd) {
+            (void)osd->addToCommit(req, modeset);
+        }
+
+        uint32_t flags = modeset ? DRM_MODE_ATOMIC_ALLOW_MODESET
+                                 : DRM_MODE_ATOMIC_NONBLOCK | DRM_MODE_PAGE_FLIP_EVENT |
+                                   (async ? DRM_MODE_PAGE_FLIP_ASYNC : 0);
+        void* user_data = reinterpret_cast<void*>(static_cast<uintptr_t>(flip_sequence));
+        int ret = drmModeAtomicCommit(drm_fd, req, flags, user_data);
+        drmModeAtomicFree(req);
+        if (writeback) {
+            writeback->commitDone(ret == 0);
+        }
+        if (with_osd) {
+            osd->commitDone(ret == 0);
+        }
+
+        if (ret != 0 && capturing) {
+            // Never let the diagnostic path take the video down
+            std::cerr << "⚠️ WARNING: commit with writeback rejected (" << strerror(errno)
+                      << "), disabling capture" << std::endl;
+            writeback.reset();
+            return commitAtomic(fb_id, modeset, async);
+        }
+        return ret == 0;
+    }
+
+    void enableWriteback() {
+        if (!config.writeback.enabled) {
+            return;
+        }
+        if (!atomic) {
+            std::cerr << "⚠️ WARNING: writeback capture needs atomic modesetting, continuing without it" << std::endl;
+            return;
+        }
+        const Output& primary = outputs.front();
+        writeback = std::make_unique<WritebackCapture>(config.writeback);
+        if (!writeback->initialize(drm_fd, primary.crtc_id, primary.crtc_index,
+                                   primary.mode.hdisplay, primary.mode.vdisplay)) {
+            std::cerr << "⚠️ WARNING: writeback capture unavailable, continuing without it" << std::endl;
+            writeback.reset();
+        }
+    }
+
+    // Scan out the writeback test pattern once, 1:1 on the primary output, and check its capture
+    void writebackSelfCheck() {
+        uint32_t fb_id = writeback ? writeback->testPatternFb() : 0;
+        if (!fb_id) {
+            return;
+        }
+        const Output& out = outputs.front();
+        const PlaneProperties& pp = out.plane_props;
+        drmModeAtomicReq* req = drmModeAtomicAlloc();
+        if (!req) {
+            return;
+        }
+        drmModeAtomicAddProperty(req, out.connector_id, out.connector_crtc_prop, out.crtc_id);
+        drmModeAtomicAddProperty(req, out.crtc_id, out.crtc_mode_prop, out.mode_blob_id);
+        drmModeAtomicAddProperty(req, out.crtc_id, out.crtc_active_prop, 1);
+        drmModeAtomicAddProperty(req, out.plane_id, pp.crtc_id, out.crtc_id);
+        drmModeAtomicAddProperty(req, out.plane_id, pp.src_x, 0);
+        drmModeAtomicAddProperty(req, out.plane_id, pp.src_y, 0);
+        drmModeAtomicAddProperty(req, out.plane_id, pp.src_w, static_cast<uint64_t>(out.mode.hdisplay) << 16);
+        drmModeAtomicAddProperty(req, out.plane_id, pp.src_h, static_cast<uint64_t>(out.mode.vdisplay) << 16);
+        drmModeAtomicAddProperty(req, out.plane_id, pp.crtc_x, 0);
+        drmModeAtomicAddProperty(req, out.plane_id, pp.crtc_y, 0);
+        drmModeAtomicAddProperty(req, out.plane_id, pp.crtc_w, out.mode.hdisplay);
+        drmModeAtomicAddProperty(req, out.plane_id, pp.crtc_h, out.mode.vdisplay);
+        if (pp.rotation) {
+            drmModeAtomicAddProperty(req, out.plane_id, pp.rotation, DRM_MODE_ROTATE_0);
+        }
+        drmModeAtomicAddProperty(req, out.plane_id, pp.fb_id, fb_id);
+        bool capturing = writeback->addToCommit(req, true, fb_id);
+        int ret = drmModeAtomicCommit(drm_fd, req, DRM_MODE_ATOMIC_ALLOW_MODESET, nullptr);
+        drmModeAtomicFree(req);
+        writeback->commitDone(ret == 0);
+        if (ret != 0 || !capturing) {
+            std::cerr << "⚠️ WARNING: writeback self-check not run"
+                      << (ret != 0 ? std::string(" (") + strerror(errno) + ")" : std::string()) << std::endl;
+            return;
+        }
+        (void)writeback->drain(1000);
+
+        // Undo the whole modeset: nothing stays on screen and nothing stays
+        // bound until the first frame sets the mode again
+        req = drmModeAtomicAlloc();
+        if (!req) {
+            return;
+        }
+        drmModeAtomicAddProperty(req, out.plane_id, pp.fb_id, 0);
+        drmModeAtomicAddProperty(req, out.plane_id, pp.crtc_id, 0);
+        drmModeAtomicAddProperty(req, out.connector_id, out.connector_crtc_prop, 0);
+        drmModeAtomicAddProperty(req, out.crtc_id, out.crtc_mode_prop, 0);
+        drmModeAtomicAddProperty(req, out.crtc_id, out.crtc_active_prop, 0);
+        writeback->addUnbind(req);
+        ret = drmModeAtomicCommit(drm_fd, req, DRM_MODE_ATOMIC_ALLOW_MODESET, nullptr);
+        drmModeAtomicFree(req);
+        if (ret != 0) {
+            std::cerr << "⚠️ WARNING: writeback self-check teardown failed (" << strerror(errno)
+                      << "), the test pattern may stay on screen until the first frame" << std::endl;
+        }
+    }
+
+    bool modeset(uint32_t fb_id) {
+        if (atomic) {
+            if (wallActive()) {
+                for (const auto& out : outputs) {
+                    Rect src = source(out);
+                    std::cout << "🧱 Wall tile " << out.tile_index << ": " << src.w << "x" << src.h << "+"
+                              << src.x << "+" << src.y << " -> connector " << out.connector_id << std::endl;
+                }
+            }
+            return commitAtomic(fb_id, true, false);
+        }
+        if (drmModeSetCrtc(drm_fd, crtc_id, fb_id, 0, 0, &connector_id, 1, mode) != 0) {
+            return false;
+        }
+        if (osd) {
+            osd->presentLegacy();
+        }
+        return true;
+    }
+
+    bool submitFlip(uint32_t fb_id, bool async) {
+        if (atomic) {
+            return commitAtomic(fb_id, false, async);
+        }
+        if (osd) {
+            osd->presentLegacy();
+        }
+        uint32_t flags = DRM_MODE_PAGE_FLIP_EVENT | (async ? DRM_MODE_PAGE_FLIP_ASYNC : 0);
+        return drmModePageFlip(drm_fd, crtc_id, fb_id, flags,
+                               reinterpret_cast<void*>(static_cast<uintptr_t>(flip_sequence))) == 0;
+    }
+
+    ZeroCopyBuffer* findBuffer(int dma_fd) {
         for (auto& buf : zero_copy_buffers) {
             if (buf.dma_fd == dma_fd) {
-                buffer = &buf;
-                break;
+                return &buf;
             }
         }
-        
+        return nullptr;
+    }
+
+    void openHotplugMonitor() {
+        uevent_fd = socket(AF_NETLINK, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, NETLINK_KOBJECT_UEVENT);
+        sockaddr_nl addr = {};
+        addr.nl_family = AF_NETLINK;
+        addr.nl_groups = 1;     // Kernel uevents (udev rebroadcasts on group 2)
+        if (uevent_fd < 0 || bind(uevent_fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+            std::cerr << "⚠️ WARNING: hotplug monitoring unavailable: " << strerror(errno) << std::endl;
+            if (uevent_fd >= 0) {
+                close(uevent_fd);
+                uevent_fd = -1;
+            }
+        }
+    }
+
+    // Drain queued uevents; true if one of them was a DRM hotplug
+    bool hotplugPending() {
+        if (uevent_fd < 0) {
+            return false;
+        }
+        bool hotplug = false;
+        char message[4096];
+        ssize_t len;
+        while ((len = recv(uevent_fd, message, sizeof(message) - 1, 0)) > 0) {
+            message[len] = '\0';
+            bool drm = false;
+            bool hotplug_key = false;
+            // "ACTION@DEVPATH" followed by NUL-separated KEY=VALUE pairs
+            for (const char* field = message; field < message + len; field += std::strlen(field) + 1) {
+                drm = drm || std::strcmp(field, "SUBSYSTEM=drm") == 0;
+                hotplug_key = hotplug_key || std::strcmp(field, "HOTPLUG=1") == 0;
+            }
+            hotplug = hotplug || (drm && hotplug_key);
+        }
+        return hotplug;
+    }
+
+    void releaseProbedState() noexcept {
+        destroyModeBlobs();
+        outputs.clear();
+        atomic = false;
+        plane_transform = false;
+        mode = nullptr;
+        if (crtc) {
+            drmModeFreeCrtc(crtc);
+            crtc = nullptr;
+        }
+        if (encoder) {
+            drmModeFreeEncoder(encoder);
+            encoder = nullptr;
+        }
+        if (connector) {
+            drmModeFreeConnector(connector);
+            connector = nullptr;
+        }
+        if (resources) {
+            drmModeFreeResources(resources);
+            resources = nullptr;
+        }
+    }
+
+    bool startOsd(const OsdConfig& osd_settings) {
+        osd_config = osd_settings;
+        auto overlay = std::make_unique<OsdOverlay>(osd_settings);
+        if (!overlay->initialize(drm_fd, crtc_id, crtc_index, mode->hdisplay, mode->vdisplay, atomic)) {
+            return false;
+        }
+        osd = std::move(overlay);
+        return true;
+    }
+
+    // Choose outputs again after a hotplug or mode change, keeping the decoder's
+    // imported framebuffers, and put the last frame straight back on screen
+    bool reprobe() {
+        last_reprobe = std::chrono::steady_clock::now();
+        std::cout << "🔌 Display change, re-probing outputs" << std::endl;
+        if (pending_fd >= 0) {
+            (void)waitForPendingFlip();
+        }
+        osd.reset();
+        writeback.reset();
+        releaseProbedState();
+        crtc_configured = false;
+
+        resources = drmModeGetResources(drm_fd);
+        if (!resources || !findDisplay()) {
+            // Keep decoding; frames are handed straight back until a display returns
+            if (!display_lost) {
+                std::cerr << "⚠️ No display connected, waiting for hotplug" << std::endl;
+            }
+            display_lost = true;
+            if (front_fd >= 0) {
+                released_fds.push_back(front_fd);
+                front_fd = -1;
+            }
+            releaseHeld();
+            return false;
+        }
+        display_lost = false;
+        setupAtomic();
+        present_mode = config.present_mode;
+        checkAsyncSupport();
+        enableWriteback();
+        if (osd_config && !startOsd(*osd_config)) {
+            std::cerr << "⚠️ WARNING: OSD overlay unavailable after re-probe" << std::endl;
+        }
+
+        ZeroCopyBuffer* front = front_fd >= 0 ? findBuffer(front_fd) : nullptr;
+        uint32_t shown_fb = front ? front->fb_id : still.fb_id;
+        if (shown_fb && modeset(shown_fb)) {
+            // A blocking commit: lost flips are over, only the front buffer is on screen
+            crtc_configured = true;
+            releaseHeld();
+        }
+        std::cout << "✅ Display recovered on " << outputs.size() << " output(s), "
+                  << mode->hdisplay << "x" << mode->vdisplay << "@" << mode->vrefresh << "Hz" << std::endl;
+        return true;
+    }
+
+    bool displayZeroCopyFrame(int dma_fd) {
+        ZeroCopyBuffer* buffer = findBuffer(dma_fd);
         if (!buffer) {
             std::cerr << "Buffer not found for DMA-fd " << dma_fd << std::endl;
             return false;
         }
-        
-        if (drmModeSetCrtc(drm_fd, crtc_id, buffer->fb_id, 0, 0,
-                          &connector_id, 1, mode) != 0) {
-            std::cerr << "TRUE zero-copy display error: " << strerror(errno) << std::endl;
+
+        bool failure_reprobe = reprobe_needed && std::chrono::steady_clock::now() - last_reprobe >= REPROBE_INTERVAL;
+        bool recovery = recovery_requested.exchange(false);
+        if (hotplugPending() || failure_reprobe || recovery) {
+            reprobe_needed = false;
+            (void)reprobe();
+        }
+        if (display_lost) {
+            released_fds.push_back(dma_fd);
+            return true;
+        }
+
+        // The first frame sets the mode, every later one is a page flip
+        if (!crtc_configured) {
+            if (!modeset(buffer->fb_id)) {
+                std::cerr << "TRUE zero-copy display error: " << strerror(errno) << std::endl;
+                reprobe_needed = true;
+                return false;
+            }
+            crtc_configured = true;
+            if (front_fd >= 0 && front_fd != dma_fd) {
+                released_fds.push_back(front_fd);
+            }
+            front_fd = dma_fd;
+            releaseHeld();
+            std::cout << "TRUE ZERO-COPY display: mode set on " << outputs.size() << " output(s), presenting with "
+                      << (present_mode == PresentMode::ASYNC ? "async" : "vsync") << " page flips" << std::endl;
+            return true;
+        }
+
+        (void)waitForPendingFlip();
+
+        bool async = present_mode == PresentMode::ASYNC;
+        uint64_t vsync_wait_us = async ? estimateVsyncWaitUs() : 0;
+        flip_submit_time = std::chrono::steady_clock::now();
+        ++flip_sequence;
+        bool submitted = submitFlip(buffer->fb_id, async);
+        if (!submitted && async) {
+            // Some drivers refuse async flips in certain configurations
+            std::cerr << "⚠️ WARNING: async page flip rejected (" << strerror(errno) << "), using vsync flips" << std::endl;
+            present_mode = PresentMode::VSYNC;
+            async = false;
+            submitted = submitFlip(buffer->fb_id, false);
+        }
+        if (!submitted) {
+            if (errno == EBUSY && !held_fds.empty()) {
+                // A lost flip is still pending in the kernel; this frame is skipped
+                return false;
+            }
+            // Outputs may have gone away without a uevent reaching us
+            std::cerr << "Page flip error: " << strerror(errno) << std::endl;
+            reprobe_needed = true;
             return false;
         }
-        
-        auto end_time = std::chrono::high_resolution_clock::now();
-        auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time);
-        
-        std::cout << "TRUE ZERO-COPY display: " << duration.count() 
-                  << " us (NO copying!)" << std::endl;
-                
+
+        pending_fd = dma_fd;
+        pending_async = async;
+        pending_vsync_wait_us = vsync_wait_us;
+        pending_events = atomic ? static_cast<int>(outputs.size()) : 1;
         return true;
     }
-    
-    void cleanup() noexcept {
-        std::cout << "Cleaning up DRM resources..." << std::endl;
-        
-        // Clean up zero-copy buffers
+
+    void blank() {
+        if (!crtc_configured || display_lost) {
+            return;
+        }
+        if (!atomic) {
+            std::cerr << "⚠️ Blanking needs atomic modesetting, keeping the last frame" << std::endl;
+            return;
+        }
+        if (pending_fd >= 0) {
+            (void)waitForPendingFlip();
+        }
+
+        drmModeAtomicReq* req = drmModeAtomicAlloc();
+        if (!req) {
+            return;
+        }
+        for (const auto& out : outputs) {
+            drmModeAtomicAddProperty(req, out.plane_id, out.plane_props.fb_id, 0);
+            drmModeAtomicAddProperty(req, out.plane_id, out.plane_props.crtc_id, 0);
+        }
+        int ret = drmModeAtomicCommit(drm_fd, req, 0, nullptr);
+        drmModeAtomicFree(req);
+        if (ret != 0) {
+            std::cerr << "⚠️ Failed to blank the display (" << strerror(errno) << "), keeping the last frame" << std::endl;
+            return;
+        }
+
+        if (front_fd >= 0) {
+            released_fds.push_back(front_fd);
+            front_fd = -1;
+        }
+        releaseHeld();
+        releaseStill();
+        crtc_configured = false;
+    }
+
+    // Idle: a copy of the last frame (or nothing) on screen, no imports left
+    bool suspend(bool blank_screen) {
+        if (pending_fd >= 0) {
+            (void)waitForPendingFlip();
+        }
+        if (crtc_configured && !display_lost && (blank_screen || !showStill())) {
+            blank();
+        }
+        if (front_fd >= 0 || !held_fds.empty()) {
+            return false;   // Still (possibly) scanning out a decoder buffer
+        }
+        removeZeroCopyBuffers();
+        return true;
+    }
+
+    // Put a copy of the front frame in a dumb buffer on screen
+    bool showStill() {
+        ZeroCopyBuffer* front = front_fd >= 0 ? findBuffer(front_fd) : nullptr;
+        if (!front || width == 0 || height == 0) {
+            return false;
+        }
+        const auto source = DisplayBackend::i420Layout(stride ? stride : width, height);
+        void* frame = mmap(nullptr, source.size, PROT_READ, MAP_SHARED, front_fd, 0);
+        if (frame == MAP_FAILED) {
+            std::cerr << "⚠️ Cannot map the last frame: " << strerror(errno) << std::endl;
+            return false;
+        }
+
+        drm_mode_create_dumb create = {};
+        create.width = width;
+        create.height = height + (height + 1) / 2;
+        create.bpp = 8;
+        drm_mode_map_dumb map = {};
+        void* addr = MAP_FAILED;
+        if (drmIoctl(drm_fd, DRM_IOCTL_MODE_CREATE_DUMB, &create) == 0) {
+            map.handle = create.handle;
+            if (drmIoctl(drm_fd, DRM_IOCTL_MODE_MAP_DUMB, &map) == 0) {
+                addr = mmap(nullptr, create.size, PROT_READ | PROT_WRITE, MAP_SHARED, drm_fd, map.offset);
+            }
+        }
+        if (addr == MAP_FAILED) {
+            std::cerr << "⚠️ Cannot allocate a still frame: " << strerror(errno) << std::endl;
+            munmap(frame, source.size);
+            destroyStill(create.handle, 0);
+            return false;
+        }
+
+        // Same YUV420 layout as the decoder's, from its line pitch to the dumb buffer's
+        const auto target = DisplayBackend::i420Layout(create.pitch, height);
+        const uint8_t* src = static_cast<const uint8_t*>(frame);
+        uint8_t* dst = static_cast<uint8_t*>(addr);
+        for (uint32_t plane = 0; plane < 3; ++plane) {
+            uint32_t rows = plane == 0 ? height : (height + 1) / 2;
+            uint32_t bytes = plane == 0 ? width : width / 2;
+            for (uint32_t row = 0; row < rows; ++row) {
+                std::memcpy(dst + target.offsets[plane] + row * target.pitches[plane],
+                            src + source.offsets[plane] + row * source.pitches[plane], bytes);
+            }
+        }
+        munmap(addr, create.size);
+        munmap(frame, source.size);
+
+        uint32_t handles[4] = {create.handle, create.handle, create.handle, 0};
+        uint32_t pitches[4] = {target.pitches[0], target.pitches[1], target.pitches[2], 0};
+        uint32_t offsets[4] = {target.offsets[0], target.offsets[1], target.offsets[2], 0};
+        uint32_t fb_id = 0;
+        if (drmModeAddFB2(drm_fd, width, height, DRM_FORMAT_YUV420, handles, pitches, offsets, &fb_id, 0) < 0 ||
+            !modeset(fb_id)) {
+            std::cerr << "⚠️ Cannot show the still frame: " << strerror(errno) << std::endl;
+            destroyStill(create.handle, fb_id);
+            return false;
+        }
+
+        releaseStill();
+        still = {create.handle, fb_id};
+        released_fds.push_back(front_fd);
+        front_fd = -1;
+        releaseHeld();
+        return true;
+    }
+
+    void releaseStill() noexcept {
+        if (still.handle) {
+            destroyStill(still.handle, still.fb_id);
+            still = {};
+        }
+    }
+
+    void destroyStill(uint32_t handle, uint32_t fb_id) noexcept {
+        if (fb_id) {
+            drmModeRmFB(drm_fd, fb_id);
+        }
+        if (handle) {
+            drm_mode_destroy_dumb destroy = {};
+            destroy.handle = handle;
+            drmIoctl(drm_fd, DRM_IOCTL_MODE_DESTROY_DUMB, &destroy);
+        }
+    }
+
+    // Forget every imported decoder buffer; later frames are imported again
+    void removeZeroCopyBuffers() noexcept {
         for (auto& buffer : zero_copy_buffers) {
             if (buffer.fb_id > 0) {
                 if (drmModeRmFB(drm_fd, buffer.fb_id) < 0) {
@@ -311,23 +1306,41 @@ public:
             }
         }
         zero_copy_buffers.clear();
+    }
+
+    std::vector<int> takeReleasedBuffers() {
+        std::vector<int> released;
+        released.swap(released_fds);
+        return released;
+    }
+    
+    void cleanup() noexcept {
+        std::cout << "Cleaning up DRM resources..." << std::endl;
+
+        // The overlay plane shares the DRM fd
+        osd.reset();
+        writeback.reset();
+
+        if (pending_fd >= 0) {
+            (void)waitForPendingFlip();
+        }
+        crtc_configured = false;
+        front_fd = -1;
+        held_fds.clear();
+        released_fds.clear();
+        
+        // Clean up zero-copy buffers
+        removeZeroCopyBuffers();
+        releaseStill();
         
         // Clean up DRM resources
-        if (crtc) {
-            drmModeFreeCrtc(crtc);
-            crtc = nullptr;
-        }
-        if (encoder) {
-            drmModeFreeEncoder(encoder);
-            encoder = nullptr;
-        }
-        if (connector) {
-            drmModeFreeConnector(connector);
-            connector = nullptr;
-        }
-        if (resources) {
-            drmModeFreeResources(resources);
-            resources = nullptr;
+        releaseProbedState();
+        osd_config.reset();
+        display_lost = false;
+        reprobe_needed = false;
+        if (uevent_fd >= 0) {
+            close(uevent_fd);
+            uevent_fd = -1;
         }
         if (drm_fd >= 0) {
             close(drm_fd);
@@ -342,15 +1355,30 @@ DrmDmaBufDisplayManager::DrmDmaBufDisplayManager() : impl_(std::make_unique<Impl
 
 DrmDmaBufDisplayManager::~DrmDmaBufDisplayManager() = default;
 
+void DrmDmaBufDisplayManager::setConfig(const DisplayConfig& config) {
+    impl_->config = config;
+    impl_->present_mode = config.present_mode;
+}
+
+bool DrmDmaBufDisplayManager::transformApplied() const {
+    return !impl_->transformRequested() || impl_->plane_transform;
+}
+
 bool DrmDmaBufDisplayManager::initialize(uint32_t width, uint32_t height) {
     impl_->width = width;
     impl_->height = height;
     
-    return impl_->initializeDrm();
+    if (!impl_->initializeDrm()) {
+        return false;
+    }
+    impl_->checkAsyncSupport();
+    impl_->enableWriteback();
+    impl_->writebackSelfCheck();
+    return true;
 }
 
-bool DrmDmaBufDisplayManager::setupZeroCopyBuffer(int dma_fd, uint32_t width, uint32_t height) {
-    return impl_->setupZeroCopyBuffer(dma_fd, width, height);
+bool DrmDmaBufDisplayManager::setupZeroCopyBuffer(int dma_fd, uint32_t width, uint32_t height, uint32_t stride) {
+    return impl_->setupZeroCopyBuffer(dma_fd, width, height, stride);
 }
 
 bool DrmDmaBufDisplayManager::displayFrame(const FrameInfo& frame) {
@@ -363,6 +1391,56 @@ bool DrmDmaBufDisplayManager::displayFrame(const FrameInfo& frame) {
     }
 }
 
+std::vector<int> DrmDmaBufDisplayManager::takeReleasedBuffers() {
+    return impl_->takeReleasedBuffers();
+}
+
+DrmDmaBufDisplayManager::Statistics DrmDmaBufDisplayManager::getStatistics() const {
+    std::lock_guard<std::mutex> lock(impl_->stats_mutex);
+    return impl_->stats;
+}
+
+int DrmDmaBufDisplayManager::eventFd() const {
+    return impl_->drm_fd;
+}
+
+bool DrmDmaBufDisplayManager::presentPending() const {
+    return impl_->pending_fd >= 0;
+}
+
+void DrmDmaBufDisplayManager::requestRecovery() {
+    impl_->recovery_requested = true;
+}
+
+void DrmDmaBufDisplayManager::blank() {
+    impl_->blank();
+}
+
+bool DrmDmaBufDisplayManager::suspend(bool blank_screen) {
+    return impl_->suspend(blank_screen);
+}
+
+void DrmDmaBufDisplayManager::dispatchEvents() {
+    pollfd pfd = {impl_->drm_fd, POLLIN, 0};
+    if (impl_->drm_fd >= 0 && poll(&pfd, 1, 0) > 0) {
+        (void)impl_->handleFlipEvents();
+    }
+}
+
+bool DrmDmaBufDisplayManager::enableOsd(const OsdConfig& config) {
+    if (impl_->drm_fd < 0 || !impl_->mode) {
+        std::cerr << "OSD requires an initialized display" << std::endl;
+        return false;
+    }
+    return impl_->startOsd(config);
+}
+
+void DrmDmaBufDisplayManager::setOsdText(const std::vector<std::string>& lines) {
+    if (impl_->osd) {
+        impl_->osd->setText(lines);
+    }
+}
+
 void DrmDmaBufDisplayManager::cleanup() noexcept {
     impl_->cleanup();
 }
@@ -370,7 +1448,11 @@ void DrmDmaBufDisplayManager::cleanup() noexcept {
 std::string DrmDmaBufDisplayManager::getDisplayInfo() const {
     if (impl_->mode) {
         return "TRUE Zero-Copy DRM/DMA-buf: " + std::to_string(impl_->mode->hdisplay) + "x" + 
-               std::to_string(impl_->mode->vdisplay) + "@" + std::to_string(impl_->mode->vrefresh) + "Hz";
+               std::to_string(impl_->mode->vdisplay) + "@" + std::to_string(impl_->mode->vrefresh) + "Hz" +
+               (impl_->wallActive() ? " (wall " + std::to_string(impl_->config.wall_columns) + "x" +
+                                            std::to_string(impl_->config.wall_rows) + ")"
+                : impl_->outputs.size() > 1 ? " (+" + std::to_string(impl_->outputs.size() - 1) + " mirrored)" : "") +
+               (impl_->atomic ? ", atomic" : ", legacy");
     }
     return "TRUE Zero-Copy DRM/DMA-buf (not initialized)";
 }
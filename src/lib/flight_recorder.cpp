@@ -0,0 +1,202 @@
+#include "flight_recorder.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <condition_variable>
+#include <cstdio>
+#include <ctime>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+
+int64_t steadyNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+std::string flagNames(uint8_t flags) {
+    static constexpr const char* NAMES[] = {"discontinuity", "buffer-error", "displayed",
+                                            "exported", "recovered", "latency-spike"};
+    std::string names;
+    for (size_t bit = 0; bit < std::size(NAMES); ++bit) {
+        if (flags & (1u << bit)) {
+            names += names.empty() ? "" : "|";
+            names += NAMES[bit];
+        }
+    }
+    return names;
+}
+
+} // namespace
+
+class FlightRecorder::Impl {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit Impl(FlightRecorder& owner) : recorder(owner) {
+        thread = std::thread(&Impl::run, this);
+    }
+
+    ~Impl() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+
+    void trigger(const char* reason) {
+        std::lock_guard<std::mutex> lock(mutex);
+        stats.triggers++;
+        if (pending_reason) {
+            return;     // Same dump covers it
+        }
+        pending_reason = reason;
+        trigger_ns = steadyNs();
+        wake.notify_one();
+    }
+
+    void run() {
+        const auto& config = recorder.config_;
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            wake.wait(lock, [this] { return stopping || pending_reason; });
+            if (stopping) {
+                break;
+            }
+
+            auto now = Clock::now();
+            bool limited = stats.dumps >= config.max_dumps ||
+                           (last_dump != Clock::time_point{} &&
+                            now - last_dump < std::chrono::milliseconds(config.min_dump_interval_ms));
+            if (limited) {
+                stats.suppressed++;
+                pending_reason = nullptr;
+                continue;
+            }
+
+            // Keep recording what happens next; stopping cuts the wait short but still dumps
+            wake.wait_for(lock, std::chrono::milliseconds(config.post_trigger_ms), [this] { return stopping; });
+            const char* reason = pending_reason;
+            int64_t triggered_at = trigger_ns;
+            uint64_t dump_number = ++stats.dumps;
+            last_dump = Clock::now();
+            lock.unlock();
+
+            dump(reason, triggered_at, dump_number);
+
+            lock.lock();
+            pending_reason = nullptr;
+        }
+    }
+
+    // Oldest to newest, skipping slots overwritten while they were read
+    std::vector<FlightRecord> snapshot() const {
+        uint64_t head = recorder.head_.load(std::memory_order_acquire);
+        uint64_t capacity = recorder.mask_ + 1;
+        std::vector<FlightRecord> records;
+        records.reserve(std::min(head, capacity));
+        for (uint64_t index = head > capacity ? head - capacity : 0; index < head; ++index) {
+            const Slot& slot = recorder.slots_[index & recorder.mask_];
+            uint64_t before = slot.stamp.load(std::memory_order_acquire);
+            FlightRecord record = slot.record;
+            std::atomic_thread_fence(std::memory_order_acquire);
+            uint64_t after = slot.stamp.load(std::memory_order_relaxed);
+            if (before == after && before == index * 2 + 2) {
+                records.push_back(record);
+            }
+        }
+        return records;
+    }
+
+    void dump(const char* reason, int64_t triggered_at, uint64_t dump_number) {
+        std::vector<FlightRecord> records = snapshot();
+
+        char stamp[32];
+        std::time_t wall = std::time(nullptr);
+        std::strftime(stamp, sizeof(stamp), "%Y-%m-%d %H:%M:%S", std::localtime(&wall));
+
+        std::ostringstream out;
+        out << "=== Flight recorder dump " << dump_number << " at " << stamp << ": " << reason << " ("
+            << records.size() << " records, times relative to the trigger) ===\n";
+        char line[160];
+        for (const auto& record : records) {
+            std::snprintf(line, sizeof(line), "%+11.3f ms  %-12s seq %-8u rtp %-10u size %-7u value %-7d buf %-3d %s\n",
+                          (record.time_ns - triggered_at) / 1e6,
+                          eventName(static_cast<Event>(std::min<size_t>(record.event, EVENTS - 1))),
+                          record.sequence, record.rtp_timestamp, record.size, record.value, record.buffer,
+                          flagNames(record.flags).c_str());
+            out << line;
+        }
+
+        const auto& path = recorder.config_.dump_path;
+        if (!path.empty()) {
+            std::ofstream file(path, std::ios::app);
+            if (file) {
+                file << out.str();
+                std::cerr << "🛩️ Flight recorder: " << reason << ", " << records.size() << " records dumped to "
+                          << path << std::endl;
+                return;
+            }
+            std::cerr << "⚠️ WARNING: Cannot write flight recorder dump to " << path << std::endl;
+        }
+        std::cerr << out.str() << std::flush;
+    }
+
+    FlightRecorder& recorder;
+    std::thread thread;
+    mutable std::mutex mutex;
+    std::condition_variable wake;
+    bool stopping = false;
+    const char* pending_reason = nullptr;
+    int64_t trigger_ns = 0;
+    Clock::time_point last_dump{};
+    Statistics stats;
+};
+
+const char* FlightRecorder::eventName(Event event) {
+    switch (event) {
+        case Event::RECEIVED: return "received";
+        case Event::SUBMITTED: return "submitted";
+        case Event::DEQUEUED: return "dequeued";
+        case Event::DECODED: return "decoded";
+        case Event::DECODE_ERROR: return "decode-error";
+        case Event::DEVICE_ERROR: return "device-error";
+        case Event::RECOVERY: return "recovery";
+        case Event::STALL: return "stall";
+        case Event::STREAM_LOST: return "stream-lost";
+        case Event::IDLE: return "idle";
+    }
+    return "unknown";
+}
+
+FlightRecorder::FlightRecorder(const Config& config) : config_(config) {
+    uint64_t capacity = 1;
+    while (capacity < std::max<size_t>(config_.capacity, 2)) {
+        capacity <<= 1;
+    }
+    mask_ = capacity - 1;
+    slots_ = std::make_unique<Slot[]>(capacity);
+    impl_ = std::make_unique<Impl>(*this);
+    std::cout << "🛩️ Flight recorder: " << capacity << " records, dumps to "
+              << (config_.dump_path.empty() ? "stderr" : config_.dump_path) << std::endl;
+}
+
+FlightRecorder::~FlightRecorder() = default;
+
+void FlightRecorder::trigger(const char* reason) noexcept {
+    impl_->trigger(reason);
+}
+
+FlightRecorder::Statistics FlightRecorder::getStatistics() const {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    Statistics stats = impl_->stats;
+    stats.records = head_.load(std::memory_order_relaxed);
+    return stats;
+}
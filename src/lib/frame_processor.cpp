@@ -1,52 +1,74 @@
 #include "frame_processor.h"
-#include "drm_dmabuf_display.h"
 #include "dma_buffers_manager.h"
 #include <iostream>
 #include <algorithm> // Для std::min
+#include <chrono>
 
-FrameProcessor::FrameProcessor(
-    DrmDmaBufDisplayManager* display_manager,
-    DmaBuffersManager* output_buffers,
-    uint32_t& frame_width,
-    uint32_t& frame_height,
-    V4L2Decoder::DisplayType& display_type,
-    std::vector<bool>& zero_copy_initialized,
-    int& decoded_frame_count,
-    ZeroCopySetupCallback cb)
-    : display_manager_(display_manager),
-      output_buffers_(output_buffers),
-      frame_width_(frame_width),
-      frame_height_(frame_height),
-      display_type_(display_type),
-      zero_copy_initialized_(zero_copy_initialized),
-      decoded_frame_count_(decoded_frame_count),
-      zero_copy_setup_callback_(cb) {}
-
-bool FrameProcessor::processDecodedFrame(const v4l2_buffer& out_buf) {
+template <FrameDisplay Display>
+BasicFrameProcessor<Display>::BasicFrameProcessor(DmaBuffersManager* output_buffers)
+    : output_buffers_(output_buffers) {}
+
+template <FrameDisplay Display>
+bool BasicFrameProcessor<Display>::processDecodedFrame(const v4l2_buffer& out_buf) {
+    auto begin = std::chrono::steady_clock::now();
+    metrics_.accepted(held_buffers_.size());
     if (!validateOutputBuffer(out_buf)) {
+        metrics_.dropped();
         return true; // Return true to requeue the bad buffer
     }
 
-    const auto& out_plane = out_buf.m.planes[0];
     decoded_frame_count_++;
-    std::cout << "✅ Frame #" << decoded_frame_count_ << " (buffer " << out_buf.index 
-              << ", size: " << out_plane.bytesused << ")" << std::endl;
+#ifndef NDEBUG
+    // Per-frame trace, debug builds only
+    std::cout << "✅ Frame #" << decoded_frame_count_ << " (buffer " << out_buf.index
+              << ", size: " << out_buf.m.planes[0].bytesused << ")\n";
+#endif
+
+    if (display_ && frame_width_ > 0 && frame_height_ > 0) {
+        bool shown = displayFrame(out_buf);
+        metrics_.processed(std::chrono::nanoseconds(0), std::chrono::steady_clock::now() - begin);
+        if (shown) {
+            // On screen (or queued for the next flip): requeued once released
+            held_buffers_.push_back(out_buf.index);
+            return false;
+        }
+        std::cerr << "⚠️ Error displaying frame " << decoded_frame_count_ << std::endl;
+        metrics_.dropped();
+    }
 
-    // DEBUG: Check state before display
-    std::cout << "  [Debug] Check before display: display_manager=" 
-              << (display_manager_ ? "exists" : "null")
-              << ", width=" << frame_width_ << ", height=" << frame_height_ << std::endl;
+    return true; // Not displayed, requeue right away
+}
 
-    if (display_manager_ && frame_width_ > 0 && frame_height_ > 0) {
-        if (!displayFrame(out_buf)) {
-            std::cerr << "⚠️ Error displaying frame " << decoded_frame_count_ << std::endl;
+template <FrameDisplay Display>
+std::vector<unsigned int> BasicFrameProcessor<Display>::takeReleasedBuffers() {
+    std::vector<unsigned int> released;
+    if (!display_) {
+        return released;
+    }
+
+    for (int fd : display_->takeReleasedBuffers()) {
+        auto it = std::find_if(held_buffers_.begin(), held_buffers_.end(), [this, fd](unsigned int index) {
+            return index < output_buffers_->count() && output_buffers_->get_info(index).fd == fd;
+        });
+        if (it != held_buffers_.end()) {
+            released.push_back(*it);
+            held_buffers_.erase(it);
         }
     }
+    return released;
+}
 
-    return true; // Always return true to requeue the buffer
+template <FrameDisplay Display>
+void BasicFrameProcessor<Display>::resetHeldBuffers() {
+    held_buffers_.clear();
+    zero_copy_initialized_.clear();
+    if (display_) {
+        (void)display_->takeReleasedBuffers();
+    }
 }
 
-bool FrameProcessor::validateOutputBuffer(const v4l2_buffer& out_buf) const {
+template <FrameDisplay Display>
+bool BasicFrameProcessor<Display>::validateOutputBuffer(const v4l2_buffer& out_buf) const {
     if (out_buf.index >= output_buffers_->count()) {
         std::cerr << "❌ Invalid buffer index: " << out_buf.index 
                   << " >= " << output_buffers_->count() << std::endl;
@@ -66,11 +88,11 @@ bool FrameProcessor::validateOutputBuffer(const v4l2_buffer& out_buf) const {
     return true;
 }
 
-bool FrameProcessor::displayFrame(const v4l2_buffer& out_buf) {
-    std::cout << "FrameProcessor::displayFrame for buffer " << out_buf.index << std::endl;
+template <FrameDisplay Display>
+bool BasicFrameProcessor<Display>::displayFrame(const v4l2_buffer& out_buf) {
     const auto& out_plane = out_buf.m.planes[0];
     uint8_t* buffer = static_cast<uint8_t*>(output_buffers_->get_info(out_buf.index).mapped_addr);
-    size_t min_expected_size = frame_width_ * frame_height_ * 3 / 2;
+    size_t min_expected_size = DisplayBackend::i420Layout(frame_stride_, frame_height_).size;
 
     if (out_plane.bytesused < min_expected_size / 2) {
         std::cerr << "⚠️ Buffer " << out_buf.index << " is too small: " 
@@ -93,34 +115,58 @@ bool FrameProcessor::displayFrame(const v4l2_buffer& out_buf) {
         return false;
     }
 
-    DrmDmaBufDisplayManager::FrameInfo frame_info = {
+    DisplayBackend::FrameInfo frame_info = {
         output_buffers_->get_info(out_buf.index).mapped_addr,
         output_buffers_->get_info(out_buf.index).fd,
         frame_width_,
         frame_height_,
         V4L2_PIX_FMT_YUV420,
         out_plane.bytesused,
-        true
+        true,
+        frame_stride_
     };
 
-    if (display_type_ == V4L2Decoder::DisplayType::DRM_DMABUF) {
-        setupZeroCopyBuffer(out_buf.index);
-    }
+    setupZeroCopyBuffer(out_buf.index);
 
-    bool success = display_manager_->displayFrame(frame_info);
+    bool success = display_->displayFrame(frame_info);
     if (!success) {
-        std::cerr << "❌ display_manager_->displayFrame failed" << std::endl;
+        std::cerr << "❌ display_->displayFrame failed" << std::endl;
     }
     return success;
 }
 
-void FrameProcessor::setupZeroCopyBuffer(unsigned int index) {
+template <FrameDisplay Display>
+void BasicFrameProcessor<Display>::setupZeroCopyBuffer(unsigned int index) {
+    if (index >= output_buffers_->count()) {
+        return;
+    }
+    if (zero_copy_initialized_.size() != output_buffers_->count()) {
+        zero_copy_initialized_.assign(output_buffers_->count(), false);
+    }
+    if (zero_copy_initialized_[index]) {
+        return;
+    }
+
     std::cout << "FrameProcessor::setupZeroCopyBuffer for buffer " << index << std::endl;
-    if (zero_copy_setup_callback_) {
-        zero_copy_setup_callback_(index);
+    if (display_->setupZeroCopyBuffer(output_buffers_->get_info(index).fd, frame_width_, frame_height_,
+                                   frame_stride_)) {
+        zero_copy_initialized_[index] = true;
+        std::cout << "✅ Zero-copy buffer " << index << " configured" << std::endl;
     }
 }
 
-void FrameProcessor::setDisplayManager(DrmDmaBufDisplayManager* display_manager) {
-    display_manager_ = display_manager;
+template <FrameDisplay Display>
+void BasicFrameProcessor<Display>::setDisplay(Display* display) {
+    display_ = display;
+    zero_copy_initialized_.clear();
+}
+
+template <FrameDisplay Display>
+void BasicFrameProcessor<Display>::setFrameSize(uint32_t width, uint32_t height, uint32_t stride) {
+    frame_width_ = width;
+    frame_height_ = height;
+    frame_stride_ = stride ? stride : width;
 }
+
+template class BasicFrameProcessor<DisplayBackend>;
+template class BasicFrameProcessor<DrmDmaBufDisplayManager>;
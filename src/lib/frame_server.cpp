@@ -0,0 +1,398 @@
+#include "frame_server.h"
+#include "frame_server_protocol.h"
+#include "v4l2_decoder.h"
+#include <iostream>
+#include <cstring>
+#include <cerrno>
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <new>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/mman.h>
+#include <sys/eventfd.h>
+
+namespace {
+
+constexpr int POLL_INTERVAL_MS = 100;
+
+// Send one message, optionally passing fds along; never blocks
+bool sendMessage(int socket_fd, const void* message, size_t size, const int* fds = nullptr, size_t fd_count = 0) {
+    iovec iov = {};
+    iov.iov_base = const_cast<void*>(message);
+    iov.iov_len = size;
+
+    msghdr msg = {};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+
+    alignas(cmsghdr) char control[CMSG_SPACE(2 * sizeof(int))] = {};
+    if (fd_count > 0) {
+        msg.msg_control = control;
+        msg.msg_controllen = CMSG_SPACE(fd_count * sizeof(int));
+        cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+        cmsg->cmsg_level = SOL_SOCKET;
+        cmsg->cmsg_type = SCM_RIGHTS;
+        cmsg->cmsg_len = CMSG_LEN(fd_count * sizeof(int));
+        std::memcpy(CMSG_DATA(cmsg), fds, fd_count * sizeof(int));
+    }
+
+    return sendmsg(socket_fd, &msg, MSG_DONTWAIT | MSG_NOSIGNAL) == static_cast<ssize_t>(size);
+}
+
+} // namespace
+
+class FrameServer::Impl {
+public:
+    struct HeldFrame {
+        DecodedFrameRef frame;
+        std::chrono::steady_clock::time_point since;
+    };
+
+    struct Subscriber {
+        int socket_fd = -1;
+        int event_fd = -1;
+        frame_server::FrameRing* ring = nullptr;
+        std::map<uint64_t, HeldFrame> held;         // By frame_id
+        std::vector<uint32_t> announced;            // Buffer generation + 1 per index, 0 = not yet sent
+        bool broken = false;                        // Socket failed; removed by the server thread
+
+        ~Subscriber() {
+            if (ring) {
+                munmap(ring, sizeof(frame_server::FrameRing));
+            }
+            if (event_fd >= 0) {
+                close(event_fd);
+            }
+            if (socket_fd >= 0) {
+                close(socket_fd);
+            }
+        }
+    };
+
+    Config config;
+    int listen_fd = -1;
+    int wake_fd = -1;
+    V4L2Decoder* decoder = nullptr;
+    int consumer_id = 0;
+
+    std::thread thread;
+    std::atomic<bool> running{false};
+    mutable std::mutex mutex;
+    std::vector<std::unique_ptr<Subscriber>> subscribers;
+    uint64_t next_frame_id = 1;
+    Statistics stats;
+
+    [[nodiscard]] bool initialize() {
+        sockaddr_un addr = {};
+        addr.sun_family = AF_UNIX;
+        if (config.socket_path.empty() || config.socket_path.size() >= sizeof(addr.sun_path)) {
+            std::cerr << "❌ Invalid frame server socket path: " << config.socket_path << std::endl;
+            return false;
+        }
+        std::memcpy(addr.sun_path, config.socket_path.c_str(), config.socket_path.size());
+
+        listen_fd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (listen_fd < 0) {
+            std::cerr << "❌ Frame server socket: " << strerror(errno) << std::endl;
+            return false;
+        }
+
+        unlink(config.socket_path.c_str());    // Left over from a previous run
+        if (bind(listen_fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 || listen(listen_fd, 8) < 0) {
+            std::cerr << "❌ Frame server bind/listen on " << config.socket_path << ": " << strerror(errno) << std::endl;
+            close(listen_fd);
+            listen_fd = -1;
+            return false;
+        }
+
+        wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (wake_fd < 0) {
+            std::cerr << "❌ Frame server eventfd: " << strerror(errno) << std::endl;
+            return false;
+        }
+
+        std::cout << "✅ Frame server listening on " << config.socket_path << std::endl;
+        return true;
+    }
+
+    [[nodiscard]] bool start(V4L2Decoder& target) {
+        if (listen_fd < 0 || running) {
+            return false;
+        }
+        decoder = &target;
+        running = true;
+        thread = std::thread(&Impl::serve, this);
+        pipeline::setThreadName(thread, "frame-server");
+        consumer_id = decoder->addFrameConsumer([this](const DecodedFrameRef& frame) { publish(frame); });
+        return true;
+    }
+
+    void stop() noexcept {
+        if (decoder) {
+            decoder->removeFrameConsumer(consumer_id);
+            decoder = nullptr;
+        }
+        if (running.exchange(false)) {
+            uint64_t one = 1;
+            (void)!write(wake_fd, &one, sizeof(one));
+        }
+        if (thread.joinable()) {
+            thread.join();
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            subscribers.clear();
+        }
+        if (listen_fd >= 0) {
+            close(listen_fd);
+            listen_fd = -1;
+            unlink(config.socket_path.c_str());
+        }
+        if (wake_fd >= 0) {
+            close(wake_fd);
+            wake_fd = -1;
+        }
+    }
+
+    // Decoder thread: hand the frame to every subscriber that has room for it
+    void publish(const DecodedFrameRef& frame) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (subscribers.empty()) {
+            return;
+        }
+
+        uint64_t frame_id = next_frame_id++;
+        auto now = std::chrono::steady_clock::now();
+        for (auto& sub : subscribers) {
+            if (sub->broken) {
+                continue;
+            }
+
+            frame_server::FrameRing& ring = *sub->ring;
+            uint64_t head = ring.head.load(std::memory_order_relaxed);
+            uint64_t tail = ring.tail.load(std::memory_order_acquire);
+            if (sub->held.size() >= config.max_held_frames || head - tail >= frame_server::RING_SLOTS ||
+                !announceBuffer(*sub, *frame)) {
+                stats.dropped++;
+                continue;
+            }
+
+            frame_server::FrameSlot& slot = ring.slots[head & (frame_server::RING_SLOTS - 1)];
+            slot.frame_id = frame_id;
+            slot.sequence = frame->sequence;
+            slot.timestamp_us = frame->timestamp.count();
+            slot.decoded_at_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                frame->decoded_at.time_since_epoch()).count();
+            slot.size = frame->size;
+            slot.buffer_index = frame->buffer_index;
+            slot.buffer_generation = frame->buffer_generation;
+            ring.head.store(head + 1, std::memory_order_release);
+
+            sub->held.emplace(frame_id, HeldFrame{frame, now});
+            uint64_t one = 1;
+            (void)!write(sub->event_fd, &one, sizeof(one));
+            stats.published++;
+        }
+    }
+
+    // Pass the buffer's dma-buf the first time the subscriber sees it
+    [[nodiscard]] bool announceBuffer(Subscriber& sub, const DecodedFrame& frame) {
+        if (frame.buffer_index >= sub.announced.size()) {
+            sub.announced.resize(frame.buffer_index + 1, 0);
+        }
+        if (sub.announced[frame.buffer_index] == frame.buffer_generation + 1) {
+            return true;
+        }
+
+        frame_server::BufferAnnounce announce;
+        announce.buffer_index = frame.buffer_index;
+        announce.buffer_generation = frame.buffer_generation;
+        announce.width = frame.width;
+        announce.height = frame.height;
+        announce.format = frame.format;
+        announce.stride = frame.stride;
+        if (!sendMessage(sub.socket_fd, &announce, sizeof(announce), &frame.dma_fd, 1)) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                sub.broken = true;
+            }
+            return false;
+        }
+        sub.announced[frame.buffer_index] = frame.buffer_generation + 1;
+        return true;
+    }
+
+    void serve() {
+        std::vector<pollfd> fds;
+        while (running) {
+            fds.clear();
+            fds.push_back({wake_fd, POLLIN, 0});
+            fds.push_back({listen_fd, POLLIN, 0});
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                for (const auto& sub : subscribers) {
+                    fds.push_back({sub->socket_fd, POLLIN, 0});
+                }
+            }
+
+            if (poll(fds.data(), fds.size(), POLL_INTERVAL_MS) < 0 && errno != EINTR) {
+                std::cerr << "❌ Frame server poll: " << strerror(errno) << std::endl;
+                break;
+            }
+
+            if (fds[1].revents & POLLIN) {
+                acceptSubscriber();
+            }
+            for (size_t i = 2; i < fds.size(); ++i) {
+                if (fds[i].revents) {
+                    readReleases(fds[i].fd);
+                }
+            }
+            dropStaleSubscribers();
+        }
+    }
+
+    void acceptSubscriber() {
+        int fd = accept4(listen_fd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            return;
+        }
+
+        auto sub = std::make_unique<Subscriber>();
+        sub->socket_fd = fd;
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (subscribers.size() >= config.max_subscribers) {
+                std::cerr << "⚠️ Frame server: subscriber limit (" << config.max_subscribers << ") reached" << std::endl;
+                return;
+            }
+        }
+
+        int ring_fd = memfd_create("rtp_player-frame-ring", MFD_CLOEXEC);
+        if (ring_fd < 0 || ftruncate(ring_fd, sizeof(frame_server::FrameRing)) < 0) {
+            std::cerr << "❌ Frame server ring: " << strerror(errno) << std::endl;
+            if (ring_fd >= 0) {
+                close(ring_fd);
+            }
+            return;
+        }
+        void* ring = mmap(nullptr, sizeof(frame_server::FrameRing), PROT_READ | PROT_WRITE, MAP_SHARED, ring_fd, 0);
+        if (ring == MAP_FAILED) {
+            std::cerr << "❌ Frame server ring mmap: " << strerror(errno) << std::endl;
+            close(ring_fd);
+            return;
+        }
+        sub->ring = new (ring) frame_server::FrameRing();
+
+        sub->event_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (sub->event_fd < 0) {
+            close(ring_fd);
+            return;
+        }
+
+        frame_server::Hello hello;
+        hello.max_held_frames = config.max_held_frames;
+        int hello_fds[2] = {ring_fd, sub->event_fd};
+        bool sent = sendMessage(fd, &hello, sizeof(hello), hello_fds, 2);
+        close(ring_fd);
+        if (!sent) {
+            std::cerr << "❌ Frame server hello: " << strerror(errno) << std::endl;
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        subscribers.push_back(std::move(sub));
+        stats.subscribers = static_cast<uint32_t>(subscribers.size());
+        std::cout << "🔌 Frame server: subscriber connected (" << subscribers.size() << " total)" << std::endl;
+    }
+
+    void readReleases(int fd) {
+        frame_server::Release release;
+        while (true) {
+            ssize_t n = recv(fd, &release, sizeof(release), MSG_DONTWAIT);
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) {
+                return;
+            }
+
+            std::lock_guard<std::mutex> lock(mutex);
+            auto it = std::find_if(subscribers.begin(), subscribers.end(),
+                                   [fd](const auto& sub) { return sub->socket_fd == fd; });
+            if (it == subscribers.end()) {
+                return;
+            }
+            if (n <= 0) {
+                (*it)->broken = true;
+                return;
+            }
+            if (n == sizeof(release) && release.type == frame_server::MessageType::RELEASE) {
+                (*it)->held.erase(release.frame_id);
+            }
+        }
+    }
+
+    // Remove subscribers that went away or sat on a frame for too long
+    void dropStaleSubscribers() {
+        auto now = std::chrono::steady_clock::now();
+        auto timeout = std::chrono::milliseconds(config.hold_timeout_ms);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        size_t before = subscribers.size();
+        std::erase_if(subscribers, [&](const auto& sub) {
+            if (sub->broken) {
+                return true;
+            }
+            for (const auto& [id, held] : sub->held) {
+                if (now - held.since > timeout) {
+                    std::cerr << "⚠️ Frame server: subscriber held frame " << id << " for more than "
+                              << config.hold_timeout_ms << " ms, disconnecting" << std::endl;
+                    stats.disconnected++;
+                    return true;
+                }
+            }
+            return false;
+        });
+
+        if (subscribers.size() != before) {
+            stats.subscribers = static_cast<uint32_t>(subscribers.size());
+            std::cout << "🔌 Frame server: subscriber left (" << subscribers.size() << " total)" << std::endl;
+        }
+    }
+};
+
+FrameServer::FrameServer(const Config& config) : impl_(std::make_unique<Impl>()) {
+    impl_->config = config;
+}
+
+FrameServer::~FrameServer() {
+    impl_->stop();
+}
+
+bool FrameServer::initialize() {
+    return impl_->initialize();
+}
+
+bool FrameServer::start(V4L2Decoder& decoder) {
+    return impl_->start(decoder);
+}
+
+void FrameServer::stop() noexcept {
+    impl_->stop();
+}
+
+uint32_t FrameServer::maxHeldBuffers() const noexcept {
+    return impl_->config.max_subscribers * impl_->config.max_held_frames;
+}
+
+FrameServer::Statistics FrameServer::getStatistics() const {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    return impl_->stats;
+}
@@ -0,0 +1,225 @@
+/**
+ * @file h264_depacketizer.cpp
+ * @brief Implementation of the RFC 6184 H.264 RTP depacketizer
+ */
+
+#include "h264_depacketizer.h"
+#include <iostream>
+
+namespace {
+
+constexpr uint8_t NAL_TYPE_STAP_A = 24;
+constexpr uint8_t NAL_TYPE_FU_A = 28;
+constexpr uint8_t START_CODE[4] = {0x00, 0x00, 0x00, 0x01};
+
+// RFC 3550 A.1: larger sequence jumps mean the sender restarted
+constexpr int MAX_DROPOUT = 3000;
+constexpr int MAX_MISORDER = 100;
+
+} // namespace
+
+bool H264Depacketizer::parseRtpHeader(const uint8_t* data, size_t size, RtpPacketInfo& info) {
+    if (!data || size < 12) {
+        return false;
+    }
+    if ((data[0] >> 6) != 2) {
+        return false;
+    }
+
+    bool padding = data[0] & 0x20;
+    bool extension = data[0] & 0x10;
+    size_t csrc_count = data[0] & 0x0F;
+
+    info.marker = data[1] & 0x80;
+    info.payload_type = data[1] & 0x7F;
+    info.seq = static_cast<uint16_t>((data[2] << 8) | data[3]);
+    info.timestamp = (static_cast<uint32_t>(data[4]) << 24) | (static_cast<uint32_t>(data[5]) << 16) |
+                     (static_cast<uint32_t>(data[6]) << 8) | data[7];
+    info.ssrc = (static_cast<uint32_t>(data[8]) << 24) | (static_cast<uint32_t>(data[9]) << 16) |
+                (static_cast<uint32_t>(data[10]) << 8) | data[11];
+
+    size_t offset = 12 + csrc_count * 4;
+    if (offset > size) {
+        return false;
+    }
+
+    info.extension = nullptr;
+    info.extension_length = 0;
+    info.extension_profile = 0;
+    if (extension) {
+        if (offset + 4 > size) {
+            return false;
+        }
+        info.extension_profile = static_cast<uint16_t>((data[offset] << 8) | data[offset + 1]);
+        size_t ext_words = static_cast<size_t>((data[offset + 2] << 8) | data[offset + 3]);
+        offset += 4;
+        if (offset + ext_words * 4 > size) {
+            return false;
+        }
+        info.extension = data + offset;
+        info.extension_length = ext_words * 4;
+        offset += ext_words * 4;
+    }
+
+    size_t end = size;
+    if (padding) {
+        uint8_t pad = data[size - 1];
+        if (pad == 0 || offset + pad > size) {
+            return false;
+        }
+        end -= pad;
+    }
+
+    info.payload = data + offset;
+    info.payload_length = end - offset;
+    return true;
+}
+
+bool H264Depacketizer::pushPacket(const uint8_t* data, size_t size) {
+    RtpPacketInfo info;
+    if (!parseRtpHeader(data, size, info)) {
+        return false;
+    }
+    return pushPacket(info);
+}
+
+bool H264Depacketizer::pushPacket(const RtpPacketInfo& packet) {
+    if (payload_type_ >= 0 && packet.payload_type != payload_type_) {
+        return false;
+    }
+    if (packet.payload_length == 0) {
+        return false;
+    }
+
+    stats_.packets_received++;
+    stats_.bytes_received += packet.payload_length;
+
+    // A new SSRC or an implausible jump is a new stream, not packet loss
+    if (have_seq_) {
+        int gap = static_cast<int16_t>(packet.seq - expected_seq_);
+        if (packet.ssrc != ssrc_ || gap > MAX_DROPOUT || gap < -MAX_MISORDER) {
+            current_.reset();
+            fu_active_ = false;
+            have_seq_ = false;
+            discontinuity_ = true;
+            stats_.stream_restarts++;
+        }
+    }
+    ssrc_ = packet.ssrc;
+
+    // Sequence tracking: a gap invalidates any fragmented NAL in progress
+    if (have_seq_ && packet.seq != expected_seq_) {
+        int16_t gap = static_cast<int16_t>(packet.seq - expected_seq_);
+        if (gap > 0) {
+            stats_.packets_lost += gap;
+        }
+        if (fu_active_) {
+            // Drop the truncated NAL; the decoder would see it as a corrupt slice
+            dropFragment();
+            stats_.frames_dropped++;
+        }
+    }
+    have_seq_ = true;
+    expected_seq_ = static_cast<uint16_t>(packet.seq + 1);
+
+    // A new timestamp starts a new access unit even if the marker bit was lost
+    if (current_ && packet.timestamp != current_timestamp_) {
+        flushAccessUnit();
+    }
+    if (!current_) {
+        current_ = std::make_unique<H264Frame>();
+        current_->timestamp = packet.timestamp;
+        current_->ssrc = packet.ssrc;
+        current_->discontinuity = discontinuity_;
+        discontinuity_ = false;
+        current_timestamp_ = packet.timestamp;
+    }
+
+    const uint8_t* payload = packet.payload;
+    size_t length = packet.payload_length;
+    uint8_t nal_type = payload[0] & 0x1F;
+
+    if (nal_type >= 1 && nal_type <= 23) {
+        appendNal(payload, length);
+    } else if (nal_type == NAL_TYPE_STAP_A) {
+        size_t offset = 1;
+        while (offset + 2 <= length) {
+            size_t nal_size = static_cast<size_t>((payload[offset] << 8) | payload[offset + 1]);
+            offset += 2;
+            if (nal_size == 0 || offset + nal_size > length) {
+                break;
+            }
+            appendNal(payload + offset, nal_size);
+            offset += nal_size;
+        }
+    } else if (nal_type == NAL_TYPE_FU_A) {
+        if (length < 2) {
+            return false;
+        }
+        uint8_t fu_header = payload[1];
+        bool start = fu_header & 0x80;
+        bool end = fu_header & 0x40;
+
+        if (start) {
+            uint8_t nal_header = static_cast<uint8_t>((payload[0] & 0xE0) | (fu_header & 0x1F));
+            if (fu_active_) {
+                dropFragment();     // The previous fragmented NAL never ended
+            }
+            fu_start_ = current_->data.size();
+            current_->data.insert(current_->data.end(), START_CODE, START_CODE + sizeof(START_CODE));
+            current_->data.push_back(nal_header);
+            fu_active_ = true;
+        }
+        if (fu_active_) {
+            current_->data.insert(current_->data.end(), payload + 2, payload + length);
+        }
+        if (end) {
+            fu_active_ = false;
+        }
+    } else {
+        // STAP-B, MTAP and FU-B are not used in non-interleaved mode
+        return false;
+    }
+
+    if (packet.marker) {
+        flushAccessUnit();
+    }
+    return true;
+}
+
+void H264Depacketizer::appendNal(const uint8_t* nal, size_t size) {
+    current_->data.insert(current_->data.end(), START_CODE, START_CODE + sizeof(START_CODE));
+    current_->data.insert(current_->data.end(), nal, nal + size);
+}
+
+void H264Depacketizer::dropFragment() {
+    if (fu_active_ && current_ && fu_start_ <= current_->data.size()) {
+        current_->data.resize(fu_start_);
+    }
+    fu_active_ = false;
+}
+
+void H264Depacketizer::flushAccessUnit() {
+    // A fragmented NAL still open lost its end (and the marker)
+    dropFragment();
+    if (!current_) {
+        return;
+    }
+    if (current_->data.empty()) {
+        current_.reset();
+        return;
+    }
+
+    stats_.frames_completed++;
+    if (frame_callback_) {
+        frame_callback_(std::move(current_));
+    }
+    current_.reset();
+}
+
+void H264Depacketizer::reset() {
+    current_.reset();
+    fu_active_ = false;
+    have_seq_ = false;
+    discontinuity_ = false;
+}
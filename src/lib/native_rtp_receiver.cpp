@@ -0,0 +1,334 @@
+/**
+ * @file native_rtp_receiver.cpp
+ * @brief Implementation of the native socket / AF_XDP RTP receiver
+ */
+
+#include "native_rtp_receiver.h"
+#include "af_xdp_socket.h"
+#include "transport_feedback.h"
+#include "pipeline.h"
+#include <iostream>
+#include <cstring>
+#include <algorithm>
+#include <cerrno>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/udp.h>
+#include <arpa/inet.h>
+
+#ifndef UDP_GRO
+#define UDP_GRO 104
+#endif
+
+#ifndef RTP_PLAYER_XDP_OBJECT_PATH
+#define RTP_PLAYER_XDP_OBJECT_PATH "xdp_rtp_steer.bpf.o"
+#endif
+
+namespace {
+
+constexpr size_t CONTROL_SIZE = CMSG_SPACE(sizeof(int));
+
+// Segment size of a GRO super-packet, 0 if the datagram was not coalesced
+size_t groSegmentSize(const msghdr& msg) {
+    for (cmsghdr* cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(const_cast<msghdr*>(&msg), cmsg)) {
+        if (cmsg->cmsg_level == IPPROTO_UDP && cmsg->cmsg_type == UDP_GRO) {
+            int segment_size = 0;
+            std::memcpy(&segment_size, CMSG_DATA(cmsg), sizeof(segment_size));
+            return segment_size > 0 ? static_cast<size_t>(segment_size) : 0;
+        }
+    }
+    return 0;
+}
+
+} // namespace
+
+NativeRTPReceiver::NativeRTPReceiver(const Config& config)
+    : config_(config), running_(false), initialized_(false) {}
+
+NativeRTPReceiver::~NativeRTPReceiver() {
+    stop();
+    if (socket_fd_ >= 0) {
+        close(socket_fd_);
+        socket_fd_ = -1;
+    }
+}
+
+bool NativeRTPReceiver::initializeSocket() {
+    // Left over from an initialize() that failed halfway
+    if (socket_fd_ >= 0) {
+        close(socket_fd_);
+    }
+    socket_fd_ = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (socket_fd_ < 0) {
+        std::cerr << "Native receiver: socket error: " << strerror(errno) << std::endl;
+        return false;
+    }
+
+    int one = 1;
+    setsockopt(socket_fd_, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+    // A large receive buffer absorbs IDR bursts while the thread is descheduled
+    int rcvbuf = config_.socket_receive_buffer;
+    if (setsockopt(socket_fd_, SOL_SOCKET, SO_RCVBUFFORCE, &rcvbuf, sizeof(rcvbuf)) < 0) {
+        setsockopt(socket_fd_, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+    }
+
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(config_.local_port);
+    if (inet_pton(AF_INET, config_.local_ip.c_str(), &addr.sin_addr) != 1) {
+        std::cerr << "Native receiver: invalid address " << config_.local_ip << std::endl;
+        return false;
+    }
+    if (bind(socket_fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+        std::cerr << "Native receiver: bind to " << config_.local_ip << ":" << config_.local_port
+                  << " failed: " << strerror(errno) << std::endl;
+        return false;
+    }
+
+    // Coalesced super-packets need room for up to 64 KiB per message
+    if (config_.enable_gro) {
+        if (setsockopt(socket_fd_, IPPROTO_UDP, UDP_GRO, &one, sizeof(one)) == 0) {
+            gro_enabled_ = true;
+        } else {
+            std::cerr << "⚠️ WARNING: UDP_GRO not available (" << strerror(errno) << ")" << std::endl;
+        }
+    }
+    batch_size_ = gro_enabled_ ? GRO_BATCH_SIZE : BATCH_SIZE;
+    slot_size_ = gro_enabled_ ? MAX_GRO_PACKET_SIZE : MAX_PACKET_SIZE;
+
+    batch_buffers_.resize(batch_size_ * slot_size_);
+    control_buffers_.resize(batch_size_ * CONTROL_SIZE);
+    return true;
+}
+
+bool NativeRTPReceiver::initialize() {
+    if (!initializeSocket()) {
+        return false;
+    }
+    active_backend_ = Backend::SOCKET;
+
+    if (config_.backend == Backend::XDP) {
+#ifdef RTP_PLAYER_ENABLE_AF_XDP
+        AfXdpSocket::Config xdp_config;
+        xdp_config.interface = config_.xdp_interface;
+        xdp_config.queue_id = config_.xdp_queue;
+        xdp_config.udp_port = config_.local_port;
+        xdp_config.object_path = config_.xdp_object_path.empty() ? RTP_PLAYER_XDP_OBJECT_PATH
+                                                                 : config_.xdp_object_path;
+        xdp_socket_ = std::make_unique<AfXdpSocket>(xdp_config);
+        if (xdp_socket_->open()) {
+            active_backend_ = Backend::XDP;
+        } else {
+            std::cerr << "⚠️ WARNING: AF_XDP setup failed, falling back to the socket path" << std::endl;
+            xdp_socket_.reset();
+        }
+#else
+        std::cerr << "⚠️ WARNING: AF_XDP support not compiled in (configure with -DRTP_PLAYER_ENABLE_AF_XDP=ON), "
+                  << "using the socket path" << std::endl;
+#endif
+    }
+
+    initialized_ = true;
+    std::cout << "Native RTP receiver initialized on " << config_.local_ip << ":" << config_.local_port
+              << " (" << (active_backend_ == Backend::XDP ? "AF_XDP on " + config_.xdp_interface : "socket")
+              << (gro_enabled_ ? ", UDP GRO" : "") << ")" << std::endl;
+    return true;
+}
+
+// Completed frames go from the depacketizer straight to the callback
+void NativeRTPReceiver::setFrameCallback(FrameCallback callback) {
+    depacketizer_.setFrameCallback(std::move(callback));
+}
+
+void NativeRTPReceiver::setTransportFeedback(TransportFeedback* feedback) {
+    transport_feedback_ = feedback;
+}
+
+bool NativeRTPReceiver::start() {
+    if (!initialized_) {
+        std::cerr << "NativeRTPReceiver not initialized" << std::endl;
+        return false;
+    }
+    if (running_) {
+        return true;
+    }
+
+    // stop() wakes the thread through this fd, so an idle link costs no wakeups
+    wake_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (wake_fd_ < 0) {
+        std::cerr << "Native receiver: eventfd error: " << strerror(errno) << std::endl;
+        return false;
+    }
+
+    running_ = true;
+    receive_thread_ = std::thread(&NativeRTPReceiver::receiveLoop, this);
+    pipeline::setThreadName(receive_thread_, "rtp-rx");
+    std::cout << "Native RTP receiver started" << std::endl;
+    return true;
+}
+
+void NativeRTPReceiver::stop() {
+    if (!running_) {
+        return;
+    }
+    running_ = false;
+    uint64_t one = 1;
+    (void)!write(wake_fd_, &one, sizeof(one));
+    if (receive_thread_.joinable()) {
+        receive_thread_.join();
+    }
+    close(wake_fd_);
+    wake_fd_ = -1;
+    if (xdp_socket_) {
+        xdp_socket_->close();
+        xdp_socket_.reset();
+    }
+    // Everything initialize() set up is released, so it can bind the port again
+    if (socket_fd_ >= 0) {
+        close(socket_fd_);
+        socket_fd_ = -1;
+    }
+    initialized_ = false;
+    std::cout << "Native RTP receiver stopped" << std::endl;
+}
+
+void NativeRTPReceiver::receiveLoop() {
+    pollfd fds[3] = {};
+    nfds_t nfds = 2;
+    fds[0].fd = socket_fd_;
+    fds[0].events = POLLIN;
+    fds[1].fd = wake_fd_;
+    fds[1].events = POLLIN;
+    if (xdp_socket_) {
+        fds[2].fd = xdp_socket_->fd();
+        fds[2].events = POLLIN;
+        nfds = 3;
+    }
+
+    while (running_) {
+        int ret = ::poll(fds, nfds, -1);
+        if (ret < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            std::cerr << "Native receiver: poll error: " << strerror(errno) << std::endl;
+            break;
+        }
+        if (ret == 0) {
+            continue;
+        }
+
+        if (nfds == 3 && (fds[2].revents & POLLIN)) {
+            auto arrival = std::chrono::steady_clock::now();
+            xdp_socket_->receive([this, arrival](const uint8_t* payload, size_t size) {
+                handlePacket(payload, size, arrival);
+            });
+        }
+        if (fds[0].revents & POLLIN) {
+            drainSocket();
+        }
+
+        publishStatistics();
+    }
+}
+
+void NativeRTPReceiver::drainSocket() {
+    mmsghdr msgs[BATCH_SIZE];
+    iovec iovecs[BATCH_SIZE];
+
+    while (running_) {
+        std::memset(msgs, 0, sizeof(msgs));
+        for (size_t i = 0; i < batch_size_; ++i) {
+            iovecs[i].iov_base = batch_buffers_.data() + i * slot_size_;
+            iovecs[i].iov_len = slot_size_;
+            msgs[i].msg_hdr.msg_iov = &iovecs[i];
+            msgs[i].msg_hdr.msg_iovlen = 1;
+            if (gro_enabled_) {
+                msgs[i].msg_hdr.msg_control = control_buffers_.data() + i * CONTROL_SIZE;
+                msgs[i].msg_hdr.msg_controllen = CONTROL_SIZE;
+            }
+        }
+
+        int count = recvmmsg(socket_fd_, msgs, static_cast<unsigned int>(batch_size_), MSG_DONTWAIT, nullptr);
+        if (count < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                std::cerr << "Native receiver: recvmmsg error: " << strerror(errno) << std::endl;
+            }
+            return;
+        }
+
+        auto arrival = std::chrono::steady_clock::now();
+        for (int i = 0; i < count; ++i) {
+            if (msgs[i].msg_hdr.msg_flags & MSG_TRUNC) {
+                continue;
+            }
+            size_t segment_size = gro_enabled_ ? groSegmentSize(msgs[i].msg_hdr) : 0;
+            handleDatagram(static_cast<const uint8_t*>(iovecs[i].iov_base), msgs[i].msg_len, segment_size, arrival);
+        }
+
+        if (static_cast<size_t>(count) < batch_size_) {
+            return;
+        }
+    }
+}
+
+void NativeRTPReceiver::handleDatagram(const uint8_t* data, size_t size, size_t segment_size,
+                                       std::chrono::steady_clock::time_point arrival) {
+    if (segment_size == 0 || segment_size >= size) {
+        handlePacket(data, size, arrival);
+        return;
+    }
+
+    // A GRO super-packet: equal-sized segments, only the last one may be shorter
+    for (size_t offset = 0; offset < size; offset += segment_size) {
+        handlePacket(data + offset, std::min(segment_size, size - offset), arrival);
+    }
+}
+
+void NativeRTPReceiver::handlePacket(const uint8_t* data, size_t size, std::chrono::steady_clock::time_point arrival) {
+    H264Depacketizer::RtpPacketInfo packet;
+    if (!H264Depacketizer::parseRtpHeader(data, size, packet)) {
+        return;
+    }
+
+    // Per-packet arrival for TWCC: this path sees every packet, unlike uvgRTP's frame hook
+    if (transport_feedback_ && packet.extension) {
+        uint16_t transport_seq = 0;
+        if (TransportFeedback::parseTransportSequence(packet.extension_profile, packet.extension,
+                                                      packet.extension_length, transport_feedback_->extensionId(),
+                                                      transport_seq)) {
+            transport_feedback_->onPacketArrival(transport_seq, packet.ssrc, packet.timestamp, size, arrival);
+        }
+    }
+
+    (void)depacketizer_.pushPacket(packet);
+}
+
+void NativeRTPReceiver::publishStatistics() {
+    if (reset_statistics_.exchange(false)) {
+        depacketizer_.resetStatistics();
+    }
+    const auto& depacketizer_stats = depacketizer_.getStatistics();
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    stats_.packets_received = depacketizer_stats.packets_received;
+    stats_.bytes_received = depacketizer_stats.bytes_received;
+    stats_.frames_completed = depacketizer_stats.frames_completed;
+    stats_.packets_lost = depacketizer_stats.packets_lost;
+    stats_.frames_dropped = depacketizer_stats.frames_dropped;
+}
+
+NativeRTPReceiver::Statistics NativeRTPReceiver::getStatistics() const {
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    return stats_;
+}
+
+void NativeRTPReceiver::resetStatistics() {
+    // The depacketizer counters belong to the receive thread, which clears them
+    reset_statistics_ = true;
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    stats_ = Statistics{};
+}
@@ -0,0 +1,535 @@
+#include "osd_overlay.h"
+#include "pipeline.h"
+#include <iostream>
+#include <cstring>
+#include <cerrno>
+#include <cctype>
+#include <algorithm>
+#include <utility>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <sys/mman.h>
+#include <xf86drm.h>
+#include <xf86drmMode.h>
+#include <drm_fourcc.h>
+
+namespace {
+
+constexpr uint32_t GLYPH_WIDTH = 5;
+constexpr uint32_t GLYPH_HEIGHT = 7;
+constexpr uint32_t CELL_WIDTH = GLYPH_WIDTH + 1;
+constexpr uint32_t CELL_HEIGHT = GLYPH_HEIGHT + 2;
+constexpr uint32_t PADDING = 4;
+
+struct Glyph {
+    char c;
+    uint8_t rows[GLYPH_HEIGHT];  // Bit 4 is the leftmost column
+};
+
+// 5x7 font covering what telemetry text needs; lowercase maps to uppercase
+constexpr Glyph FONT[] = {
+    {' ', {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}},
+    {'0', {0x0E, 0x11, 0x13, 0x15, 0x19, 0x11, 0x0E}},
+    {'1', {0x04, 0x0C, 0x04, 0x04, 0x04, 0x04, 0x0E}},
+    {'2', {0x0E, 0x11, 0x01, 0x02, 0x04, 0x08, 0x1F}},
+    {'3', {0x1F, 0x02, 0x04, 0x02, 0x01, 0x11, 0x0E}},
+    {'4', {0x02, 0x06, 0x0A, 0x12, 0x1F, 0x02, 0x02}},
+    {'5', {0x1F, 0x10, 0x1E, 0x01, 0x01, 0x11, 0x0E}},
+    {'6', {0x06, 0x08, 0x10, 0x1E, 0x11, 0x11, 0x0E}},
+    {'7', {0x1F, 0x01, 0x02, 0x04, 0x08, 0x08, 0x08}},
+    {'8', {0x0E, 0x11, 0x11, 0x0E, 0x11, 0x11, 0x0E}},
+    {'9', {0x0E, 0x11, 0x11, 0x0F, 0x01, 0x02, 0x0C}},
+    {'A', {0x0E, 0x11, 0x11, 0x11, 0x1F, 0x11, 0x11}},
+    {'B', {0x1E, 0x11, 0x11, 0x1E, 0x11, 0x11, 0x1E}},
+    {'C', {0x0E, 0x11, 0x10, 0x10, 0x10, 0x11, 0x0E}},
+    {'D', {0x1C, 0x12, 0x11, 0x11, 0x11, 0x12, 0x1C}},
+    {'E', {0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x1F}},
+    {'F', {0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x10}},
+    {'G', {0x0E, 0x11, 0x10, 0x17, 0x11, 0x11, 0x0F}},
+    {'H', {0x11, 0x11, 0x11, 0x1F, 0x11, 0x11, 0x11}},
+    {'I', {0x0E, 0x04, 0x04, 0x04, 0x04, 0x04, 0x0E}},
+    {'J', {0x07, 0x02, 0x02, 0x02, 0x02, 0x12, 0x0C}},
+    {'K', {0x11, 0x12, 0x14, 0x18, 0x14, 0x12, 0x11}},
+    {'L', {0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x1F}},
+    {'M', {0x11, 0x1B, 0x15, 0x15, 0x11, 0x11, 0x11}},
+    {'N', {0x11, 0x11, 0x19, 0x15, 0x13, 0x11, 0x11}},
+    {'O', {0x0E, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E}},
+    {'P', {0x1E, 0x11, 0x11, 0x1E, 0x10, 0x10, 0x10}},
+    {'Q', {0x0E, 0x11, 0x11, 0x11, 0x15, 0x12, 0x0D}},
+    {'R', {0x1E, 0x11, 0x11, 0x1E, 0x14, 0x12, 0x11}},
+    {'S', {0x0F, 0x10, 0x10, 0x0E, 0x01, 0x01, 0x1E}},
+    {'T', {0x1F, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04}},
+    {'U', {0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E}},
+    {'V', {0x11, 0x11, 0x11, 0x11, 0x11, 0x0A, 0x04}},
+    {'W', {0x11, 0x11, 0x11, 0x15, 0x15, 0x15, 0x0A}},
+    {'X', {0x11, 0x11, 0x0A, 0x04, 0x0A, 0x11, 0x11}},
+    {'Y', {0x11, 0x11, 0x11, 0x0A, 0x04, 0x04, 0x04}},
+    {'Z', {0x1F, 0x01, 0x02, 0x04, 0x08, 0x10, 0x1F}},
+    {':', {0x00, 0x0C, 0x0C, 0x00, 0x0C, 0x0C, 0x00}},
+    {'.', {0x00, 0x00, 0x00, 0x00, 0x00, 0x0C, 0x0C}},
+    {',', {0x00, 0x00, 0x00, 0x00, 0x0C, 0x04, 0x08}},
+    {'/', {0x00, 0x01, 0x02, 0x04, 0x08, 0x10, 0x00}},
+    {'%', {0x18, 0x19, 0x02, 0x04, 0x08, 0x13, 0x03}},
+    {'-', {0x00, 0x00, 0x00, 0x1F, 0x00, 0x00, 0x00}},
+    {'+', {0x00, 0x04, 0x04, 0x1F, 0x04, 0x04, 0x00}},
+    {'=', {0x00, 0x00, 0x1F, 0x00, 0x1F, 0x00, 0x00}},
+    {'(', {0x02, 0x04, 0x08, 0x08, 0x08, 0x04, 0x02}},
+    {')', {0x08, 0x04, 0x02, 0x02, 0x02, 0x04, 0x08}},
+    {'<', {0x02, 0x04, 0x08, 0x10, 0x08, 0x04, 0x02}},
+    {'>', {0x08, 0x04, 0x02, 0x01, 0x02, 0x04, 0x08}},
+    {'_', {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1F}},
+    {'?', {0x0E, 0x11, 0x01, 0x02, 0x04, 0x00, 0x04}},
+};
+
+const Glyph& findGlyph(char c) {
+    char upper = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+    for (const auto& glyph : FONT) {
+        if (glyph.c == upper) {
+            return glyph;
+        }
+    }
+    return FONT[std::size(FONT) - 1];
+}
+
+} // namespace
+
+class OsdOverlay::Impl {
+public:
+    struct DumbBuffer {
+        uint32_t handle = 0;
+        uint32_t pitch = 0;
+        uint64_t size = 0;
+        uint32_t fb_id = 0;
+        uint32_t* pixels = nullptr;
+    };
+
+    struct PlaneProperties {
+        uint32_t fb_id = 0;
+        uint32_t crtc_id = 0;
+        uint32_t src_x = 0;
+        uint32_t src_y = 0;
+        uint32_t src_w = 0;
+        uint32_t src_h = 0;
+        uint32_t crtc_x = 0;
+        uint32_t crtc_y = 0;
+        uint32_t crtc_w = 0;
+        uint32_t crtc_h = 0;
+    };
+
+    static constexpr int BUFFER_COUNT = 3;
+
+    OsdConfig config;
+    int drm_fd = -1;
+    uint32_t crtc_id = 0;
+    uint32_t plane_id = 0;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    int32_t x = 0;
+    int32_t y = 0;
+    bool atomic = false;
+    PlaneProperties props;
+
+    DumbBuffer buffers[BUFFER_COUNT];
+
+    std::thread render_thread;
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::vector<std::string> lines;
+    bool dirty = false;
+    bool running = false;
+
+    // Buffer handoff to the display thread (indices, -1: none), under mutex.
+    // Only a free buffer is rendered into: the one on the plane and the one
+    // it replaced may still be scanned out until the latest commit lands.
+    int ready = -1;             // Rendered, waiting for the next video commit
+    int taken = -1;             // In the commit being prepared
+    int current = -1;           // On the plane
+    int previous = -1;          // Replaced by current in the latest commit
+    bool plane_configured = false;
+
+    bool isOverlayPlane(uint32_t id) {
+        drmModeObjectProperties* props = drmModeObjectGetProperties(drm_fd, id, DRM_MODE_OBJECT_PLANE);
+        if (!props) {
+            return false;
+        }
+        bool overlay = false;
+        for (uint32_t i = 0; i < props->count_props; ++i) {
+            drmModePropertyRes* prop = drmModeGetProperty(drm_fd, props->props[i]);
+            if (prop) {
+                if (std::strcmp(prop->name, "type") == 0) {
+                    overlay = props->prop_values[i] == DRM_PLANE_TYPE_OVERLAY;
+                }
+                drmModeFreeProperty(prop);
+            }
+        }
+        drmModeFreeObjectProperties(props);
+        return overlay;
+    }
+
+    bool findProperties() {
+        drmModeObjectProperties* object = drmModeObjectGetProperties(drm_fd, plane_id, DRM_MODE_OBJECT_PLANE);
+        if (!object) {
+            return false;
+        }
+        const std::pair<const char*, uint32_t*> wanted[] = {
+            {"FB_ID", &props.fb_id}, {"CRTC_ID", &props.crtc_id},
+            {"SRC_X", &props.src_x}, {"SRC_Y", &props.src_y}, {"SRC_W", &props.src_w}, {"SRC_H", &props.src_h},
+            {"CRTC_X", &props.crtc_x}, {"CRTC_Y", &props.crtc_y}, {"CRTC_W", &props.crtc_w}, {"CRTC_H", &props.crtc_h},
+        };
+        for (uint32_t i = 0; i < object->count_props; ++i) {
+            drmModePropertyRes* prop = drmModeGetProperty(drm_fd, object->props[i]);
+            if (!prop) {
+                continue;
+            }
+            for (const auto& [name, id] : wanted) {
+                if (std::strcmp(prop->name, name) == 0) {
+                    *id = prop->prop_id;
+                }
+            }
+            drmModeFreeProperty(prop);
+        }
+        drmModeFreeObjectProperties(object);
+
+        for (const auto& [name, id] : wanted) {
+            if (*id == 0) {
+                std::cerr << "OSD: plane " << plane_id << " has no " << name << " property" << std::endl;
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool findPlane(uint32_t crtc_index) {
+        // Universal planes expose the plane type, so the primary plane is never picked
+        drmSetClientCap(drm_fd, DRM_CLIENT_CAP_UNIVERSAL_PLANES, 1);
+
+        drmModePlaneRes* plane_resources = drmModeGetPlaneResources(drm_fd);
+        if (!plane_resources) {
+            std::cerr << "OSD: failed to get plane resources: " << strerror(errno) << std::endl;
+            return false;
+        }
+
+        for (uint32_t i = 0; i < plane_resources->count_planes && plane_id == 0; ++i) {
+            drmModePlane* plane = drmModeGetPlane(drm_fd, plane_resources->planes[i]);
+            if (!plane) {
+                continue;
+            }
+            bool usable = (plane->possible_crtcs & (1u << crtc_index)) &&
+                          (plane->crtc_id == 0 || plane->crtc_id == crtc_id) &&
+                          std::find(plane->formats, plane->formats + plane->count_formats,
+                                    DRM_FORMAT_ARGB8888) != plane->formats + plane->count_formats &&
+                          isOverlayPlane(plane->plane_id);
+            if (usable) {
+                plane_id = plane->plane_id;
+            }
+            drmModeFreePlane(plane);
+        }
+        drmModeFreePlaneResources(plane_resources);
+
+        if (plane_id == 0) {
+            std::cerr << "OSD: no free ARGB8888 overlay plane for CRTC " << crtc_id << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    bool createBuffer(DumbBuffer& buffer) {
+        drm_mode_create_dumb create = {};
+        create.width = width;
+        create.height = height;
+        create.bpp = 32;
+        if (drmIoctl(drm_fd, DRM_IOCTL_MODE_CREATE_DUMB, &create) < 0) {
+            std::cerr << "OSD: failed to create dumb buffer: " << strerror(errno) << std::endl;
+            return false;
+        }
+        buffer.handle = create.handle;
+        buffer.pitch = create.pitch;
+        buffer.size = create.size;
+
+        uint32_t handles[4] = {buffer.handle, 0, 0, 0};
+        uint32_t pitches[4] = {buffer.pitch, 0, 0, 0};
+        uint32_t offsets[4] = {0, 0, 0, 0};
+        if (drmModeAddFB2(drm_fd, width, height, DRM_FORMAT_ARGB8888,
+                          handles, pitches, offsets, &buffer.fb_id, 0) < 0) {
+            std::cerr << "OSD: failed to create framebuffer: " << strerror(errno) << std::endl;
+            return false;
+        }
+
+        drm_mode_map_dumb map = {};
+        map.handle = buffer.handle;
+        if (drmIoctl(drm_fd, DRM_IOCTL_MODE_MAP_DUMB, &map) < 0) {
+            std::cerr << "OSD: failed to map dumb buffer: " << strerror(errno) << std::endl;
+            return false;
+        }
+        void* addr = mmap(nullptr, buffer.size, PROT_READ | PROT_WRITE, MAP_SHARED, drm_fd, map.offset);
+        if (addr == MAP_FAILED) {
+            std::cerr << "OSD: mmap failed: " << strerror(errno) << std::endl;
+            return false;
+        }
+        buffer.pixels = static_cast<uint32_t*>(addr);
+        return true;
+    }
+
+    void destroyBuffer(DumbBuffer& buffer) noexcept {
+        if (buffer.pixels) {
+            munmap(buffer.pixels, buffer.size);
+            buffer.pixels = nullptr;
+        }
+        if (buffer.fb_id) {
+            drmModeRmFB(drm_fd, buffer.fb_id);
+            buffer.fb_id = 0;
+        }
+        if (buffer.handle) {
+            drm_mode_destroy_dumb destroy = {};
+            destroy.handle = buffer.handle;
+            drmIoctl(drm_fd, DRM_IOCTL_MODE_DESTROY_DUMB, &destroy);
+            buffer.handle = 0;
+        }
+    }
+
+    void render(DumbBuffer& buffer, const std::vector<std::string>& text) {
+        const uint32_t stride = buffer.pitch / 4;
+        for (uint32_t row = 0; row < height; ++row) {
+            std::fill_n(buffer.pixels + row * stride, width, config.background_color);
+        }
+
+        const uint32_t scale = config.scale;
+        const uint32_t rows = std::min<size_t>(text.size(), config.rows);
+        for (uint32_t line = 0; line < rows; ++line) {
+            const uint32_t columns = std::min<size_t>(text[line].size(), config.columns);
+            for (uint32_t column = 0; column < columns; ++column) {
+                const Glyph& glyph = findGlyph(text[line][column]);
+                const uint32_t origin_x = PADDING * scale + column * CELL_WIDTH * scale;
+                const uint32_t origin_y = PADDING * scale + line * CELL_HEIGHT * scale;
+
+                for (uint32_t gy = 0; gy < GLYPH_HEIGHT; ++gy) {
+                    for (uint32_t gx = 0; gx < GLYPH_WIDTH; ++gx) {
+                        if (!(glyph.rows[gy] & (0x10 >> gx))) {
+                            continue;
+                        }
+                        for (uint32_t sy = 0; sy < scale; ++sy) {
+                            uint32_t* dst = buffer.pixels + (origin_y + gy * scale + sy) * stride + origin_x + gx * scale;
+                            std::fill_n(dst, scale, config.text_color);
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    int freeBuffer() const {
+        for (int i = 0; i < BUFFER_COUNT; ++i) {
+            if (i != ready && i != taken && i != current && i != previous) {
+                return i;
+            }
+        }
+        return -1;
+    }
+
+    void renderLoop() {
+        const auto interval = std::chrono::milliseconds(config.update_interval_ms);
+        std::unique_lock<std::mutex> lock(mutex);
+
+        while (running) {
+            // A rendered buffer waits for the next video commit; newer text replaces it after that
+            condition.wait(lock, [this] { return (dirty && ready < 0 && freeBuffer() >= 0) || !running; });
+            if (!running) {
+                break;
+            }
+
+            int target = freeBuffer();
+            std::vector<std::string> text = lines;
+            dirty = false;
+            lock.unlock();
+            render(buffers[target], text);
+            lock.lock();
+            ready = target;
+
+            // Rate limit: later changes collapse into one update after the interval
+            condition.wait_for(lock, interval, [this] { return !running; });
+        }
+    }
+
+    bool addToCommit(drmModeAtomicReq* req, bool modeset) {
+        std::lock_guard<std::mutex> lock(mutex);
+        taken = ready;
+        ready = -1;
+        int shown = taken >= 0 ? taken : current;
+        if (shown < 0 || (taken < 0 && !modeset && plane_configured)) {
+            return false;
+        }
+        if (modeset || !plane_configured) {
+            drmModeAtomicAddProperty(req, plane_id, props.crtc_id, crtc_id);
+            drmModeAtomicAddProperty(req, plane_id, props.src_x, 0);
+            drmModeAtomicAddProperty(req, plane_id, props.src_y, 0);
+            drmModeAtomicAddProperty(req, plane_id, props.src_w, static_cast<uint64_t>(width) << 16);
+            drmModeAtomicAddProperty(req, plane_id, props.src_h, static_cast<uint64_t>(height) << 16);
+            drmModeAtomicAddProperty(req, plane_id, props.crtc_x, static_cast<uint64_t>(x));
+            drmModeAtomicAddProperty(req, plane_id, props.crtc_y, static_cast<uint64_t>(y));
+            drmModeAtomicAddProperty(req, plane_id, props.crtc_w, width);
+            drmModeAtomicAddProperty(req, plane_id, props.crtc_h, height);
+        }
+        drmModeAtomicAddProperty(req, plane_id, props.fb_id, buffers[shown].fb_id);
+        return true;
+    }
+
+    void presentLegacy() {
+        int index;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (ready < 0) {
+                return;
+            }
+            taken = index = ready;
+            ready = -1;
+        }
+        bool shown = drmModeSetPlane(drm_fd, plane_id, crtc_id, buffers[index].fb_id, 0,
+                                     x, y, width, height,
+                                     0, 0, width << 16, height << 16) == 0;
+        if (!shown) {
+            std::cerr << "OSD: drmModeSetPlane failed: " << strerror(errno) << std::endl;
+        }
+        commitDone(shown);
+    }
+
+    void commitDone(bool committed) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (committed) {
+                // A commit is only accepted once the one before it landed
+                previous = taken >= 0 ? current : -1;
+                if (taken >= 0) {
+                    current = taken;
+                    plane_configured = true;
+                }
+            } else if (taken >= 0 && ready < 0) {
+                ready = taken;      // Retried with the next commit
+            }
+            taken = -1;
+        }
+        condition.notify_one();
+    }
+
+    bool initialize(int fd, uint32_t crtc, uint32_t crtc_index, uint32_t display_width, uint32_t display_height,
+                    bool atomic_commits) {
+        drm_fd = fd;
+        crtc_id = crtc;
+        atomic = atomic_commits;
+
+        if (config.scale == 0 || config.columns == 0 || config.rows == 0) {
+            std::cerr << "OSD: invalid text grid" << std::endl;
+            return false;
+        }
+        width = (config.columns * CELL_WIDTH + 2 * PADDING) * config.scale;
+        height = (config.rows * CELL_HEIGHT + 2 * PADDING) * config.scale;
+        x = std::clamp<int32_t>(config.x, 0, static_cast<int32_t>(display_width) - 1);
+        y = std::clamp<int32_t>(config.y, 0, static_cast<int32_t>(display_height) - 1);
+        if (width > display_width - static_cast<uint32_t>(x) || height > display_height - static_cast<uint32_t>(y)) {
+            std::cerr << "OSD: " << width << "x" << height << " does not fit on the display" << std::endl;
+            return false;
+        }
+
+        if (!findPlane(crtc_index) || (atomic && !findProperties())) {
+            shutdown();
+            return false;
+        }
+        for (auto& buffer : buffers) {
+            if (!createBuffer(buffer)) {
+                shutdown();
+                return false;
+            }
+        }
+
+        running = true;
+        render_thread = std::thread(&Impl::renderLoop, this);
+        pipeline::setThreadName(render_thread, "osd");
+
+        std::cout << "OSD overlay: plane " << plane_id << ", " << width << "x" << height
+                  << " at " << x << "," << y << ", update every " << config.update_interval_ms << " ms" << std::endl;
+        return true;
+    }
+
+    void setText(const std::vector<std::string>& text) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (text == lines) {
+                return;
+            }
+            lines = text;
+            dirty = true;
+        }
+        condition.notify_one();
+    }
+
+    void shutdown() noexcept {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            running = false;
+        }
+        condition.notify_one();
+        if (render_thread.joinable()) {
+            render_thread.join();
+        }
+
+        // Called from the display thread, so no video commit is being prepared
+        if (plane_configured) {
+            if (atomic) {
+                drmModeAtomicReq* req = drmModeAtomicAlloc();
+                if (req) {
+                    drmModeAtomicAddProperty(req, plane_id, props.fb_id, 0);
+                    drmModeAtomicAddProperty(req, plane_id, props.crtc_id, 0);
+                    if (drmModeAtomicCommit(drm_fd, req, 0, nullptr) != 0) {
+                        std::cerr << "OSD: failed to disable the plane: " << strerror(errno) << std::endl;
+                    }
+                    drmModeAtomicFree(req);
+                }
+            } else {
+                drmModeSetPlane(drm_fd, plane_id, crtc_id, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+            }
+            plane_configured = false;
+        }
+        ready = taken = current = previous = -1;
+        for (auto& buffer : buffers) {
+            destroyBuffer(buffer);
+        }
+    }
+};
+
+OsdOverlay::OsdOverlay(const OsdConfig& config) : impl_(std::make_unique<Impl>()) {
+    impl_->config = config;
+}
+
+OsdOverlay::~OsdOverlay() {
+    impl_->shutdown();
+}
+
+bool OsdOverlay::initialize(int drm_fd, uint32_t crtc_id, uint32_t crtc_index,
+                            uint32_t display_width, uint32_t display_height, bool atomic) {
+    return impl_->initialize(drm_fd, crtc_id, crtc_index, display_width, display_height, atomic);
+}
+
+bool OsdOverlay::addToCommit(_drmModeAtomicReq* req, bool modeset) {
+    return impl_->addToCommit(req, modeset);
+}
+
+void OsdOverlay::presentLegacy() {
+    impl_->presentLegacy();
+}
+
+void OsdOverlay::commitDone(bool committed) {
+    impl_->commitDone(committed);
+}
+
+void OsdOverlay::setText(const std::vector<std::string>& lines) {
+    impl_->setText(lines);
+}
+
+void OsdOverlay::shutdown() noexcept {
+    impl_->shutdown();
+}
+
+uint32_t OsdOverlay::planeId() const {
+    return impl_->plane_id;
+}
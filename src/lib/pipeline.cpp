@@ -0,0 +1,69 @@
+#include "pipeline.h"
+#include <iostream>
+#include <cstring>
+#include <pthread.h>
+#include <sched.h>
+
+namespace pipeline {
+
+Executor::Executor(size_t threads) {
+    for (size_t i = 0; i < std::max<size_t>(threads, 1); ++i) {
+        workers_.emplace_back(&Executor::run, this);
+        setThreadName(workers_.back(), "executor");
+    }
+}
+
+Executor::~Executor() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    condition_.notify_all();
+    for (auto& worker : workers_) {
+        worker.join();
+    }
+}
+
+void Executor::post(std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        tasks_.push_back(std::move(task));
+    }
+    condition_.notify_one();
+}
+
+void Executor::run() {
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            condition_.wait(lock, [this] { return stopping_ || !tasks_.empty(); });
+            if (tasks_.empty()) {
+                return;     // Stopping, and everything posted has run
+            }
+            task = std::move(tasks_.front());
+            tasks_.pop_front();
+        }
+        task();
+    }
+}
+
+bool setRealtimePriority(std::thread& thread, int priority, const std::string& name) {
+    sched_param params = {};
+    params.sched_priority = std::min(priority, sched_get_priority_max(SCHED_FIFO));
+    int err = pthread_setschedparam(thread.native_handle(), SCHED_FIFO, &params);
+    if (err != 0) {
+        std::cerr << "⚠️ WARNING: Failed to set real-time priority for the " << name << " stage. "
+                  << "Run with sudo for better performance. Error: " << strerror(err) << std::endl;
+        return false;
+    }
+    std::cout << "✅ Real-time priority (SCHED_FIFO " << params.sched_priority << ") set for the "
+              << name << " stage." << std::endl;
+    return true;
+}
+
+void setThreadName(std::thread& thread, const std::string& name) {
+    (void)pthread_setname_np(thread.native_handle(), name.substr(0, 15).c_str());
+}
+
+} // namespace pipeline
@@ -0,0 +1,266 @@
+#include "reactor.h"
+#include <iostream>
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <unistd.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+
+namespace coro {
+
+void detail::PromiseBase::unhandled_exception() noexcept {
+    error = std::current_exception();
+    if (detached) {
+        // Nobody will observe the exception of a spawned task
+        try {
+            std::rethrow_exception(error);
+        } catch (const std::exception& e) {
+            std::cerr << "❌ Reactor task failed: " << e.what() << std::endl;
+        } catch (...) {
+            std::cerr << "❌ Reactor task failed with an unknown exception" << std::endl;
+        }
+    }
+}
+
+void Reactor::ReadyAwaiter::await_suspend(std::coroutine_handle<> handle) {
+    handle_ = handle;
+    reactor_.addWaiter(this);
+}
+
+Reactor::Reactor() {
+    epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+    wake_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (epoll_fd_ < 0 || wake_fd_ < 0) {
+        std::cerr << "❌ Failed to create reactor: " << strerror(errno) << std::endl;
+        return;
+    }
+    epoll_event ev = {};
+    ev.events = EPOLLIN;
+    ev.data.fd = wake_fd_;
+    if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, wake_fd_, &ev) < 0) {
+        std::cerr << "❌ Failed to register reactor wakeup: " << strerror(errno) << std::endl;
+    }
+}
+
+Reactor::~Reactor() {
+    if (wake_fd_ >= 0) {
+        close(wake_fd_);
+    }
+    if (epoll_fd_ >= 0) {
+        close(epoll_fd_);
+    }
+}
+
+void Reactor::run() {
+    epoll_event events[16];
+    while (!stopping_) {
+        int n = epoll_wait(epoll_fd_, events, 16, nextTimeoutMs());
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            std::cerr << "❌ epoll_wait failed: " << strerror(errno) << std::endl;
+            break;
+        }
+        for (int i = 0; i < n; ++i) {
+            if (events[i].data.fd == wake_fd_) {
+                uint64_t count;
+                (void)!read(wake_fd_, &count, sizeof(count));
+                runPosted();
+            } else {
+                dispatch(events[i].data.fd, events[i].events);
+            }
+        }
+        expireWaiters();
+    }
+
+    stopping_ = true;
+    // Resumed waiters see stopping_ and fall through any further waits
+    while (true) {
+        runPosted();
+        if (interests_.empty()) {
+            break;
+        }
+        std::vector<ReadyAwaiter*> cancelled;
+        for (auto& [fd, interest] : interests_) {
+            if (interest.registered) {
+                epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, nullptr);
+            }
+            cancelled.insert(cancelled.end(), interest.waiters.begin(), interest.waiters.end());
+        }
+        interests_.clear();
+        for (ReadyAwaiter* waiter : cancelled) {
+            waiter->revents_ = 0;
+            waiter->handle_.resume();
+        }
+    }
+}
+
+void Reactor::stop() {
+    stopping_ = true;
+    uint64_t one = 1;
+    (void)!write(wake_fd_, &one, sizeof(one));
+}
+
+void Reactor::post(std::function<void()> work) {
+    {
+        std::lock_guard<std::mutex> lock(post_mutex_);
+        posted_.push_back(std::move(work));
+    }
+    uint64_t one = 1;
+    (void)!write(wake_fd_, &one, sizeof(one));
+}
+
+void Reactor::runPosted() {
+    std::vector<std::function<void()>> work;
+    {
+        std::lock_guard<std::mutex> lock(post_mutex_);
+        work.swap(posted_);
+    }
+    for (auto& fn : work) {
+        fn();
+    }
+}
+
+void Reactor::addWaiter(ReadyAwaiter* waiter) {
+    Interest& interest = interests_[waiter->fd_];
+    interest.waiters.push_back(waiter);
+    updateInterest(waiter->fd_, interest);
+}
+
+// Register the union of what the fd's waiters want; one-shot semantics are
+// kept by the waiter list, not by EPOLLONESHOT
+void Reactor::updateInterest(int fd, Interest& interest) {
+    uint32_t wanted = 0;
+    for (const ReadyAwaiter* waiter : interest.waiters) {
+        wanted |= waiter->events_;
+    }
+    if (wanted == interest.registered) {
+        return;
+    }
+
+    epoll_event ev = {};
+    ev.events = wanted;
+    ev.data.fd = fd;
+    if (wanted == 0) {
+        epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, nullptr);
+    } else if (interest.registered == 0 || epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, fd, &ev) < 0) {
+        // MOD fails with ENOENT when the fd was closed and its number reused
+        if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &ev) < 0 && errno != EEXIST) {
+            std::cerr << "❌ Failed to watch fd " << fd << ": " << strerror(errno) << std::endl;
+        }
+    }
+    interest.registered = wanted;
+}
+
+void Reactor::dispatch(int fd, uint32_t revents) {
+    auto it = interests_.find(fd);
+    if (it == interests_.end()) {
+        return;
+    }
+
+    // Split off the ready waiters before resuming any: a resumed coroutine
+    // usually waits on the same fd again
+    std::vector<ReadyAwaiter*> ready;
+    auto& waiters = it->second.waiters;
+    for (auto w = waiters.begin(); w != waiters.end();) {
+        uint32_t matched = revents & ((*w)->events_ | EPOLLERR | EPOLLHUP);
+        if (matched) {
+            (*w)->revents_ = matched;
+            ready.push_back(*w);
+            w = waiters.erase(w);
+        } else {
+            ++w;
+        }
+    }
+    updateInterest(fd, it->second);
+    if (waiters.empty()) {
+        interests_.erase(it);
+    }
+
+    for (ReadyAwaiter* waiter : ready) {
+        waiter->handle_.resume();
+    }
+}
+
+// Until the earliest waiter deadline; -1 when no wait has one
+int Reactor::nextTimeoutMs() const {
+    auto earliest = Clock::time_point::max();
+    for (const auto& [fd, interest] : interests_) {
+        for (const ReadyAwaiter* waiter : interest.waiters) {
+            earliest = std::min(earliest, waiter->deadline_);
+        }
+    }
+    if (earliest == Clock::time_point::max()) {
+        return -1;
+    }
+    auto remaining = std::chrono::ceil<std::chrono::milliseconds>(earliest - Clock::now()).count();
+    return static_cast<int>(std::clamp<int64_t>(remaining, 0, INT32_MAX));
+}
+
+void Reactor::expireWaiters() {
+    auto now = Clock::now();
+    std::vector<ReadyAwaiter*> expired;
+    for (auto it = interests_.begin(); it != interests_.end();) {
+        auto& waiters = it->second.waiters;
+        for (auto w = waiters.begin(); w != waiters.end();) {
+            if ((*w)->deadline_ <= now) {
+                (*w)->revents_ = 0;
+                expired.push_back(*w);
+                w = waiters.erase(w);
+            } else {
+                ++w;
+            }
+        }
+        updateInterest(it->first, it->second);
+        it = waiters.empty() ? interests_.erase(it) : std::next(it);
+    }
+    for (ReadyAwaiter* waiter : expired) {
+        waiter->handle_.resume();
+    }
+}
+
+Task<bool> Reactor::sleep(std::chrono::milliseconds interval) {
+    int fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (fd < 0) {
+        co_return false;
+    }
+    itimerspec spec = {};
+    auto ms = std::max<int64_t>(interval.count(), 1);
+    spec.it_value.tv_sec = ms / 1000;
+    spec.it_value.tv_nsec = (ms % 1000) * 1000000;
+    timerfd_settime(fd, 0, &spec, nullptr);
+
+    uint32_t revents = co_await ready(fd, EPOLLIN);
+    close(fd);
+    co_return revents != 0;
+}
+
+Event::Event() {
+    fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+}
+
+Event::~Event() {
+    if (fd_ >= 0) {
+        close(fd_);
+    }
+}
+
+void Event::notify() {
+    uint64_t one = 1;
+    (void)!write(fd_, &one, sizeof(one));
+}
+
+Task<bool> Event::wait(Reactor& reactor) {
+    uint32_t events = co_await reactor.ready(fd_, EPOLLIN);
+    if (!events) {
+        co_return false;
+    }
+    uint64_t count;
+    (void)!read(fd_, &count, sizeof(count));
+    co_return true;
+}
+
+} // namespace coro
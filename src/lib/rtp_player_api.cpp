@@ -0,0 +1,263 @@
+#include "rtp_player_api.h"
+#include "rtp_session.h"
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <new>
+
+struct rtp_session {
+    RtpSession::Config config;
+    std::unique_ptr<RtpSession> session;
+    mutable std::mutex mutex;      // Guards session against rtp_session_get_stats()
+    std::mutex lifecycle_mutex;    // Serializes start and stop, which run without mutex held
+
+    rtp_frame_callback_t frame_callback = nullptr;
+    void* frame_user_data = nullptr;
+};
+
+namespace {
+
+// What rtp_frame_t* handed to the application points to
+struct FrameHandle : rtp_frame_t {
+    DecodedFrameRef ref;
+};
+
+bool isRunning(const rtp_session_t* session) {
+    std::lock_guard<std::mutex> lock(session->mutex);
+    return session->session != nullptr;
+}
+
+// Exception barrier: no C++ exception may unwind into the C caller
+template <typename F>
+int guarded(F&& body) noexcept {
+    try {
+        return body();
+    } catch (const std::bad_alloc&) {
+        return RTP_ERR_NOMEM;
+    } catch (...) {
+        return RTP_ERR_INTERNAL;
+    }
+}
+
+} // namespace
+
+extern "C" {
+
+uint32_t rtp_player_api_version(void) {
+    return (RTP_PLAYER_API_VERSION_MAJOR << 16) | RTP_PLAYER_API_VERSION_MINOR;
+}
+
+rtp_session_t* rtp_session_create(void) {
+    try {
+        return new rtp_session();
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void rtp_session_destroy(rtp_session_t* session) {
+    if (session) {
+        rtp_session_stop(session);
+        delete session;
+    }
+}
+
+int rtp_session_set_decoder(rtp_session_t* session, const char* device_path) {
+    return guarded([&] {
+        if (!session || !device_path) {
+            return RTP_ERR_INVALID;
+        }
+        if (isRunning(session)) {
+            return RTP_ERR_STATE;
+        }
+        session->config.device_path = device_path;
+        return RTP_OK;
+    });
+}
+
+int rtp_session_set_source_rtp(rtp_session_t* session, const char* ip, uint16_t port) {
+    return guarded([&] {
+        if (!session || port == 0) {
+            return RTP_ERR_INVALID;
+        }
+        if (isRunning(session)) {
+            return RTP_ERR_STATE;
+        }
+        session->config.local_ip = ip ? ip : "0.0.0.0";
+        session->config.local_port = port;
+        return RTP_OK;
+    });
+}
+
+int rtp_session_set_source_rtsp(rtp_session_t* session, const char* url, int force_tcp) {
+    return guarded([&] {
+        if (!session || !url) {
+            return RTP_ERR_INVALID;
+        }
+        if (isRunning(session)) {
+            return RTP_ERR_STATE;
+        }
+        session->config.rtsp.url = url;
+        session->config.rtsp.transport = force_tcp ? RtspClient::Transport::TCP : RtspClient::Transport::AUTO;
+        return RTP_OK;
+    });
+}
+
+int rtp_session_set_display(rtp_session_t* session, rtp_display_t display) {
+    return guarded([&] {
+        if (!session) {
+            return RTP_ERR_INVALID;
+        }
+        if (isRunning(session)) {
+            return RTP_ERR_STATE;
+        }
+        switch (display) {
+            case RTP_DISPLAY_DRM:
+                session->config.display.output = DisplayOutput::DRM;
+                return RTP_OK;
+            case RTP_DISPLAY_WAYLAND:
+    #ifdef RTP_PLAYER_ENABLE_WAYLAND
+                session->config.display.output = DisplayOutput::WAYLAND;
+                return RTP_OK;
+    #else
+                return RTP_ERR_UNSUPPORTED;
+    #endif
+            case RTP_DISPLAY_NONE:
+                session->config.display.output = DisplayOutput::NONE;
+                return RTP_OK;
+        }
+        return RTP_ERR_INVALID;
+    });
+}
+
+int rtp_session_set_frame_callback(rtp_session_t* session, rtp_frame_callback_t callback, void* user_data) {
+    return guarded([&] {
+        if (!session) {
+            return RTP_ERR_INVALID;
+        }
+        if (isRunning(session)) {
+            return RTP_ERR_STATE;
+        }
+        session->frame_callback = callback;
+        session->frame_user_data = user_data;
+        return RTP_OK;
+    });
+}
+
+int rtp_session_start(rtp_session_t* session) {
+    return guarded([&] {
+        if (!session) {
+            return RTP_ERR_INVALID;
+        }
+        // Frame callbacks may call rtp_session_get_stats() as soon as the
+        // session starts: build it without holding mutex
+        std::lock_guard<std::mutex> lifecycle(session->lifecycle_mutex);
+        if (isRunning(session)) {
+            return RTP_ERR_STATE;
+        }
+
+        auto rtp = std::make_unique<RtpSession>(session->config);
+        if (!rtp->initialize()) {
+            return RTP_ERR_INIT;
+        }
+
+        if (session->frame_callback) {
+            rtp_frame_callback_t callback = session->frame_callback;
+            void* user_data = session->frame_user_data;
+            int id = rtp->addFrameConsumer([callback, user_data](const DecodedFrameRef& frame) {
+                auto* handle = new (std::nothrow) FrameHandle();
+                if (!handle) {
+                    return;     // Dropped: the decoder gets the buffer back
+                }
+                handle->dma_fd = frame->dma_fd;
+                handle->data = frame->data;
+                handle->size = frame->size;
+                handle->width = frame->width;
+                handle->height = frame->height;
+                handle->format = frame->format;
+                handle->stride = frame->stride;
+                handle->sequence = frame->sequence;
+                handle->timestamp_us = frame->timestamp.count();
+                handle->decoded_at_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    frame->decoded_at.time_since_epoch()).count();
+                handle->ref = frame;
+                if (!callback(handle, user_data)) {
+                    delete handle;
+                }
+            });
+            if (id < 0) {
+                return RTP_ERR_INIT;
+            }
+        }
+
+        if (!rtp->start()) {
+            return RTP_ERR_INIT;
+        }
+        std::lock_guard<std::mutex> lock(session->mutex);
+        session->session = std::move(rtp);
+        return RTP_OK;
+    });
+}
+
+void rtp_session_stop(rtp_session_t* session) {
+    if (!session) {
+        return;
+    }
+    (void)guarded([&] {
+        std::lock_guard<std::mutex> lifecycle(session->lifecycle_mutex);
+        std::unique_ptr<RtpSession> stopping;
+        {
+            std::lock_guard<std::mutex> lock(session->mutex);
+            stopping = std::move(session->session);
+        }
+        // Joins the threads that run frame callbacks, which may take mutex
+        if (stopping) {
+            stopping->stop();
+            stopping.reset();
+        }
+        return RTP_OK;
+    });
+}
+
+int rtp_session_get_stats(const rtp_session_t* session, rtp_session_stats_t* stats) {
+    return guarded([&] {
+        if (!session || !stats || stats->struct_size < sizeof(size_t)) {
+            return RTP_ERR_INVALID;
+        }
+
+        RtpSession::Statistics current;
+        {
+            std::lock_guard<std::mutex> lock(session->mutex);
+            if (!session->session) {
+                return RTP_ERR_STATE;
+            }
+            current = session->session->getStatistics();
+        }
+
+        rtp_session_stats_t result = {};
+        result.struct_size = stats->struct_size;
+        result.decoded_frames = current.decoded_frames;
+        result.dropped_frames = current.dropped_frames;
+        result.decode_latency_us = current.decode_latency_us;
+        result.packets_received = current.receiver.packets_received;
+        result.packets_lost = current.receiver.packets_lost;
+        result.bytes_received = current.receiver.bytes_received;
+        result.display_flips = current.display.flips;
+        result.avg_flip_latency_us = current.display.avg_flip_latency_us;
+        result.run_delay_us = current.scheduling.run_delay_us;
+        result.involuntary_switches = current.scheduling.involuntary_switches;
+        result.max_run_delay_us = current.scheduling.max_run_delay_us;
+        result.max_involuntary_switches = current.scheduling.max_involuntary_switches;
+
+        // Older callers know a prefix of the struct
+        std::memcpy(stats, &result, std::min(stats->struct_size, sizeof(result)));
+        return RTP_OK;
+    });
+}
+
+void rtp_frame_release(const rtp_frame_t* frame) {
+    delete static_cast<const FrameHandle*>(frame);
+}
+
+} // extern "C"
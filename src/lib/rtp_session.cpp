@@ -0,0 +1,927 @@
+#include "rtp_session.h"
+#include "uvgrtp_receiver.h"
+#include "async_decoder.h"
+#include <iostream>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+#include <climits>
+#include <cstdio>
+#include <deque>
+#include <condition_variable>
+#include <mutex>
+
+class RtpSession::Impl {
+    // Concrete handler type, so the decode stage calls decodeFrame() directly
+    struct DecodeHandler {
+        Impl* impl;
+        void operator()(std::unique_ptr<H264Frame>& frame) const { impl->decodeFrame(frame); }
+    };
+    using DecodeStage = pipeline::Stage<std::unique_ptr<H264Frame>, DecodeHandler>;
+
+    static constexpr auto OUTPUT_BUFFER_WAIT = std::chrono::milliseconds(20);
+
+public:
+    explicit Impl(const Config& session_config) : config(session_config) {}
+
+    [[nodiscard]] bool initialize() {
+        if (config.native_receiver && !config.srtp_key.empty()) {
+            std::cerr << "Error: SRTP is only supported with the uvgRTP receiver" << std::endl;
+            return false;
+        }
+
+        // Create configuration
+        DecoderConfig decoder_config;
+        decoder_config.device_path = config.device_path;
+        decoder_config.osd = config.osd;
+        decoder_config.display = config.display;
+        // Other parameters remain default
+
+        // Local frame sharing (optional); subscribers get their own decoder buffers
+        if (!config.frame_server.socket_path.empty()) {
+            frame_server = std::make_unique<FrameServer>(config.frame_server);
+            if (!frame_server->initialize()) {
+                std::cerr << "Error initializing frame server" << std::endl;
+                return false;
+            }
+            decoder_config.output_buffer_count += frame_server->maxHeldBuffers();
+        }
+
+        // Initialize V4L2 decoder
+        decoder = std::make_unique<V4L2Decoder>();
+        if (!decoder->initialize(decoder_config)) {
+            std::cerr << "Error initializing V4L2 decoder" << std::endl;
+            return false;
+        }
+        if (config.flight_recorder_enabled) {
+            flight_recorder = std::make_unique<FlightRecorder>(config.flight_recorder);
+            decoder->setFlightRecorder(flight_recorder.get());
+        }
+
+        // Configure display
+        if (!decoder->setDisplay()) {
+            std::cerr << "Error configuring display" << std::endl;
+            return false;
+        }
+
+        if (frame_server && !frame_server->start(*decoder)) {
+            std::cerr << "Error starting frame server" << std::endl;
+            return false;
+        }
+
+        // Initialize RTP receiver
+        if (config.native_receiver) {
+            config.native.local_ip = config.local_ip;
+            config.native.local_port = config.local_port;
+            rtp_receiver = std::make_unique<NativeRTPReceiver>(config.native);
+        } else {
+            auto uvgrtp_receiver = std::make_unique<UvgRTPReceiver>(config.local_ip, config.local_port);
+            if (!config.srtp_key.empty() && !uvgrtp_receiver->setSrtpMasterKey(config.srtp_key)) {
+                std::cerr << "Error configuring SRTP" << std::endl;
+                return false;
+            }
+            rtp_receiver = std::move(uvgrtp_receiver);
+        }
+        if (!rtp_receiver->initialize()) {
+            std::cerr << "Error initializing RTP receiver" << std::endl;
+            return false;
+        }
+
+        // Congestion control feedback towards the sender (optional)
+        if (config.feedback.remote_port != 0) {
+            if (!config.native_receiver && config.feedback.enable_twcc) {
+                // uvgRTP only hands over whole frames; TWCC needs every packet's arrival
+                std::cout << "⚠️ TWCC needs per-packet arrivals (--native); sending REMB only" << std::endl;
+                config.feedback.enable_twcc = false;
+                config.feedback.enable_remb = true;
+            }
+            transport_feedback = std::make_unique<TransportFeedback>(config.feedback);
+            if (!transport_feedback->initialize()) {
+                std::cerr << "Error initializing transport feedback" << std::endl;
+                return false;
+            }
+            rtp_receiver->setTransportFeedback(transport_feedback.get());
+        }
+
+        // Decode stage between the receiver threads and the decoder
+        if (config.use_reactor) {
+            decode_channel = std::make_unique<coro::Channel<std::unique_ptr<H264Frame>>>(
+                config.decode_stage.capacity, config.decode_stage.overflow);
+        } else {
+            if (config.decode_stage.threading == pipeline::Threading::EXECUTOR) {
+                executor = std::make_unique<pipeline::Executor>(config.executor_threads);
+            }
+            decode_stage = std::make_unique<DecodeStage>("decode", config.decode_stage, DecodeHandler{this}, executor.get());
+        }
+
+        // Set callback for frame processing
+        rtp_receiver->setFrameCallback([this](std::unique_ptr<H264Frame> frame) {
+            onFrameReceived(std::move(frame));
+        });
+
+        // RTSP session towards the camera (optional)
+        if (!config.rtsp.url.empty()) {
+            config.rtsp.client_rtp_port = config.local_port;
+            rtsp_client = std::make_unique<RtspClient>(config.rtsp);
+            rtsp_client->setFrameCallback([this](std::unique_ptr<H264Frame> frame) {
+                onFrameReceived(std::move(frame));
+            });
+        }
+
+        std::cout << "RTP session initialized: " << config.local_ip << ":" << config.local_port << std::endl;
+        return true;
+    }
+
+    [[nodiscard]] bool start() {
+        if (!rtp_receiver) {
+            std::cerr << "RTP receiver not initialized" << std::endl;
+            return false;
+        }
+        if (running) {
+            return true;
+        }
+
+        running = true;
+        last_frame_ns = 0;
+        stream_lost = false;
+        idle = false;
+        if (decode_channel) {
+            std::cout << "Starting reactor (queue size: " << config.decode_stage.capacity << ")..." << std::endl;
+            if (!startReactor()) {
+                running = false;
+                return false;
+            }
+        } else {
+            std::cout << "Starting decode stage (queue size: " << config.decode_stage.capacity << ")..." << std::endl;
+            decode_stage->start();
+        }
+        std::cout << "⏳ Waiting for SPS frame..." << std::endl;
+
+        // Start the RTP receiver
+        if (!rtp_receiver->start()) {
+            std::cerr << "Error starting RTP receiver" << std::endl;
+            stop();
+            return false;
+        }
+
+        if (transport_feedback && !transport_feedback->start()) {
+            std::cerr << "⚠️ WARNING: Failed to start transport feedback" << std::endl;
+        }
+
+        // The receiver is already listening, so the stream can start right away
+        if (rtsp_client && !rtsp_client->start()) {
+            std::cerr << "Error starting RTSP session" << std::endl;
+            stop();
+            return false;
+        }
+
+        if (!reactor) {
+            telemetry_thread = std::thread(&Impl::telemetryLoop, this);
+            pipeline::setThreadName(telemetry_thread, "telemetry");
+        }
+        if (monitorsStream() && !reactor) {
+            stream_monitor_thread = std::thread(&Impl::streamMonitorLoop, this);
+            pipeline::setThreadName(stream_monitor_thread, "stream-monitor");
+        }
+
+        if (config.watchdog_enabled) {
+            watchdog = std::make_unique<Watchdog>(config.watchdog);
+            if (!watchdog->start(*decoder)) {
+                std::cerr << "⚠️ WARNING: Failed to start watchdog" << std::endl;
+            }
+        }
+
+        std::cout << "RTP session started, waiting for H.264 data on " << config.local_ip << ":" << config.local_port << std::endl;
+        return true;
+    }
+
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(idle_mutex);
+            running = false;
+        }
+        idle_changed.notify_all();
+
+        // Shutdown is not a stall
+        if (watchdog) {
+            watchdog->stop();
+        }
+
+        if (rtsp_client) {
+            rtsp_client->stop();
+        }
+
+        // Stop the RTP receiver
+        if (rtp_receiver) {
+            rtp_receiver->stop();
+        }
+
+        if (transport_feedback) {
+            transport_feedback->stop();
+        }
+
+        // Decode what is queued, then stop the decode stage
+        if (decode_stage) {
+            decode_stage->stop();
+        }
+        stopReactor();
+
+        if (telemetry_thread.joinable()) {
+            telemetry_thread.join();
+        }
+        if (stream_monitor_thread.joinable()) {
+            stream_monitor_thread.join();
+        }
+
+        if (frame_server) {
+            auto stats = frame_server->getStatistics();
+            frame_server->stop();
+            frame_server.reset();
+            std::cout << "Frame server: published " << stats.published << ", dropped " << stats.dropped
+                      << ", disconnected " << stats.disconnected << std::endl;
+        }
+    }
+
+    [[nodiscard]] Statistics getStatistics() const {
+        Statistics stats;
+        stats.decoded_frames = decoded_frames;
+        stats.decode_latency_us = decode_latency_us;
+        if (decode_channel) {
+            stats.stages.push_back(decode_channel->metrics().snapshot("decode", decode_channel->size()));
+            stats.dropped_frames = stats.stages.back().dropped;
+            stats.queue_depth = stats.stages.back().depth;
+        } else if (decode_stage) {
+            stats.stages.push_back(decode_stage->metrics());
+            stats.dropped_frames = stats.stages.back().dropped;
+            stats.queue_depth = stats.stages.back().depth;
+        }
+        if (rtp_receiver) {
+            stats.receiver = rtp_receiver->getStatistics();
+        }
+        if (decoder) {
+            stats.display = decoder->getDisplayStatistics();
+            stats.recovery = decoder->getRecoveryStatistics();
+            for (auto& stage : decoder->getStageMetrics()) {
+                stats.stages.push_back(std::move(stage));
+            }
+        }
+        if (watchdog) {
+            stats.watchdog = watchdog->getStatistics();
+        }
+        if (flight_recorder) {
+            stats.flight_recorder = flight_recorder->getStatistics();
+        }
+        stats.stream_losses = stream_losses;
+        stats.keyframe_requests = keyframe_requests;
+        stats.last_reacquisition_ms = last_reacquisition_ms;
+        stats.stream_lost = stream_lost;
+        stats.idle_entries = idle_entries;
+        stats.idle = idle;
+        {
+            std::lock_guard<std::mutex> lock(scheduling_mutex);
+            stats.scheduling = scheduling;
+        }
+        return stats;
+    }
+
+    void onFrameReceived(std::unique_ptr<H264Frame> frame) {
+        if (!frame || frame->data.empty()) {
+            return;
+        }
+
+        int64_t now_ns = steadyNs();
+        last_frame_ns = now_ns;
+        if (flight_recorder) {
+            flight_recorder->record(FlightRecorder::Event::RECEIVED, ++received_frames,
+                                    static_cast<uint32_t>(frame->data.size()), 0, -1,
+                                    frame->discontinuity ? FlightRecorder::DISCONTINUITY : 0, frame->timestamp);
+        }
+        if (idle) {
+            leaveIdle();
+        }
+        uint32_t previous_ssrc = frame->ssrc != 0 ? stream_ssrc.exchange(frame->ssrc) : 0;
+        if (frame->discontinuity || (previous_ssrc != 0 && previous_ssrc != frame->ssrc)) {
+            streamLost("sender restarted");
+        }
+        if (stream_lost) {
+            int64_t unset = 0;
+            reacquire_start_ns.compare_exchange_strong(unset, now_ns);
+        }
+
+        // Check for SPS/PPS in the stream if not already found
+        if (!has_sps) {
+            const auto& data = frame->data;
+            for (size_t i = 0; i + 3 < data.size(); ) {
+                size_t start_code_len = 0;
+                if (i + 4 < data.size() && data[i] == 0x00 && data[i+1] == 0x00 && data[i+2] == 0x00 && data[i+3] == 0x01) {
+                    start_code_len = 4;
+                } else if (data[i] == 0x00 && data[i+1] == 0x00 && data[i+2] == 0x01) {
+                    start_code_len = 3;
+                }
+
+                if (start_code_len > 0) {
+                    size_t nalu_header_pos = i + start_code_len;
+                    if (nalu_header_pos < data.size()) {
+                        uint8_t nalu_type = data[nalu_header_pos] & 0x1F;
+                        if (nalu_type == 7) { // SPS
+                            std::cout << "✅ SPS frame received (NALU type 7), decoder is ready to work!" << std::endl;
+                            has_sps = true;
+                            break;
+                        }
+                    }
+                    i += start_code_len;
+                } else {
+                    i++;
+                }
+            }
+            if (!has_sps) {
+                requestKeyframe(false);
+            }
+        }
+
+        // A full queue drops or blocks according to the decode stage config
+        if (decode_channel) {
+            (void)decode_channel->push(std::move(frame));
+        } else {
+            (void)decode_stage->push(std::move(frame));
+        }
+    }
+
+    void decodeFrame(std::unique_ptr<H264Frame>& frame) {
+        if (!frame) {
+            return;
+        }
+        if (frame->data.empty()) {
+            handleControlFrame(*frame);
+            return;
+        }
+        // Nothing before the first SPS can be decoded
+        if (!has_sps) {
+            return;
+        }
+
+        try {
+            if (decoder->decodeData(frame->data.data(), frame->data.size(), frame->timestamp)) {
+                frameDecoded(frame->received_time);
+            } else {
+                std::cout << "❌ Error decoding frame (" << frame->data.size() << " bytes)" << std::endl;
+                recordDecodeError(*frame);
+            }
+
+        } catch (const std::exception& e) {
+            std::cerr << "Critical error in decode stage: " << e.what() << std::endl;
+        }
+    }
+
+    void recordDecodeError(const H264Frame& frame) {
+        if (flight_recorder) {
+            flight_recorder->record(FlightRecorder::Event::DECODE_ERROR, 0, static_cast<uint32_t>(frame.data.size()),
+                                    0, -1, 0, frame.timestamp);
+            flight_recorder->trigger("decode error");
+        }
+    }
+
+    void frameDecoded(std::chrono::steady_clock::time_point received_time) {
+        uint64_t decoded = ++decoded_frames;
+
+        // Smoothed receive-to-decoded latency for the telemetry overlay
+        auto latency = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - received_time).count();
+        int64_t previous = decode_latency_us;
+        decode_latency_us = previous == 0 ? latency : (previous * 7 + latency) / 8;
+        if (flight_recorder) {
+            uint32_t spike_ms = flight_recorder->config().latency_spike_ms;
+            bool spike = spike_ms > 0 && latency > static_cast<int64_t>(spike_ms) * 1000;
+            flight_recorder->record(FlightRecorder::Event::DECODED, static_cast<uint32_t>(decoded), 0,
+                                    static_cast<int32_t>(std::min<int64_t>(latency, INT32_MAX)), -1,
+                                    spike ? FlightRecorder::LATENCY_SPIKE : 0);
+            if (spike) {
+                flight_recorder->trigger("latency spike");
+            }
+        }
+
+        // Frames of the old stream are gone once the new SPS arrived
+        int64_t reacquire_start = reacquire_start_ns;
+        if (reacquire_start != 0 && has_sps && stream_lost.exchange(false)) {
+            int64_t ms = (steadyNs() - reacquire_start) / 1000000;
+            last_reacquisition_ms = ms;
+            std::cout << "📡 Stream reacquired in " << ms << " ms" << std::endl;
+        }
+
+        if (decoded == 1) {
+            std::cout << "✅ First frame successfully decoded and displayed!" << std::endl;
+        } else if (decoded % 100 == 0) {
+            std::cout << "✅ Decoded " << decoded << " frames" << std::endl;
+        }
+    }
+
+    [[nodiscard]] bool startReactor() {
+        reactor = std::make_unique<coro::Reactor>();
+        if (!reactor->valid()) {
+            reactor.reset();
+            return false;
+        }
+        decode_channel->reopen();
+        in_flight.clear();
+        collected_frames = decoder->getDecodedFrameCount();
+
+        reactor->spawn(feedLoop());
+        reactor->spawn(captureLoop());
+        reactor->spawn(telemetryTask());
+        if (monitorsStream()) {
+            reactor->spawn(streamMonitorTask());
+        }
+
+        reactor_thread = std::thread([this] { reactor->run(); });
+        pipeline::setThreadName(reactor_thread, "reactor");
+        if (config.decode_stage.realtime_priority > 0) {
+            (void)pipeline::setRealtimePriority(reactor_thread, config.decode_stage.realtime_priority, "reactor");
+        }
+        return true;
+    }
+
+    void stopReactor() {
+        if (decode_channel) {
+            decode_channel->close();
+        }
+        if (reactor) {
+            reactor->stop();
+        }
+        if (reactor_thread.joinable()) {
+            reactor_thread.join();
+        }
+        reactor.reset();
+    }
+
+    // Received frames → OUTPUT buffers, waiting for a free buffer instead of polling
+    coro::Task<void> feedLoop() {
+        while (true) {
+            auto item = co_await decode_channel->pop(*reactor);
+            if (!item) {
+                break;
+            }
+            auto& [frame, enqueued] = *item;
+            if (!frame) {
+                continue;
+            }
+            if (frame->data.empty()) {
+                in_flight.clear();
+                handleControlFrame(*frame);
+                continue;
+            }
+            if (!has_sps) {
+                continue;
+            }
+
+            auto begin = std::chrono::steady_clock::now();
+            bool submitted = false;
+            bool ok = decoder->trySubmitData(frame->data.data(), frame->data.size(), frame->timestamp, submitted);
+            if (ok && !submitted) {
+                // Same bound as decodeData(): a wedged decoder costs frames, not the loop
+                (void)co_await coro::outputBufferFree(*reactor, *decoder, OUTPUT_BUFFER_WAIT);
+                if (reactor->stopping()) {
+                    co_return;
+                }
+                ok = decoder->trySubmitData(frame->data.data(), frame->data.size(), frame->timestamp, submitted);
+                if (ok && !submitted) {
+                    std::cerr << "❌ ERROR: No free input buffers!" << std::endl;
+                    ok = false;
+                }
+            }
+            decode_channel->metrics().processed(begin - enqueued, std::chrono::steady_clock::now() - begin);
+
+            if (!ok) {
+                std::cout << "❌ Error decoding frame (" << frame->data.size() << " bytes)" << std::endl;
+                recordDecodeError(*frame);
+                continue;
+            }
+            // Latency is matched to decoded frames in submission order
+            if (in_flight.size() >= 32) {
+                in_flight.pop_front();
+            }
+            in_flight.push_back(frame->received_time);
+            frame_submitted.notify();
+        }
+    }
+
+    // Decoded frames → display and consumers, never blocking on a page flip
+    coro::Task<void> captureLoop() {
+        // The device reports POLLERR until streaming starts with the first frame
+        bool started = co_await frame_submitted.wait(*reactor);
+        while (started) {
+            if (decoder->displayBusy()) {
+                bool flipped = co_await coro::pageFlipComplete(*reactor, *decoder);
+                if (!flipped) {
+                    co_return;
+                }
+            }
+            uint32_t events = co_await coro::captureReady(*reactor, *decoder);
+            if (!events) {
+                co_return;
+            }
+
+            bool ok = decoder->collectFrames();
+            int count = decoder->getDecodedFrameCount();
+            for (; collected_frames < count; ++collected_frames) {
+                auto received = std::chrono::steady_clock::now();
+                if (!in_flight.empty()) {
+                    received = in_flight.front();
+                    in_flight.pop_front();
+                }
+                frameDecoded(received);
+            }
+
+            // After an error the decoder resets on the next submission; wait for it
+            if (!ok) {
+                started = co_await frame_submitted.wait(*reactor);
+            }
+        }
+    }
+
+    static int64_t steadyNs() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    // The stream was interrupted: drop what is queued, restart the decoder (in
+    // queue order, on the decoding thread) and start over at the next SPS
+    void streamLost(const std::string& reason) {
+        if (stream_lost.exchange(true)) {
+            return;
+        }
+        has_sps = false;
+        reacquire_start_ns = 0;
+        stream_losses++;
+        if (flight_recorder) {
+            flight_recorder->record(FlightRecorder::Event::STREAM_LOST, static_cast<uint32_t>(stream_losses));
+            flight_recorder->trigger("stream lost");
+        }
+        size_t flushed = decode_channel ? decode_channel->flush() : decode_stage->flush();
+        std::cout << "📡 Stream lost (" << reason << "), dropped " << flushed
+                  << " queued frame(s), waiting for a keyframe" << std::endl;
+
+        pushControlFrame(true);
+        requestKeyframe(true);
+    }
+
+    // Decoder work that must run on the decoding thread in queue order is
+    // queued as a frame without data: a stream break (discontinuity) or idle.
+    // The overflow policy never drops these
+    void pushControlFrame(bool stream_break) {
+        auto control = std::make_unique<H264Frame>();
+        control->discontinuity = stream_break;
+        if (decode_channel) {
+            (void)decode_channel->pushControl(std::move(control));
+        } else {
+            (void)decode_stage->pushControl(std::move(control));
+        }
+    }
+
+    void handleControlFrame(const H264Frame& control) {
+        if (control.discontinuity) {
+            (void)decoder->resetStream(config.blank_on_loss);
+        } else {
+            (void)decoder->suspend(config.blank_on_loss, config.idle_release_buffers);
+        }
+    }
+
+    void enterIdle(int64_t silent_ms) {
+        if (!stream_lost) {
+            streamLost("no frames for " + std::to_string(silent_ms) + " ms");
+        }
+        {
+            std::lock_guard<std::mutex> lock(idle_mutex);
+            if (idle || !running) {
+                return;
+            }
+            idle = true;
+            idle_entries++;
+            if (flight_recorder) {
+                flight_recorder->record(FlightRecorder::Event::IDLE, static_cast<uint32_t>(idle_entries));
+            }
+            // Nothing to watch; its checks would be the only periodic wakeup
+            if (watchdog) {
+                watchdog->stop();
+            }
+        }
+        // Whatever is still queued is stale by now; the marker itself cannot be dropped
+        size_t flushed = decode_channel ? decode_channel->flush() : decode_stage->flush();
+        std::cout << "💤 No frames for " << silent_ms << " ms, going idle";
+        if (flushed > 0) {
+            std::cout << ", dropped " << flushed << " queued frame(s)";
+        }
+        std::cout << std::endl;
+        pushControlFrame(false);
+    }
+
+    // Receiver thread: the decoder resumes with the next submission
+    void leaveIdle() {
+        {
+            std::lock_guard<std::mutex> lock(idle_mutex);
+            if (!idle) {
+                return;
+            }
+            idle = false;
+            if (watchdog && running && !watchdog->start(*decoder)) {
+                std::cerr << "⚠️ WARNING: Failed to restart watchdog" << std::endl;
+            }
+        }
+        idle_changed.notify_all();
+        stream_resumed.notify();
+        std::cout << "⏰ Frames again, leaving idle" << std::endl;
+    }
+
+    // Periodic work pauses while idle; false once the session stops
+    bool waitWhileIdle() {
+        std::unique_lock<std::mutex> lock(idle_mutex);
+        idle_changed.wait(lock, [this] { return !idle || !running; });
+        return running;
+    }
+
+    coro::Task<bool> waitWhileIdle(coro::Reactor& r) {
+        while (idle) {
+            bool woken = co_await stream_resumed.wait(r);
+            if (!woken) {
+                co_return false;
+            }
+        }
+        co_return true;
+    }
+
+    // PLI towards the sender, at most once per keyframe_request_interval_ms unless forced
+    void requestKeyframe(bool force) {
+        int64_t now = steadyNs();
+        int64_t last = last_keyframe_request_ns;
+        if (!force && last != 0 && now - last < int64_t{config.keyframe_request_interval_ms} * 1000000) {
+            return;
+        }
+        if (!last_keyframe_request_ns.compare_exchange_strong(last, now)) {
+            return;
+        }
+
+        bool sent = false;
+        if (rtsp_client) {
+            sent = rtsp_client->requestKeyframe();
+        } else if (transport_feedback && stream_ssrc != 0) {
+            sent = transport_feedback->sendPictureLossIndication(stream_ssrc);
+        }
+        if (sent) {
+            keyframe_requests++;
+        }
+    }
+
+    void checkStreamTimeout() {
+        int64_t last = last_frame_ns;
+        if (last == 0) {
+            return;
+        }
+        int64_t silent_ms = (steadyNs() - last) / 1000000;
+        if (config.stream_timeout_ms > 0 && silent_ms > config.stream_timeout_ms && !stream_lost) {
+            streamLost("no frames for " + std::to_string(silent_ms) + " ms");
+        }
+        if (config.idle_timeout_ms > 0 && silent_ms > config.idle_timeout_ms && !idle) {
+            enterIdle(silent_ms);
+        }
+    }
+
+    bool monitorsStream() const {
+        return config.stream_timeout_ms > 0 || config.idle_timeout_ms > 0;
+    }
+
+    std::chrono::milliseconds streamMonitorInterval() const {
+        uint32_t timeout = config.stream_timeout_ms > 0 ? config.stream_timeout_ms : config.idle_timeout_ms;
+        if (config.idle_timeout_ms > 0) {
+            timeout = std::min(timeout, config.idle_timeout_ms);
+        }
+        return std::chrono::milliseconds(std::clamp<uint32_t>(timeout / 4, 10, 250));
+    }
+
+    coro::Task<void> streamMonitorTask() {
+        const auto interval = streamMonitorInterval();
+        while (true) {
+            bool active = co_await waitWhileIdle(*reactor);
+            if (!active) {
+                break;
+            }
+            bool elapsed = co_await reactor->sleep(interval);
+            if (!elapsed) {
+                break;
+            }
+            checkStreamTimeout();
+        }
+    }
+
+    void streamMonitorLoop() {
+        const auto interval = streamMonitorInterval();
+        while (waitWhileIdle()) {
+            std::this_thread::sleep_for(interval);
+            checkStreamTimeout();
+        }
+    }
+
+    struct TelemetryState {
+        std::chrono::steady_clock::time_point time;
+        uint64_t decoded = 0;
+        uint64_t bytes = 0;
+    };
+
+    coro::Task<void> telemetryTask() {
+        const auto interval = std::chrono::milliseconds(std::max<uint32_t>(config.osd.update_interval_ms, 50));
+        TelemetryState state = beginTelemetry();
+        while (true) {
+            bool active = co_await waitWhileIdle(*reactor);
+            if (!active) {
+                break;
+            }
+            bool elapsed = co_await reactor->sleep(interval);
+            if (!elapsed) {
+                break;
+            }
+            publishTelemetry(state);
+        }
+    }
+
+    TelemetryState beginTelemetry() {
+        sampleScheduling();     // Baseline
+        return {std::chrono::steady_clock::now(), decoded_frames, rtp_receiver->getStatistics().bytes_received};
+    }
+
+    void telemetryLoop() {
+        const auto interval = std::chrono::milliseconds(std::max<uint32_t>(config.osd.update_interval_ms, 50));
+        TelemetryState state = beginTelemetry();
+        while (waitWhileIdle()) {
+            std::this_thread::sleep_for(interval);
+            publishTelemetry(state);
+        }
+    }
+
+    // Worst thread of the interval since the previous call, and of the run
+    void sampleScheduling() {
+        Scheduling interval;
+        std::string switches_thread;
+        std::string run_delay_thread;
+        for (const auto& thread : scheduling_sampler.sample()) {
+            if (thread.avg_run_delay_us > interval.run_delay_us) {
+                interval.run_delay_us = thread.avg_run_delay_us;
+                run_delay_thread = thread.name;
+            }
+            if (thread.new_involuntary_switches > interval.involuntary_switches) {
+                interval.involuntary_switches = thread.new_involuntary_switches;
+                switches_thread = thread.name;
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(scheduling_mutex);
+        scheduling.run_delay_us = interval.run_delay_us;
+        scheduling.involuntary_switches = interval.involuntary_switches;
+        if (interval.run_delay_us > scheduling.max_run_delay_us) {
+            scheduling.max_run_delay_us = interval.run_delay_us;
+            scheduling.max_run_delay_thread = run_delay_thread;
+        }
+        if (interval.involuntary_switches > scheduling.max_involuntary_switches) {
+            scheduling.max_involuntary_switches = interval.involuntary_switches;
+            scheduling.max_switches_thread = switches_thread;
+        }
+    }
+
+    // Samples thread scheduling and feeds the OSD from the session's own
+    // statistics; the overlay skips unchanged text
+    void publishTelemetry(TelemetryState& state) {
+        sampleScheduling();
+        if (!config.osd.enabled) {
+            return;
+        }
+
+        auto now = std::chrono::steady_clock::now();
+        double seconds = std::chrono::duration<double>(now - state.time).count();
+        Statistics stats = getStatistics();
+
+        double fps = seconds > 0 ? (stats.decoded_frames - state.decoded) / seconds : 0.0;
+        double mbps = seconds > 0 ? (stats.receiver.bytes_received - state.bytes) * 8.0 / seconds / 1e6 : 0.0;
+        state.time = now;
+        state.decoded = stats.decoded_frames;
+        state.bytes = stats.receiver.bytes_received;
+
+        char line[64];
+        std::vector<std::string> lines;
+        if (stats.stream_lost) {
+            lines.emplace_back(stats.idle ? "NO SIGNAL  IDLE" : "NO SIGNAL");
+        }
+        std::snprintf(line, sizeof(line), "FPS %5.1f  FRAMES %llu", fps,
+                      static_cast<unsigned long long>(stats.decoded_frames));
+        lines.emplace_back(line);
+        std::snprintf(line, sizeof(line), "RX %6.2f MBIT/S", mbps);
+        lines.emplace_back(line);
+        std::snprintf(line, sizeof(line), "LOST %llu  DROP %llu",
+                      static_cast<unsigned long long>(stats.receiver.packets_lost),
+                      static_cast<unsigned long long>(stats.dropped_frames));
+        lines.emplace_back(line);
+        std::snprintf(line, sizeof(line), "LAT %5.1f MS  QUEUE %zu", stats.decode_latency_us / 1000.0, stats.queue_depth);
+        lines.emplace_back(line);
+        std::snprintf(line, sizeof(line), "FLIP %5.2f MS%s", stats.display.avg_flip_latency_us / 1000.0,
+                      stats.display.async_flips > 0 ? " ASYNC" : "");
+        lines.emplace_back(line);
+        std::snprintf(line, sizeof(line), "SCHED %5.2f MS  PREEMPT %llu", stats.scheduling.run_delay_us / 1000.0,
+                      static_cast<unsigned long long>(stats.scheduling.involuntary_switches));
+        lines.emplace_back(line);
+        if (transport_feedback) {
+            std::snprintf(line, sizeof(line), "BWE %6.2f MBIT/S",
+                          transport_feedback->getStatistics().estimated_bitrate_bps / 1e6);
+            lines.emplace_back(line);
+        }
+
+        decoder->setOsdText(lines);
+    }
+
+    Config config;
+
+    // Components; the recorder outlives the decoder that writes to it
+    std::unique_ptr<FlightRecorder> flight_recorder;
+    std::unique_ptr<V4L2Decoder> decoder;
+    std::unique_ptr<RtpReceiver> rtp_receiver;
+    std::unique_ptr<TransportFeedback> transport_feedback;
+    std::unique_ptr<RtspClient> rtsp_client;
+    std::unique_ptr<FrameServer> frame_server;
+    std::unique_ptr<Watchdog> watchdog;
+    pipeline::ThreadSampler thread_sampler;         // getThreadMetrics()
+    pipeline::ThreadSampler scheduling_sampler;     // Telemetry interval
+    mutable std::mutex scheduling_mutex;
+    Scheduling scheduling;
+
+    // Stages and threads
+    std::unique_ptr<coro::Reactor> reactor;
+    std::unique_ptr<coro::Channel<std::unique_ptr<H264Frame>>> decode_channel;
+    coro::Event frame_submitted;
+    coro::Event stream_resumed;                 // Wakes periodic tasks after idle
+    std::deque<std::chrono::steady_clock::time_point> in_flight;   // Reactor thread only
+    int collected_frames = 0;
+    std::thread reactor_thread;
+    std::unique_ptr<pipeline::Executor> executor;
+    std::unique_ptr<DecodeStage> decode_stage;
+    std::thread telemetry_thread;
+    std::thread stream_monitor_thread;
+    std::atomic<bool> running{false};
+
+    // Statistics
+    std::atomic<uint64_t> decoded_frames{0};
+    std::atomic<uint32_t> received_frames{0};
+    std::atomic<int64_t> decode_latency_us{0};
+    std::atomic<bool> has_sps{false};
+
+    // Stream loss and reacquisition (steady clock, ns)
+    std::atomic<int64_t> last_frame_ns{0};
+    std::atomic<uint32_t> stream_ssrc{0};
+    std::atomic<bool> stream_lost{false};
+    std::atomic<int64_t> reacquire_start_ns{0};     // First frame after the loss
+    std::atomic<int64_t> last_keyframe_request_ns{0};
+    std::atomic<uint64_t> stream_losses{0};
+    std::atomic<uint64_t> keyframe_requests{0};
+    std::atomic<int64_t> last_reacquisition_ms{-1};
+
+    // Low-power idle; transitions hold idle_mutex
+    std::mutex idle_mutex;
+    std::condition_variable idle_changed;
+    std::atomic<bool> idle{false};
+    std::atomic<uint64_t> idle_entries{0};
+};
+
+RtpSession::RtpSession(const Config& config) : impl_(std::make_unique<Impl>(config)) {}
+
+RtpSession::~RtpSession() {
+    impl_->stop();
+}
+
+bool RtpSession::initialize() {
+    return impl_->initialize();
+}
+
+bool RtpSession::start() {
+    return impl_->start();
+}
+
+void RtpSession::stop() {
+    impl_->stop();
+}
+
+bool RtpSession::isRunning() const {
+    return impl_->running;
+}
+
+int RtpSession::addFrameConsumer(V4L2Decoder::FrameConsumer consumer) {
+    return impl_->decoder ? impl_->decoder->addFrameConsumer(std::move(consumer)) : -1;
+}
+
+void RtpSession::removeFrameConsumer(int id) {
+    if (impl_->decoder) {
+        impl_->decoder->removeFrameConsumer(id);
+    }
+}
+
+RtpSession::Statistics RtpSession::getStatistics() const {
+    return impl_->getStatistics();
+}
+
+std::vector<pipeline::ThreadMetrics> RtpSession::getThreadMetrics() {
+    return impl_->thread_sampler.sample();
+}
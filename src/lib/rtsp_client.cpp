@@ -0,0 +1,717 @@
+/**
+ * @file rtsp_client.cpp
+ * @brief Implementation of the RTSP client
+ */
+
+#include "rtsp_client.h"
+#include "transport_feedback.h"
+#include "pipeline.h"
+#include <iostream>
+#include <sstream>
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <chrono>
+#include <cstring>
+#include <cerrno>
+#include <random>
+#include <unistd.h>
+#include <poll.h>
+#include <netdb.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+
+namespace {
+
+constexpr uint8_t START_CODE[4] = {0x00, 0x00, 0x00, 0x01};
+constexpr size_t READ_CHUNK_SIZE = 64 * 1024;
+constexpr uint32_t READER_POLL_MS = 250;
+
+const char BASE64_CHARS[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+std::string base64Encode(const std::string& input) {
+    std::string out;
+    uint32_t value = 0;
+    int bits = -6;
+    for (unsigned char c : input) {
+        value = (value << 8) | c;
+        bits += 8;
+        while (bits >= 0) {
+            out.push_back(BASE64_CHARS[(value >> bits) & 0x3F]);
+            bits -= 6;
+        }
+    }
+    if (bits > -6) {
+        out.push_back(BASE64_CHARS[((value << 8) >> (bits + 8)) & 0x3F]);
+    }
+    while (out.size() % 4) {
+        out.push_back('=');
+    }
+    return out;
+}
+
+bool base64Decode(const std::string& input, std::vector<uint8_t>& out) {
+    out.clear();
+    uint32_t value = 0;
+    int bits = -8;
+    for (char c : input) {
+        if (c == '=') {
+            break;
+        }
+        const char* pos = std::strchr(BASE64_CHARS, c);
+        if (!pos || c == '\0') {
+            return false;
+        }
+        value = (value << 6) | static_cast<uint32_t>(pos - BASE64_CHARS);
+        bits += 6;
+        if (bits >= 0) {
+            out.push_back(static_cast<uint8_t>((value >> bits) & 0xFF));
+            bits -= 8;
+        }
+    }
+    return !out.empty();
+}
+
+std::string toLower(std::string s) {
+    std::transform(s.begin(), s.end(), s.begin(), [](unsigned char c) { return std::tolower(c); });
+    return s;
+}
+
+std::string trim(const std::string& s) {
+    size_t begin = s.find_first_not_of(" \t\r\n");
+    if (begin == std::string::npos) {
+        return "";
+    }
+    size_t end = s.find_last_not_of(" \t\r\n");
+    return s.substr(begin, end - begin + 1);
+}
+
+// Value of "key=value" inside a ';'-separated header such as Transport or Session
+std::string headerParameter(const std::string& header, const std::string& key) {
+    std::stringstream ss(header);
+    std::string item;
+    while (std::getline(ss, item, ';')) {
+        item = trim(item);
+        if (item.compare(0, key.size() + 1, key + "=") == 0) {
+            return item.substr(key.size() + 1);
+        }
+    }
+    return "";
+}
+
+} // namespace
+
+RtspClient::RtspClient(const Config& config)
+    : config_(config), running_(false) {
+    std::random_device rd;
+    local_ssrc_ = static_cast<uint32_t>(rd());
+    depacketizer_.setFrameCallback([this](std::unique_ptr<H264Frame> frame) {
+        if (frame_callback_) {
+            frame_callback_(std::move(frame));
+        }
+    });
+}
+
+RtspClient::~RtspClient() {
+    stop();
+}
+
+void RtspClient::setFrameCallback(FrameCallback callback) {
+    frame_callback_ = std::move(callback);
+}
+
+bool RtspClient::parseUrl() {
+    const std::string prefix = "rtsp://";
+    if (config_.url.compare(0, prefix.size(), prefix) != 0) {
+        std::cerr << "RTSP: unsupported URL " << config_.url << std::endl;
+        return false;
+    }
+
+    std::string rest = config_.url.substr(prefix.size());
+    size_t slash = rest.find('/');
+    std::string authority = rest.substr(0, slash);
+    std::string path = slash == std::string::npos ? "/" : rest.substr(slash);
+
+    size_t at = authority.rfind('@');
+    if (at != std::string::npos) {
+        authorization_ = "Authorization: Basic " + base64Encode(authority.substr(0, at));
+        authority = authority.substr(at + 1);
+    }
+
+    size_t colon = authority.rfind(':');
+    if (colon != std::string::npos) {
+        host_ = authority.substr(0, colon);
+        const char* first = authority.data() + colon + 1;
+        const char* last = authority.data() + authority.size();
+        auto [end, error] = std::from_chars(first, last, port_);
+        if (error != std::errc() || end != last || port_ == 0) {
+            std::cerr << "RTSP: invalid port in URL " << config_.url << std::endl;
+            return false;
+        }
+    } else {
+        host_ = authority;
+    }
+
+    if (host_.empty()) {
+        std::cerr << "RTSP: no host in URL " << config_.url << std::endl;
+        return false;
+    }
+
+    request_url_ = prefix + authority + path;
+    return true;
+}
+
+bool RtspClient::connectSocket() {
+    addrinfo hints = {};
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* result = nullptr;
+    std::string port = std::to_string(port_);
+    if (getaddrinfo(host_.c_str(), port.c_str(), &hints, &result) != 0 || !result) {
+        std::cerr << "RTSP: failed to resolve " << host_ << std::endl;
+        return false;
+    }
+
+    socket_fd_ = socket(result->ai_family, result->ai_socktype | SOCK_CLOEXEC, result->ai_protocol);
+    if (socket_fd_ < 0) {
+        std::cerr << "RTSP: socket error: " << strerror(errno) << std::endl;
+        freeaddrinfo(result);
+        return false;
+    }
+
+    if (connect(socket_fd_, result->ai_addr, result->ai_addrlen) < 0) {
+        std::cerr << "RTSP: connect to " << host_ << ":" << port_ << " failed: " << strerror(errno) << std::endl;
+        freeaddrinfo(result);
+        close(socket_fd_);
+        socket_fd_ = -1;
+        return false;
+    }
+    freeaddrinfo(result);
+
+    // Requests are small and latency matters more than segment count
+    int one = 1;
+    setsockopt(socket_fd_, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    return true;
+}
+
+bool RtspClient::sendRequest(const std::string& method, const std::string& url,
+                             const std::vector<std::string>& extra_headers, int& cseq) {
+    cseq = next_cseq_++;
+
+    std::string request = method + " " + url + " RTSP/1.0\r\n";
+    request += "CSeq: " + std::to_string(cseq) + "\r\n";
+    request += "User-Agent: rtp_player\r\n";
+    if (!authorization_.empty()) {
+        request += authorization_ + "\r\n";
+    }
+    for (const auto& header : extra_headers) {
+        request += header + "\r\n";
+    }
+    request += "\r\n";
+
+    std::lock_guard<std::mutex> lock(send_mutex_);
+    size_t sent = 0;
+    while (sent < request.size()) {
+        ssize_t ret = send(socket_fd_, request.data() + sent, request.size() - sent, MSG_NOSIGNAL);
+        if (ret < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            std::cerr << "RTSP: send error: " << strerror(errno) << std::endl;
+            return false;
+        }
+        sent += static_cast<size_t>(ret);
+    }
+    return true;
+}
+
+bool RtspClient::readMore(uint32_t timeout_ms) {
+    pollfd pfd = {socket_fd_, POLLIN, 0};
+    int ret = ::poll(&pfd, 1, static_cast<int>(timeout_ms));
+    if (ret <= 0) {
+        return false;
+    }
+
+    uint8_t chunk[READ_CHUNK_SIZE];
+    ssize_t received = recv(socket_fd_, chunk, sizeof(chunk), 0);
+    if (received <= 0) {
+        if (received == 0) {
+            std::cerr << "RTSP: connection closed by server" << std::endl;
+            connection_closed_ = true;
+        } else if (errno != EINTR && errno != EAGAIN) {
+            std::cerr << "RTSP: recv error: " << strerror(errno) << std::endl;
+            connection_closed_ = true;
+        }
+        return false;
+    }
+    rx_buffer_.insert(rx_buffer_.end(), chunk, chunk + received);
+    return true;
+}
+
+bool RtspClient::handleInterleavedData() {
+    // '$' <channel> <length:16> <data>
+    if (rx_buffer_.size() < 4) {
+        return false;
+    }
+    size_t length = static_cast<size_t>((rx_buffer_[2] << 8) | rx_buffer_[3]);
+    if (rx_buffer_.size() < 4 + length) {
+        return false;
+    }
+
+    uint8_t channel = rx_buffer_[1];
+    if (channel == rtp_channel_) {
+        (void)depacketizer_.pushPacket(rx_buffer_.data() + 4, length);
+    }
+    rx_buffer_.erase(rx_buffer_.begin(), rx_buffer_.begin() + 4 + length);
+    return true;
+}
+
+bool RtspClient::extractResponse(Response& response) {
+    static const char HEADER_END[] = "\r\n\r\n";
+    auto end = std::search(rx_buffer_.begin(), rx_buffer_.end(), HEADER_END, HEADER_END + 4);
+    if (end == rx_buffer_.end()) {
+        return false;
+    }
+
+    std::string head(rx_buffer_.begin(), end);
+    std::stringstream ss(head);
+    std::string line;
+
+    response = Response{};
+    std::getline(ss, line);
+    if (line.compare(0, 5, "RTSP/") != 0) {
+        std::cerr << "RTSP: unexpected data: " << trim(line) << std::endl;
+        rx_buffer_.erase(rx_buffer_.begin(), end + 4);
+        return false;
+    }
+    size_t space = line.find(' ');
+    response.version = line.substr(0, space);
+    response.status = space != std::string::npos ? std::atoi(line.c_str() + space + 1) : 0;
+
+    while (std::getline(ss, line)) {
+        size_t colon = line.find(':');
+        if (colon == std::string::npos) {
+            continue;
+        }
+        response.headers[toLower(trim(line.substr(0, colon)))] = trim(line.substr(colon + 1));
+    }
+
+    size_t content_length = 0;
+    if (auto it = response.headers.find("content-length"); it != response.headers.end()) {
+        content_length = static_cast<size_t>(std::atoi(it->second.c_str()));
+    }
+    size_t header_size = static_cast<size_t>(end - rx_buffer_.begin()) + 4;
+    if (rx_buffer_.size() < header_size + content_length) {
+        return false;
+    }
+
+    response.body.assign(rx_buffer_.begin() + header_size, rx_buffer_.begin() + header_size + content_length);
+    if (auto it = response.headers.find("cseq"); it != response.headers.end()) {
+        response.cseq = std::atoi(it->second.c_str());
+    }
+    rx_buffer_.erase(rx_buffer_.begin(), rx_buffer_.begin() + header_size + content_length);
+    return true;
+}
+
+bool RtspClient::readResponse(Response& response, uint32_t timeout_ms) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+
+    while (true) {
+        // Interleaved media may arrive in front of the response
+        while (!rx_buffer_.empty() && rx_buffer_[0] == '$') {
+            if (!handleInterleavedData()) {
+                break;
+            }
+        }
+        if (!rx_buffer_.empty() && rx_buffer_[0] != '$' && extractResponse(response)) {
+            return true;
+        }
+
+        auto now = std::chrono::steady_clock::now();
+        if (now >= deadline) {
+            std::cerr << "RTSP: timeout waiting for response" << std::endl;
+            return false;
+        }
+        auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - now).count();
+        (void)readMore(static_cast<uint32_t>(remaining));
+        if (connection_closed_) {
+            return false;
+        }
+    }
+}
+
+bool RtspClient::parseSdp(const std::string& sdp) {
+    std::stringstream ss(sdp);
+    std::string line;
+    bool in_video = false;
+    bool found_video = false;
+    std::string control;
+
+    while (std::getline(ss, line)) {
+        line = trim(line);
+        if (line.compare(0, 2, "m=") == 0) {
+            in_video = line.compare(0, 8, "m=video ") == 0;
+            if (in_video && !found_video) {
+                found_video = true;
+                size_t last_space = line.rfind(' ');
+                payload_type_ = std::atoi(line.c_str() + last_space + 1);
+            } else if (found_video) {
+                in_video = false;
+            }
+            continue;
+        }
+        if (!in_video) {
+            continue;
+        }
+
+        if (line.compare(0, 10, "a=control:") == 0) {
+            control = line.substr(10);
+        } else if (line.compare(0, 7, "a=fmtp:") == 0) {
+            size_t pos = line.find("sprop-parameter-sets=");
+            if (pos == std::string::npos) {
+                continue;
+            }
+            std::string sets = line.substr(pos + 21);
+            sets = sets.substr(0, sets.find_first_of("; "));
+
+            std::stringstream sets_stream(sets);
+            std::string set;
+            parameter_sets_.clear();
+            while (std::getline(sets_stream, set, ',')) {
+                std::vector<uint8_t> nal;
+                if (base64Decode(set, nal)) {
+                    parameter_sets_.insert(parameter_sets_.end(), START_CODE, START_CODE + sizeof(START_CODE));
+                    parameter_sets_.insert(parameter_sets_.end(), nal.begin(), nal.end());
+                }
+            }
+        }
+    }
+
+    if (!found_video) {
+        std::cerr << "RTSP: no video stream in SDP" << std::endl;
+        return false;
+    }
+
+    std::string base = content_base_.empty() ? request_url_ : content_base_;
+    if (control.empty() || control == "*") {
+        control_url_ = base;
+    } else if (control.compare(0, 7, "rtsp://") == 0) {
+        control_url_ = control;
+    } else {
+        control_url_ = base + (base.back() == '/' ? "" : "/") + control;
+    }
+
+    std::cout << "RTSP: video payload type " << payload_type_ << ", control " << control_url_
+              << ", parameter sets " << (parameter_sets_.empty() ? "absent" : "present") << std::endl;
+    return true;
+}
+
+bool RtspClient::describe() {
+    int cseq = 0;
+    if (!sendRequest("DESCRIBE", request_url_, {"Accept: application/sdp"}, cseq)) {
+        return false;
+    }
+
+    Response response;
+    if (!readResponse(response, config_.timeout_ms)) {
+        return false;
+    }
+    if (response.status != 200) {
+        std::cerr << "RTSP: DESCRIBE failed with status " << response.status
+                  << (response.status == 401 ? " (only Basic authentication is supported)" : "") << std::endl;
+        return false;
+    }
+
+    // Some servers open the session at DESCRIBE; then PLAY needs no speculation
+    if (auto it = response.headers.find("session"); it != response.headers.end()) {
+        session_id_ = it->second.substr(0, it->second.find(';'));
+    }
+
+    if (auto it = response.headers.find("content-base"); it != response.headers.end()) {
+        content_base_ = it->second;
+    } else if (auto loc = response.headers.find("content-location"); loc != response.headers.end()) {
+        content_base_ = loc->second;
+    }
+
+    return parseSdp(response.body);
+}
+
+RtspClient::SetupResult RtspClient::setupAndPlay(bool tcp) {
+    std::string transport = tcp
+        ? "Transport: RTP/AVP/TCP;unicast;interleaved=0-1"
+        : "Transport: RTP/AVP;unicast;client_port=" + std::to_string(config_.client_rtp_port) + "-" +
+          std::to_string(config_.client_rtp_port + 1);
+
+    // SETUP and PLAY back to back, so the stream starts one round trip after
+    // DESCRIBE. Without a session id yet the PLAY is speculative: servers
+    // that know Pipelined-Requests (RTSP 2.0) bind it to the SETUP and some
+    // others take it as is; the rest answer 454 together with SETUP and PLAY
+    // is resent with the id, which costs no more than waiting for SETUP
+    std::vector<std::string> setup_headers = {transport};
+    std::vector<std::string> play_headers = {"Range: npt=0.000-"};
+    if (!session_id_.empty()) {
+        setup_headers.push_back("Session: " + session_id_);
+        play_headers.push_back("Session: " + session_id_);
+    }
+    bool pipelined = speculative_play_ || !session_id_.empty();
+    if (pipelined) {
+        setup_headers.push_back("Pipelined-Requests: 1");
+        play_headers.push_back("Pipelined-Requests: 1");
+    }
+
+    int setup_cseq = 0;
+    int play_cseq = -1;
+    if (!sendRequest("SETUP", control_url_, setup_headers, setup_cseq) ||
+        (pipelined && !sendRequest("PLAY", request_url_, play_headers, play_cseq))) {
+        return SetupResult::FAILED;
+    }
+
+    Response setup_response;
+    Response play_response;
+    bool have_setup = false;
+    bool have_play = !pipelined;
+    while (!have_setup || !have_play) {
+        Response response;
+        if (!readResponse(response, config_.timeout_ms)) {
+            return SetupResult::FAILED;
+        }
+        if (response.cseq == setup_cseq) {
+            setup_response = std::move(response);
+            have_setup = true;
+        } else if (response.cseq == play_cseq) {
+            play_response = std::move(response);
+            have_play = true;
+        }
+    }
+
+    if (setup_response.status == 461) {
+        return SetupResult::UNSUPPORTED_TRANSPORT;
+    }
+    if (setup_response.status != 200) {
+        std::cerr << "RTSP: SETUP failed with status " << setup_response.status << std::endl;
+        return SetupResult::FAILED;
+    }
+
+    if (auto it = setup_response.headers.find("session"); it != setup_response.headers.end()) {
+        session_id_ = it->second.substr(0, it->second.find(';'));
+        std::string timeout = headerParameter(it->second, "timeout");
+        if (!timeout.empty()) {
+            session_timeout_s_ = std::max(2, std::atoi(timeout.c_str()));
+        }
+    }
+    if (auto it = setup_response.headers.find("transport"); it != setup_response.headers.end()) {
+        std::string ssrc = headerParameter(it->second, "ssrc");
+        if (!ssrc.empty()) {
+            uint32_t value = 0;
+            auto [end, error] = std::from_chars(ssrc.data(), ssrc.data() + ssrc.size(), value, 16);
+            if (error != std::errc() || end != ssrc.data() + ssrc.size()) {
+                std::cerr << "RTSP: invalid ssrc in Transport header: " << ssrc << std::endl;
+                return SetupResult::FAILED;
+            }
+            media_ssrc_ = value;
+        }
+        std::string server_port = headerParameter(it->second, "server_port");
+        size_t dash = server_port.find('-');
+        if (dash != std::string::npos) {
+            server_rtcp_port_ = static_cast<uint16_t>(std::atoi(server_port.c_str() + dash + 1));
+        }
+        std::string channels = headerParameter(it->second, "interleaved");
+        if (tcp && !channels.empty()) {
+            rtp_channel_ = static_cast<uint8_t>(std::atoi(channels.c_str()));
+            size_t channel_dash = channels.find('-');
+            rtcp_channel_ = channel_dash != std::string::npos
+                ? static_cast<uint8_t>(std::atoi(channels.c_str() + channel_dash + 1))
+                : static_cast<uint8_t>(rtp_channel_ + 1);
+        }
+    }
+    interleaved_ = tcp;
+
+    if (!pipelined || play_response.status != 200) {
+        if (pipelined) {
+            std::cout << "RTSP: pipelined PLAY rejected (" << play_response.status << "), retrying with session" << std::endl;
+            // Not worth another error on the TCP fallback or the next start
+            speculative_play_ = false;
+        }
+        if (!sendRequest("PLAY", request_url_, {"Range: npt=0.000-", "Session: " + session_id_}, play_cseq)) {
+            return SetupResult::FAILED;
+        }
+        do {
+            if (!readResponse(play_response, config_.timeout_ms)) {
+                return SetupResult::FAILED;
+            }
+        } while (play_response.cseq != play_cseq);
+
+        if (play_response.status != 200) {
+            std::cerr << "RTSP: PLAY failed with status " << play_response.status << std::endl;
+            return SetupResult::FAILED;
+        }
+    }
+
+    return SetupResult::OK;
+}
+
+void RtspClient::deliverParameterSets() {
+    if (parameter_sets_.empty() || !frame_callback_) {
+        return;
+    }
+    auto frame = std::make_unique<H264Frame>();
+    frame->data = parameter_sets_;
+    frame_callback_(std::move(frame));
+    std::cout << "✅ RTSP: decoder primed with SPS/PPS from SDP" << std::endl;
+}
+
+bool RtspClient::start() {
+    if (running_) {
+        return true;
+    }
+
+    auto start_time = std::chrono::steady_clock::now();
+
+    if (!parseUrl() || !connectSocket()) {
+        return false;
+    }
+
+    if (!describe()) {
+        stop();
+        return false;
+    }
+    depacketizer_.setPayloadType(payload_type_);
+
+    // Deliver SPS/PPS right away so the decoder does not wait for the first in-band SPS
+    deliverParameterSets();
+
+    SetupResult result = SetupResult::UNSUPPORTED_TRANSPORT;
+    if (config_.transport != Transport::TCP) {
+        result = setupAndPlay(false);
+    }
+    if (result == SetupResult::UNSUPPORTED_TRANSPORT && config_.transport != Transport::UDP) {
+        std::cout << "RTSP: falling back to interleaved RTP over TCP" << std::endl;
+        result = setupAndPlay(true);
+    }
+    if (result != SetupResult::OK) {
+        stop();
+        return false;
+    }
+
+    // RTCP towards the server when RTP runs over UDP, bound to the RTCP port we announced
+    if (!interleaved_ && server_rtcp_port_ != 0) {
+        rtcp_socket_fd_ = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+        if (rtcp_socket_fd_ >= 0) {
+            sockaddr_in local = {};
+            local.sin_family = AF_INET;
+            local.sin_addr.s_addr = htonl(INADDR_ANY);
+            local.sin_port = htons(static_cast<uint16_t>(config_.client_rtp_port + 1));
+            (void)bind(rtcp_socket_fd_, reinterpret_cast<sockaddr*>(&local), sizeof(local));
+
+            addrinfo hints = {};
+            hints.ai_family = AF_INET;
+            hints.ai_socktype = SOCK_DGRAM;
+            addrinfo* result_addr = nullptr;
+            std::string port = std::to_string(server_rtcp_port_);
+            if (getaddrinfo(host_.c_str(), port.c_str(), &hints, &result_addr) == 0 && result_addr) {
+                (void)connect(rtcp_socket_fd_, result_addr->ai_addr, result_addr->ai_addrlen);
+                freeaddrinfo(result_addr);
+            }
+        }
+    }
+
+    running_ = true;
+    (void)requestKeyframe();
+
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start_time);
+    std::cout << "✅ RTSP session started in " << elapsed.count() << " ms ("
+              << (interleaved_ ? "interleaved TCP" : "UDP") << ", session " << session_id_ << ")" << std::endl;
+
+    reader_thread_ = std::thread(&RtspClient::readerLoop, this);
+    pipeline::setThreadName(reader_thread_, "rtsp-reader");
+    return true;
+}
+
+bool RtspClient::requestKeyframe() {
+    std::vector<uint8_t> pli = TransportFeedback::buildPictureLossIndication(local_ssrc_, media_ssrc_);
+
+    if (interleaved_) {
+        std::vector<uint8_t> framed = {'$', rtcp_channel_,
+                                       static_cast<uint8_t>(pli.size() >> 8), static_cast<uint8_t>(pli.size())};
+        framed.insert(framed.end(), pli.begin(), pli.end());
+        std::lock_guard<std::mutex> lock(send_mutex_);
+        return send(socket_fd_, framed.data(), framed.size(), MSG_NOSIGNAL) == static_cast<ssize_t>(framed.size());
+    }
+
+    if (rtcp_socket_fd_ >= 0) {
+        sendUdpRtcp(pli);
+        return true;
+    }
+    return false;
+}
+
+void RtspClient::sendUdpRtcp(const std::vector<uint8_t>& packet) {
+    if (send(rtcp_socket_fd_, packet.data(), packet.size(), 0) < 0 && errno != ECONNREFUSED) {
+        std::cerr << "RTSP: RTCP send error: " << strerror(errno) << std::endl;
+    }
+}
+
+bool RtspClient::sendKeepAlive() {
+    int cseq = 0;
+    return sendRequest("GET_PARAMETER", request_url_, {"Session: " + session_id_}, cseq);
+}
+
+void RtspClient::readerLoop() {
+    auto last_keepalive = std::chrono::steady_clock::now();
+    auto keepalive_interval = std::chrono::seconds(session_timeout_s_ / 2);
+
+    while (running_) {
+        (void)readMore(READER_POLL_MS);
+        if (connection_closed_) {
+            running_ = false;
+            break;
+        }
+
+        while (!rx_buffer_.empty()) {
+            if (rx_buffer_[0] == '$') {
+                if (!handleInterleavedData()) {
+                    break;
+                }
+            } else {
+                // Keep-alive responses and anything else the server sends
+                Response response;
+                if (!extractResponse(response)) {
+                    break;
+                }
+            }
+        }
+
+        auto now = std::chrono::steady_clock::now();
+        if (now - last_keepalive >= keepalive_interval) {
+            (void)sendKeepAlive();
+            last_keepalive = now;
+        }
+    }
+}
+
+void RtspClient::stop() {
+    bool was_running = running_.exchange(false);
+    if (reader_thread_.joinable()) {
+        reader_thread_.join();
+    }
+
+    if (socket_fd_ >= 0) {
+        if (was_running && !connection_closed_ && !session_id_.empty()) {
+            int cseq = 0;
+            (void)sendRequest("TEARDOWN", request_url_, {"Session: " + session_id_}, cseq);
+        }
+        close(socket_fd_);
+        socket_fd_ = -1;
+    }
+    if (rtcp_socket_fd_ >= 0) {
+        close(rtcp_socket_fd_);
+        rtcp_socket_fd_ = -1;
+    }
+    rx_buffer_.clear();
+    connection_closed_ = false;
+    session_id_.clear();
+    interleaved_ = false;
+    depacketizer_.reset();
+}
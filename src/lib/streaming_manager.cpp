@@ -2,6 +2,7 @@
 #include "v4l2_device.h"
 #include "dma_buffers_manager.h"
 #include <iostream>
+#include <numeric>
 #include <unistd.h> // For usleep
 
 StreamingManager::StreamingManager(V4L2Device& device, DmaBuffersManager& output_buffers)
@@ -22,6 +23,12 @@ void StreamingManager::set_inactive() {
 }
 
 bool StreamingManager::start() {
+    std::vector<unsigned int> all(output_buffers_.count());
+    std::iota(all.begin(), all.end(), 0u);
+    return start(all);
+}
+
+bool StreamingManager::start(const std::vector<unsigned int>& capture_buffers) {
     if (state_ == State::ACTIVE) {
         std::cout << "Streaming is already active" << std::endl;
         return true;
@@ -29,7 +36,7 @@ bool StreamingManager::start() {
 
     state_ = State::STARTING;
 
-    if (!queueOutputBuffers()) {
+    if (!queueOutputBuffers(capture_buffers)) {
         state_ = State::ERROR;
         return false;
     }
@@ -62,10 +69,10 @@ bool StreamingManager::stop() {
     return true;
 }
 
-bool StreamingManager::queueOutputBuffers() {
-    std::cout << "Queuing " << output_buffers_.count() << " output buffers..." << std::endl;
+bool StreamingManager::queueOutputBuffers(const std::vector<unsigned int>& indices) {
+    std::cout << "Queuing " << indices.size() << " output buffers..." << std::endl;
 
-    for (unsigned int i = 0; i < output_buffers_.count(); ++i) {
+    for (unsigned int i : indices) {
         if (!queueOutputBuffer(i)) {
             std::cerr << "❌ Error queuing buffer " << i << std::endl;
             return false;
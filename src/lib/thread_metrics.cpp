@@ -0,0 +1,119 @@
+#include "thread_metrics.h"
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <dirent.h>
+
+namespace pipeline {
+
+namespace {
+
+// /proc/self/task/<tid>/stat: fields after the parenthesized name, which may contain spaces
+bool readStat(const std::string& dir, int& cpu, int& priority, int& policy) {
+    std::ifstream file(dir + "/stat");
+    std::string line;
+    if (!std::getline(file, line)) {
+        return false;
+    }
+    size_t end = line.rfind(')');
+    if (end == std::string::npos) {
+        return false;
+    }
+    std::istringstream fields(line.substr(end + 2));
+    std::string field;
+    // Field 3 (state) is the first after the name; processor is 39, rt_priority 40, policy 41
+    for (int index = 3; index <= 41 && fields >> field; ++index) {
+        if (index == 39) {
+            cpu = std::stoi(field);
+        } else if (index == 40) {
+            priority = std::stoi(field);
+        } else if (index == 41) {
+            policy = std::stoi(field);
+        }
+    }
+    return true;
+}
+
+bool readSchedstat(const std::string& dir, uint64_t& cpu_ns, uint64_t& run_delay_ns, uint64_t& slices) {
+    std::ifstream file(dir + "/schedstat");
+    return static_cast<bool>(file >> cpu_ns >> run_delay_ns >> slices);
+}
+
+void readSwitches(const std::string& dir, uint64_t& voluntary, uint64_t& involuntary) {
+    std::ifstream file(dir + "/status");
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.rfind("voluntary_ctxt_switches:", 0) == 0) {
+            voluntary = std::stoull(line.substr(line.find(':') + 1));
+        } else if (line.rfind("nonvoluntary_ctxt_switches:", 0) == 0) {
+            involuntary = std::stoull(line.substr(line.find(':') + 1));
+        }
+    }
+}
+
+} // namespace
+
+std::vector<ThreadMetrics> ThreadSampler::sample() {
+    std::vector<ThreadMetrics> threads;
+    DIR* tasks = opendir("/proc/self/task");
+    if (!tasks) {
+        return threads;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto now = std::chrono::steady_clock::now();
+    double elapsed_ns = last_sample_ == std::chrono::steady_clock::time_point{}
+                            ? 0.0
+                            : std::chrono::duration<double, std::nano>(now - last_sample_).count();
+    std::map<pid_t, Previous> current;
+
+    while (dirent* entry = readdir(tasks)) {
+        if (entry->d_name[0] < '0' || entry->d_name[0] > '9') {
+            continue;
+        }
+        std::string dir = std::string("/proc/self/task/") + entry->d_name;
+        ThreadMetrics metrics;
+        metrics.tid = static_cast<pid_t>(std::stol(entry->d_name));
+        std::ifstream comm(dir + "/comm");
+        std::getline(comm, metrics.name);
+
+        // The thread may exit between the directory listing and these reads
+        Previous counters;
+        try {
+            if (!readStat(dir, metrics.cpu, metrics.priority, metrics.policy) ||
+                !readSchedstat(dir, counters.cpu_ns, counters.run_delay_ns, counters.slices)) {
+                continue;
+            }
+            readSwitches(dir, metrics.voluntary_switches, metrics.involuntary_switches);
+        } catch (const std::exception&) {
+            continue;
+        }
+        counters.involuntary_switches = metrics.involuntary_switches;
+        metrics.cpu_time_us = counters.cpu_ns / 1000;
+        metrics.run_delay_us = counters.run_delay_ns / 1000;
+
+        if (elapsed_ns > 0) {
+            // A thread missing from the previous sample started since: all of its counters are new
+            auto previous = previous_.find(metrics.tid);
+            const Previous before = previous != previous_.end() ? previous->second : Previous{};
+            metrics.cpu_percent = 100.0 * static_cast<double>(counters.cpu_ns - before.cpu_ns) / elapsed_ns;
+            uint64_t slices = counters.slices - before.slices;
+            if (slices > 0) {
+                metrics.avg_run_delay_us =
+                    static_cast<double>(counters.run_delay_ns - before.run_delay_ns) / 1000.0 / slices;
+            }
+            metrics.new_involuntary_switches = counters.involuntary_switches - before.involuntary_switches;
+        }
+        current[metrics.tid] = counters;
+        threads.push_back(std::move(metrics));
+    }
+    closedir(tasks);
+
+    previous_.swap(current);
+    last_sample_ = now;
+    std::sort(threads.begin(), threads.end(),
+              [](const ThreadMetrics& a, const ThreadMetrics& b) { return a.tid < b.tid; });
+    return threads;
+}
+
+} // namespace pipeline
@@ -0,0 +1,543 @@
+/**
+ * @file transport_feedback.cpp
+ * @brief Implementation of TWCC / REMB receiver feedback
+ */
+
+#include "transport_feedback.h"
+#include "pipeline.h"
+#include <iostream>
+#include <cstring>
+#include <cerrno>
+#include <random>
+#include <algorithm>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+namespace {
+
+constexpr uint8_t RTCP_PT_RR = 201;
+constexpr uint8_t RTCP_PT_RTPFB = 205;
+constexpr uint8_t RTCP_PT_PSFB = 206;
+constexpr uint8_t RTPFB_FMT_TWCC = 15;
+constexpr uint8_t PSFB_FMT_PLI = 1;
+constexpr uint8_t PSFB_FMT_AFB = 15;
+
+constexpr int64_t DELTA_TICK_US = 250;        // Receive delta resolution
+constexpr int64_t REFERENCE_TICK_US = 64000;  // Reference time resolution
+constexpr size_t MAX_STATUS_PER_PACKET = 500; // Keeps a feedback packet below the MTU
+
+// Delay-based estimator tuning (values follow the GCC draft)
+constexpr size_t TRENDLINE_WINDOW = 20;
+constexpr double TRENDLINE_SMOOTHING = 0.9;
+constexpr double TRENDLINE_GAIN = 4.0;
+constexpr double OVERUSE_THRESHOLD_MS = 12.5;
+constexpr double DECREASE_FACTOR = 0.85;
+constexpr double INCREASE_PER_SECOND = 0.08;
+constexpr int64_t DECREASE_INTERVAL_US = 300000;
+constexpr int64_t RATE_WINDOW_US = 1000000;
+
+enum PacketStatus : uint8_t {
+    NOT_RECEIVED = 0,
+    SMALL_DELTA = 1,
+    LARGE_DELTA = 2
+};
+
+void put16(std::vector<uint8_t>& out, uint16_t v) {
+    out.push_back(static_cast<uint8_t>(v >> 8));
+    out.push_back(static_cast<uint8_t>(v));
+}
+
+void put32(std::vector<uint8_t>& out, uint32_t v) {
+    put16(out, static_cast<uint16_t>(v >> 16));
+    put16(out, static_cast<uint16_t>(v));
+}
+
+void writeRtcpHeader(std::vector<uint8_t>& out, size_t offset, uint8_t count, uint8_t type, bool padding) {
+    size_t length_words = (out.size() - offset) / 4 - 1;
+    out[offset] = static_cast<uint8_t>(0x80 | (padding ? 0x20 : 0x00) | (count & 0x1F));
+    out[offset + 1] = type;
+    out[offset + 2] = static_cast<uint8_t>(length_words >> 8);
+    out[offset + 3] = static_cast<uint8_t>(length_words);
+}
+
+int64_t toMicros(std::chrono::steady_clock::time_point tp) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(tp.time_since_epoch()).count();
+}
+
+} // namespace
+
+TransportFeedback::TransportFeedback(const Config& config)
+    : config_(config), running_(false) {
+    std::random_device rd;
+    sender_ssrc_ = (static_cast<uint32_t>(rd()) << 1) | 1;
+}
+
+TransportFeedback::~TransportFeedback() {
+    stop();
+    if (socket_fd_ >= 0) {
+        close(socket_fd_);
+        socket_fd_ = -1;
+    }
+}
+
+bool TransportFeedback::initialize() {
+    if (config_.remote_ip.empty() || config_.remote_port == 0) {
+        std::cerr << "Transport feedback: sender RTCP address not configured" << std::endl;
+        return false;
+    }
+
+    socket_fd_ = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (socket_fd_ < 0) {
+        std::cerr << "Transport feedback: socket error: " << strerror(errno) << std::endl;
+        return false;
+    }
+
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(config_.remote_port);
+    if (inet_pton(AF_INET, config_.remote_ip.c_str(), &addr.sin_addr) != 1) {
+        std::cerr << "Transport feedback: invalid address " << config_.remote_ip << std::endl;
+        close(socket_fd_);
+        socket_fd_ = -1;
+        return false;
+    }
+
+    if (connect(socket_fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+        std::cerr << "Transport feedback: connect error: " << strerror(errno) << std::endl;
+        close(socket_fd_);
+        socket_fd_ = -1;
+        return false;
+    }
+
+    estimated_bitrate_ = config_.min_bitrate_bps;
+
+    std::cout << "Transport feedback initialized: " << config_.remote_ip << ":" << config_.remote_port
+              << " (TWCC " << (config_.enable_twcc ? "on" : "off")
+              << ", REMB " << (config_.enable_remb ? "on" : "off")
+              << ", extension id " << static_cast<int>(config_.extension_id) << ")" << std::endl;
+    return true;
+}
+
+bool TransportFeedback::start() {
+    if (socket_fd_ < 0) {
+        std::cerr << "Transport feedback not initialized" << std::endl;
+        return false;
+    }
+    if (running_) {
+        return true;
+    }
+    running_ = true;
+    feedback_thread_ = std::thread(&TransportFeedback::feedbackLoop, this);
+    pipeline::setThreadName(feedback_thread_, "twcc-feedback");
+    return true;
+}
+
+void TransportFeedback::stop() {
+    if (!running_) {
+        return;
+    }
+    {
+        // Under the lock: the loop may wait without a timeout
+        std::lock_guard<std::mutex> lock(wake_mutex_);
+        running_ = false;
+    }
+    wake_condition_.notify_all();
+    if (feedback_thread_.joinable()) {
+        feedback_thread_.join();
+    }
+}
+
+bool TransportFeedback::parseTransportSequence(uint16_t profile, const uint8_t* data, size_t length,
+                                               uint8_t extension_id, uint16_t& transport_seq) {
+    if (!data || length == 0) {
+        return false;
+    }
+
+    if (profile == 0xBEDE) {
+        // One-byte header elements (RFC 8285, section 4.2)
+        size_t i = 0;
+        while (i < length) {
+            uint8_t id = data[i] >> 4;
+            size_t len = (data[i] & 0x0F) + 1;
+            if (data[i] == 0) { // Padding
+                i++;
+                continue;
+            }
+            if (id == 15) {
+                break;
+            }
+            if (i + 1 + len > length) {
+                break;
+            }
+            if (id == extension_id && len >= 2) {
+                transport_seq = static_cast<uint16_t>((data[i + 1] << 8) | data[i + 2]);
+                return true;
+            }
+            i += 1 + len;
+        }
+    } else if ((profile & 0xFFF0) == 0x1000) {
+        // Two-byte header elements (RFC 8285, section 4.3)
+        size_t i = 0;
+        while (i + 1 < length) {
+            uint8_t id = data[i];
+            if (id == 0) {
+                i++;
+                continue;
+            }
+            size_t len = data[i + 1];
+            if (i + 2 + len > length) {
+                break;
+            }
+            if (id == extension_id && len >= 2) {
+                transport_seq = static_cast<uint16_t>((data[i + 2] << 8) | data[i + 3]);
+                return true;
+            }
+            i += 2 + len;
+        }
+    }
+    return false;
+}
+
+void TransportFeedback::onPacketArrival(uint16_t transport_seq, uint32_t media_ssrc, uint32_t rtp_timestamp,
+                                        size_t size, std::chrono::steady_clock::time_point arrival) {
+    int64_t arrival_us = toMicros(arrival);
+
+    // The first arrival after a report wakes the idle feedback loop
+    if (!arrivals_pending_.load(std::memory_order_relaxed)) {
+        {
+            std::lock_guard<std::mutex> wake_lock(wake_mutex_);
+            arrivals_pending_ = true;
+        }
+        wake_condition_.notify_one();
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    media_ssrc_ = media_ssrc;
+
+    // Start one wrap period in so that reordered packets never unwrap below zero
+    int64_t unwrapped = transport_seq + 0x10000;
+    if (last_unwrapped_seq_ >= 0) {
+        int16_t diff = static_cast<int16_t>(transport_seq - static_cast<uint16_t>(last_unwrapped_seq_));
+        unwrapped = last_unwrapped_seq_ + diff;
+    }
+    last_unwrapped_seq_ = std::max(last_unwrapped_seq_, unwrapped);
+
+    // Packets older than the last reported window are already accounted as lost
+    if (config_.enable_twcc && (next_feedback_seq_ < 0 || unwrapped >= next_feedback_seq_)) {
+        arrivals_.emplace(unwrapped, arrival_us);
+    }
+
+    stats_.packets_recorded++;
+
+    if (config_.enable_remb) {
+        updateDelayEstimate(rtp_timestamp, arrival_us, size);
+    }
+}
+
+void TransportFeedback::updateDelayEstimate(uint32_t rtp_timestamp, int64_t arrival_us, size_t size) {
+    if (first_arrival_us_ == 0) {
+        first_arrival_us_ = arrival_us;
+        last_estimate_update_us_ = arrival_us;
+    }
+
+    // Incoming rate over a sliding window
+    rate_window_.emplace_back(arrival_us, size);
+    while (!rate_window_.empty() && arrival_us - rate_window_.front().first > RATE_WINDOW_US) {
+        rate_window_.pop_front();
+    }
+    size_t window_bytes = 0;
+    for (const auto& [t, bytes] : rate_window_) {
+        window_bytes += bytes;
+    }
+    double incoming_bps = window_bytes * 8.0 * 1e6 / RATE_WINDOW_US;
+    stats_.incoming_bitrate_bps = static_cast<uint32_t>(incoming_bps);
+
+    // Packets of one frame share an RTP timestamp and form one group
+    if (have_group_ && rtp_timestamp == group_rtp_timestamp_) {
+        group_arrival_us_ = arrival_us;
+        return;
+    }
+
+    if (have_group_) {
+        double inter_arrival_ms = (arrival_us - group_arrival_us_) / 1000.0;
+        double inter_departure_ms = static_cast<int32_t>(rtp_timestamp - group_rtp_timestamp_) / 90.0;
+        accumulated_delay_ms_ += inter_arrival_ms - inter_departure_ms;
+        smoothed_delay_ms_ = TRENDLINE_SMOOTHING * smoothed_delay_ms_ +
+                             (1.0 - TRENDLINE_SMOOTHING) * accumulated_delay_ms_;
+
+        delay_window_.push_back({(arrival_us - first_arrival_us_) / 1000.0, smoothed_delay_ms_});
+        if (delay_window_.size() > TRENDLINE_WINDOW) {
+            delay_window_.pop_front();
+        }
+    }
+    have_group_ = true;
+    group_rtp_timestamp_ = rtp_timestamp;
+    group_arrival_us_ = arrival_us;
+
+    if (delay_window_.size() < TRENDLINE_WINDOW) {
+        return;
+    }
+
+    // Least squares slope of smoothed delay over arrival time
+    double mean_x = 0.0, mean_y = 0.0;
+    for (const auto& s : delay_window_) {
+        mean_x += s.arrival_ms;
+        mean_y += s.smoothed_delay_ms;
+    }
+    mean_x /= delay_window_.size();
+    mean_y /= delay_window_.size();
+    double num = 0.0, den = 0.0;
+    for (const auto& s : delay_window_) {
+        num += (s.arrival_ms - mean_x) * (s.smoothed_delay_ms - mean_y);
+        den += (s.arrival_ms - mean_x) * (s.arrival_ms - mean_x);
+    }
+    double slope = den > 0.0 ? num / den : 0.0;
+    double trend = slope * TRENDLINE_WINDOW * TRENDLINE_GAIN;
+    stats_.delay_trend = trend;
+
+    double elapsed_s = (arrival_us - last_estimate_update_us_) / 1e6;
+    if (trend > OVERUSE_THRESHOLD_MS) {
+        // Queues are building up: back off below the measured throughput
+        if (arrival_us - last_estimate_update_us_ >= DECREASE_INTERVAL_US && incoming_bps > 0.0) {
+            estimated_bitrate_ = DECREASE_FACTOR * incoming_bps;
+            last_estimate_update_us_ = arrival_us;
+        }
+    } else if (trend >= -OVERUSE_THRESHOLD_MS) {
+        // Normal: probe upwards, but never far beyond what actually arrives
+        estimated_bitrate_ *= 1.0 + INCREASE_PER_SECOND * std::min(elapsed_s, 1.0);
+        estimated_bitrate_ = std::min(estimated_bitrate_, 1.5 * incoming_bps + 10000.0);
+        last_estimate_update_us_ = arrival_us;
+    } else {
+        // Underuse: queues are draining, hold the estimate
+        last_estimate_update_us_ = arrival_us;
+    }
+
+    estimated_bitrate_ = std::clamp(estimated_bitrate_,
+                                    static_cast<double>(config_.min_bitrate_bps),
+                                    static_cast<double>(config_.max_bitrate_bps));
+    stats_.estimated_bitrate_bps = static_cast<uint32_t>(estimated_bitrate_);
+}
+
+void TransportFeedback::feedbackLoop() {
+    while (running_) {
+        {
+            std::unique_lock<std::mutex> lock(wake_mutex_);
+            // Nothing to report while no media arrives (idle): sleep until a packet does
+            wake_condition_.wait(lock, [this] { return arrivals_pending_ || !running_; });
+            wake_condition_.wait_for(lock, std::chrono::milliseconds(config_.feedback_interval_ms),
+                                     [this] { return !running_; });
+            arrivals_pending_ = false;
+        }
+        if (!running_) {
+            break;
+        }
+        sendFeedback();
+    }
+}
+
+void TransportFeedback::sendFeedback() {
+    std::vector<std::vector<uint8_t>> twcc_packets;
+    std::vector<uint8_t> remb;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (config_.enable_twcc) {
+            buildTwccPackets(twcc_packets);
+        }
+        if (config_.enable_remb && stats_.estimated_bitrate_bps > 0) {
+            buildRemb(remb);
+        }
+    }
+
+    if (twcc_packets.empty() && remb.empty()) {
+        return;
+    }
+
+    // Compound packet: an empty receiver report followed by the feedback messages
+    std::vector<uint8_t> compound;
+    put32(compound, 0);
+    put32(compound, sender_ssrc_);
+    writeRtcpHeader(compound, 0, 0, RTCP_PT_RR, false);
+
+    for (const auto& twcc : twcc_packets) {
+        std::vector<uint8_t> packet = compound;
+        packet.insert(packet.end(), twcc.begin(), twcc.end());
+        bool with_remb = !remb.empty();
+        if (with_remb) {
+            packet.insert(packet.end(), remb.begin(), remb.end());
+            remb.clear();
+        }
+        if (sendPacket(packet)) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stats_.feedback_packets_sent++;
+            if (with_remb) {
+                stats_.remb_packets_sent++;
+            }
+        }
+    }
+
+    if (!remb.empty()) {
+        compound.insert(compound.end(), remb.begin(), remb.end());
+        if (sendPacket(compound)) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stats_.remb_packets_sent++;
+        }
+    }
+}
+
+void TransportFeedback::buildTwccPackets(std::vector<std::vector<uint8_t>>& packets) {
+    if (arrivals_.empty()) {
+        return;
+    }
+
+    if (next_feedback_seq_ < 0) {
+        next_feedback_seq_ = arrivals_.begin()->first;
+    }
+
+    int64_t last_seq = arrivals_.rbegin()->first;
+
+    while (next_feedback_seq_ <= last_seq) {
+        int64_t base_seq = next_feedback_seq_;
+
+        // The reference time is taken from the first received packet in this window
+        auto first_it = arrivals_.lower_bound(base_seq);
+        if (first_it == arrivals_.end()) {
+            break;
+        }
+        int64_t reference_ticks = first_it->second / REFERENCE_TICK_US;
+        int64_t previous_us = reference_ticks * REFERENCE_TICK_US;
+
+        std::vector<uint8_t> statuses;
+        std::vector<int32_t> deltas;
+        int64_t seq = base_seq;
+        for (; seq <= last_seq && statuses.size() < MAX_STATUS_PER_PACKET; ++seq) {
+            auto it = arrivals_.find(seq);
+            if (it == arrivals_.end()) {
+                statuses.push_back(NOT_RECEIVED);
+                continue;
+            }
+            int64_t delta_ticks = (it->second - previous_us) / DELTA_TICK_US;
+            if (delta_ticks < INT16_MIN || delta_ticks > INT16_MAX) {
+                // Not representable: the remaining packets go into the next feedback message
+                break;
+            }
+            statuses.push_back(delta_ticks >= 0 && delta_ticks <= 0xFF ? SMALL_DELTA : LARGE_DELTA);
+            deltas.push_back(static_cast<int32_t>(delta_ticks));
+            previous_us += delta_ticks * DELTA_TICK_US;
+        }
+
+        if (statuses.empty()) {
+            break;
+        }
+
+        std::vector<uint8_t> packet;
+        put32(packet, 0); // Header placeholder
+        put32(packet, sender_ssrc_);
+        put32(packet, media_ssrc_);
+        put16(packet, static_cast<uint16_t>(base_seq));
+        put16(packet, static_cast<uint16_t>(statuses.size()));
+        put32(packet, (static_cast<uint32_t>(reference_ticks) & 0xFFFFFF) << 8 | feedback_count_++);
+
+        // Packet status chunks: run-length for long runs, 2-bit status vectors otherwise
+        size_t i = 0;
+        while (i < statuses.size()) {
+            size_t run = 1;
+            while (i + run < statuses.size() && statuses[i + run] == statuses[i] && run < 0x1FFF) {
+                run++;
+            }
+            if (run >= 7) {
+                put16(packet, static_cast<uint16_t>((statuses[i] << 13) | run));
+                i += run;
+            } else {
+                uint16_t chunk = 0xC000; // Status vector, two bits per symbol
+                for (size_t k = 0; k < 7; ++k) {
+                    uint8_t symbol = i + k < statuses.size() ? statuses[i + k] : static_cast<uint8_t>(NOT_RECEIVED);
+                    chunk |= static_cast<uint16_t>(symbol << (2 * (6 - k)));
+                }
+                put16(packet, chunk);
+                i += 7;
+            }
+        }
+
+        // Receive deltas
+        for (int32_t delta : deltas) {
+            if (delta >= 0 && delta <= 0xFF) {
+                packet.push_back(static_cast<uint8_t>(delta));
+            } else {
+                put16(packet, static_cast<uint16_t>(static_cast<int16_t>(delta)));
+            }
+        }
+
+        bool padded = false;
+        size_t padding = (4 - packet.size() % 4) % 4;
+        if (padding > 0) {
+            packet.insert(packet.end(), padding - 1, 0);
+            packet.push_back(static_cast<uint8_t>(padding));
+            padded = true;
+        }
+        writeRtcpHeader(packet, 0, RTPFB_FMT_TWCC, RTCP_PT_RTPFB, padded);
+
+        packets.push_back(std::move(packet));
+
+        next_feedback_seq_ = seq;
+        arrivals_.erase(arrivals_.begin(), arrivals_.lower_bound(next_feedback_seq_));
+    }
+}
+
+void TransportFeedback::buildRemb(std::vector<uint8_t>& packet) const {
+    uint64_t mantissa = stats_.estimated_bitrate_bps;
+    uint8_t exponent = 0;
+    while (mantissa > 0x3FFFF) {
+        mantissa >>= 1;
+        exponent++;
+    }
+
+    put32(packet, 0);
+    put32(packet, sender_ssrc_);
+    put32(packet, 0); // Media source SSRC is unused for REMB
+    packet.push_back('R');
+    packet.push_back('E');
+    packet.push_back('M');
+    packet.push_back('B');
+    put32(packet, (1u << 24) | (static_cast<uint32_t>(exponent) << 18) | static_cast<uint32_t>(mantissa));
+    put32(packet, media_ssrc_);
+    writeRtcpHeader(packet, 0, PSFB_FMT_AFB, RTCP_PT_PSFB, false);
+}
+
+bool TransportFeedback::sendPictureLossIndication(uint32_t media_ssrc) {
+    if (socket_fd_ < 0) {
+        return false;
+    }
+    return sendPacket(buildPictureLossIndication(sender_ssrc_, media_ssrc));
+}
+
+std::vector<uint8_t> TransportFeedback::buildPictureLossIndication(uint32_t sender_ssrc, uint32_t media_ssrc) {
+    std::vector<uint8_t> packet;
+    put32(packet, 0);
+    put32(packet, sender_ssrc);
+    writeRtcpHeader(packet, 0, 0, RTCP_PT_RR, false);
+    size_t pli_offset = packet.size();
+    put32(packet, 0);
+    put32(packet, sender_ssrc);
+    put32(packet, media_ssrc);
+    writeRtcpHeader(packet, pli_offset, PSFB_FMT_PLI, RTCP_PT_PSFB, false);
+    return packet;
+}
+
+bool TransportFeedback::sendPacket(const std::vector<uint8_t>& packet) {
+    if (send(socket_fd_, packet.data(), packet.size(), 0) < 0) {
+        if (errno != EAGAIN && errno != ECONNREFUSED) {
+            std::cerr << "Transport feedback: send error: " << strerror(errno) << std::endl;
+        }
+        return false;
+    }
+    return true;
+}
+
+TransportFeedback::Statistics TransportFeedback::getStatistics() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
@@ -4,9 +4,19 @@
  */
 
 #include "uvgrtp_receiver.h"
+#include "transport_feedback.h"
 #include <iostream>
 #include <cstring>
 
+namespace {
+
+// RFC 3550 A.1 limits, as in the depacketizer. Consecutive frames are a
+// frame's worth of packets apart, far below MAX_DROPOUT
+constexpr int MAX_DROPOUT = 3000;
+constexpr int MAX_MISORDER = 100;
+
+} // namespace
+
 UvgRTPReceiver::UvgRTPReceiver(const std::string& local_ip, uint16_t local_port)
     : local_ip_(local_ip), local_port_(local_port), stream_(nullptr),
       running_(false), initialized_(false) {
@@ -30,12 +40,27 @@ bool UvgRTPReceiver::initialize() {
 
         // Create media stream for H.264 reception (bind to local port)
         int flags = RCE_RECEIVE_ONLY | RCE_FRAGMENT_GENERIC;
+        if (!srtp_key_.empty()) {
+            if (!ctx_->crypto_enabled()) {
+                std::cerr << "SRTP requested but uvgRTP was built without crypto support" << std::endl;
+                return false;
+            }
+            flags |= RCE_SRTP | RCE_SRTP_KMNGMNT_USER;
+        }
         stream_ = session_->create_stream(local_port_, RTP_FORMAT_H264, flags);
         if (!stream_) {
             std::cerr << "Failed to create uvgRTP media stream" << std::endl;
             return false;
         }
 
+        if (!srtp_key_.empty()) {
+            if (stream_->add_srtp_ctx(srtp_key_.data(), srtp_salt_.data()) != RTP_OK) {
+                std::cerr << "Failed to install SRTP context" << std::endl;
+                return false;
+            }
+            std::cout << "SRTP enabled (AES-CM 128, decrypted in place)" << std::endl;
+        }
+
         // uvgRTP v3.1.6+ automatically enables defragmentation for H.264
         std::cout << "uvgRTP media stream created with automatic defragmentation" << std::endl;
 
@@ -60,6 +85,31 @@ void UvgRTPReceiver::setFrameCallback(FrameCallback callback) {
     frame_callback_ = callback;
 }
 
+void UvgRTPReceiver::setTransportFeedback(TransportFeedback* feedback) {
+    transport_feedback_ = feedback;
+}
+
+bool UvgRTPReceiver::setSrtpMasterKey(const std::vector<uint8_t>& master_key_and_salt) {
+#ifdef RTP_PLAYER_ENABLE_SRTP
+    if (initialized_) {
+        std::cerr << "SRTP key must be set before initialization" << std::endl;
+        return false;
+    }
+    if (master_key_and_salt.size() != SRTP_MASTER_KEY_SIZE + SRTP_MASTER_SALT_SIZE) {
+        std::cerr << "Invalid SRTP master key size: " << master_key_and_salt.size()
+                  << " (expected " << SRTP_MASTER_KEY_SIZE + SRTP_MASTER_SALT_SIZE << " bytes)" << std::endl;
+        return false;
+    }
+    srtp_key_.assign(master_key_and_salt.begin(), master_key_and_salt.begin() + SRTP_MASTER_KEY_SIZE);
+    srtp_salt_.assign(master_key_and_salt.begin() + SRTP_MASTER_KEY_SIZE, master_key_and_salt.end());
+    return true;
+#else
+    (void)master_key_and_salt;
+    std::cerr << "SRTP support not compiled in (configure with -DRTP_PLAYER_ENABLE_SRTP=ON)" << std::endl;
+    return false;
+#endif
+}
+
 bool UvgRTPReceiver::start() {
     if (!initialized_) {
         std::cerr << "UvgRTPReceiver not initialized" << std::endl;
@@ -72,7 +122,7 @@ bool UvgRTPReceiver::start() {
     }
 
     try {
-
+        have_seq_ = false;
         running_ = true;
         std::cout << "uvgRTP receiver started" << std::endl;
         return true;
@@ -124,6 +174,8 @@ void UvgRTPReceiver::processFrame(uvgrtp::frame::rtp_frame* frame) {
         return;
     }
 
+    recordTransportFeedback(frame);
+
     try {
         // Update statistics
         {
@@ -136,6 +188,8 @@ void UvgRTPReceiver::processFrame(uvgrtp::frame::rtp_frame* frame) {
         // Create H264Frame and pass it forward
         auto h264_frame = std::make_unique<H264Frame>();
         h264_frame->timestamp = frame->header.timestamp;
+        h264_frame->ssrc = frame->header.ssrc;
+        h264_frame->discontinuity = detectRestart(frame->header.seq, frame->header.ssrc);
         h264_frame->data.assign(frame->payload, frame->payload + frame->payload_len);
 
         std::cout << "✅ Frame received: " << h264_frame->data.size() 
@@ -157,6 +211,40 @@ void UvgRTPReceiver::processFrame(uvgrtp::frame::rtp_frame* frame) {
     }
 }
 
+// uvgRTP does the sequence tracking but hides restarts: a jump no frame
+// could span means the sender started over, like an SSRC change
+bool UvgRTPReceiver::detectRestart(uint16_t seq, uint32_t ssrc) {
+    bool restart = false;
+    if (have_seq_) {
+        int gap = static_cast<int16_t>(seq - last_seq_);
+        restart = ssrc != last_ssrc_ || gap > MAX_DROPOUT || gap < -MAX_MISORDER;
+    }
+    if (!have_seq_ || restart || static_cast<int16_t>(seq - last_seq_) > 0) {
+        last_seq_ = seq;
+    }
+    last_ssrc_ = ssrc;
+    have_seq_ = true;
+    return restart;
+}
+
+void UvgRTPReceiver::recordTransportFeedback(const uvgrtp::frame::rtp_frame* frame) {
+    if (!transport_feedback_) {
+        return;
+    }
+
+    // uvgRTP hands over reassembled frames: one arrival per frame is enough for
+    // the REMB delay estimator, but not for TWCC, which would report every other
+    // packet of the frame as lost (the session turns TWCC off on this path)
+    uint16_t transport_seq = 0;
+    if (frame->ext && frame->ext->data) {
+        size_t ext_bytes = static_cast<size_t>(frame->ext->len) * 4; // Length is in 32-bit words
+        (void)TransportFeedback::parseTransportSequence(frame->ext->type, frame->ext->data, ext_bytes,
+                                                        transport_feedback_->extensionId(), transport_seq);
+    }
+    transport_feedback_->onPacketArrival(transport_seq, frame->header.ssrc, frame->header.timestamp,
+                                         frame->payload_len, std::chrono::steady_clock::now());
+}
+
 UvgRTPReceiver::Statistics UvgRTPReceiver::getStatistics() const {
     std::lock_guard<std::mutex> lock(stats_mutex_);
     return stats_;
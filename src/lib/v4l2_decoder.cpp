@@ -4,8 +4,13 @@
 #include "dmabuf_allocator.h"
 #include "dma_buffers_manager.h"
 #include "drm_dmabuf_display.h"
+#ifdef RTP_PLAYER_ENABLE_WAYLAND
+#include "wayland_display.h"
+#endif
 #include "frame_processor.h"
 #include "streaming_manager.h"
+#include "flight_recorder.h"
+#include "media_timestamp.h"
 #include <iostream>
 #include <fstream>
 #include <vector>
@@ -21,6 +26,11 @@
 #include <string_view>
 #include <span>
 #include <chrono>
+#include <mutex>
+#include <atomic>
+#include <map>
+#include <variant>
+#include <algorithm>
 #include <linux/dma-buf.h>
 
 
@@ -32,27 +42,77 @@ class V4L2DecoderImpl {
     std::shared_ptr<DmaBufAllocator> dmabuf_allocator;
     std::unique_ptr<DmaBuffersManager> input_buffers_;
     std::unique_ptr<DmaBuffersManager> output_buffers_;
-   
-    // Tracking Zero-Copy initialization for each buffer
-    std::vector<bool> zero_copy_initialized;
+
 
     // For display
-    std::unique_ptr<DrmDmaBufDisplayManager> display_manager;
+    std::unique_ptr<DisplayBackend> display_manager;
     V4L2Decoder::DisplayType display_type = V4L2Decoder::DisplayType::NONE;
     uint32_t frame_width = 0;
     uint32_t frame_height = 0;
+    uint32_t frame_stride = 0;
     
-    // Frame handler
-    std::unique_ptr<FrameProcessor> frame_processor_;
+    // Frame handler; the DRM variant calls the display without virtual dispatch
+    std::variant<std::monostate, FrameProcessor, DrmFrameProcessor> frame_processor_;
 
     // Streaming manager
     std::unique_ptr<StreamingManager> streaming_manager_;
 
-    int decoded_frame_count = 0;
+    pipeline::MetricsRecorder capture_metrics;
+
+    // Exported frames: a CAPTURE buffer is requeued once the display and the
+    // consumers' handles (counted as one owner) have both released it
+    struct FrameReturnQueue {
+        std::mutex mutex;
+        std::vector<std::pair<unsigned int, uint64_t>> returned;    // Index, buffer generation
+    };
+    std::mutex consumers_mutex;
+    std::map<int, V4L2Decoder::FrameConsumer> frame_consumers;
+    int next_consumer_id = 1;
+    std::shared_ptr<FrameReturnQueue> frame_returns = std::make_shared<FrameReturnQueue>();
+    std::vector<uint32_t> buffer_owners;
+    uint64_t buffer_generation = 0;     // Bumped when the buffers are reallocated
+
+    // The handles' own reference to an exported CAPTURE buffer: a dup'd fd and
+    // a mapping, so the memory outlives a reallocation until the last handle goes
+    struct ExportedBuffer {
+        int fd = -1;
+        void* data = nullptr;
+        size_t size = 0;
+
+        ~ExportedBuffer() {
+            if (data) {
+                munmap(data, size);
+            }
+            if (fd >= 0) {
+                close(fd);
+            }
+        }
+    };
+    std::vector<std::shared_ptr<ExportedBuffer>> exported_buffers;     // Per CAPTURE index, this generation
     
     // Decoder initialization flag
     bool decoder_ready = false;
-    bool needs_reset = false;
+    bool needs_reset = false;           // POLLERR seen; recover() before the next submission
+    bool suspended = false;             // Idle: streaming stopped until the next submission
+    bool buffers_released = false;      // Idle freed the DMA-bufs; reallocated on resume
+
+    // Graded recovery
+    static constexpr auto RECOVERY_ESCALATION_WINDOW = std::chrono::seconds(1);
+    size_t recovery_start_step = 0;
+    std::chrono::steady_clock::time_point last_recovery{};
+    mutable std::mutex recovery_mutex;
+    V4L2Decoder::RecoveryStatistics recovery_stats;
+    std::atomic<int> requested_recovery_step{-1};
+
+    // Extends submitted RTP timestamps (decoding thread only)
+    RtpTimestampUnwrapper rtp_timestamps;
+
+    // Progress counters (read by the watchdog)
+    std::atomic<uint64_t> submitted_count{0};
+    std::atomic<uint64_t> submit_wait_count{0};
+    std::atomic<uint64_t> dequeued_count{0};
+
+    FlightRecorder* flight_recorder = nullptr;
     
 public:
     V4L2DecoderImpl() : 
@@ -62,7 +122,28 @@ public:
     }
     ~V4L2DecoderImpl() { cleanup(); }
 
-    [[nodiscard]] int getDecodedFrameCount() const noexcept { return decoded_frame_count; }
+    [[nodiscard]] int getDecodedFrameCount() const noexcept {
+        int count = 0;
+        withFrameProcessor([&](auto& processor) { count = processor.decodedFrameCount(); });
+        return count;
+    }
+
+    [[nodiscard]] int deviceFd() const noexcept { return device_->fd(); }
+    [[nodiscard]] int displayEventFd() const { return display_manager ? display_manager->eventFd() : -1; }
+    [[nodiscard]] bool displayBusy() const { return display_manager && display_manager->presentPending(); }
+
+    void dispatchDisplayEvents() {
+        if (display_manager) {
+            display_manager->dispatchEvents();
+        }
+    }
+
+    [[nodiscard]] std::vector<pipeline::StageMetrics> getStageMetrics() const {
+        std::vector<pipeline::StageMetrics> stages;
+        stages.push_back(capture_metrics.snapshot("capture"));
+        withFrameProcessor([&](auto& processor) { stages.push_back(processor.metrics()); });
+        return stages;
+    }
 
     [[nodiscard]] bool initialize(const DecoderConfig& config) {
         config_ = config;
@@ -85,31 +166,7 @@ public:
             return false;
         }
         
-        frame_processor_ = std::make_unique<FrameProcessor>(
-            display_manager.get(), 
-            output_buffers_.get(), 
-            frame_width, 
-            frame_height, 
-            display_type, 
-            zero_copy_initialized, 
-            decoded_frame_count,
-            // Lambda function for Zero-Copy setup
-            [this](unsigned int buffer_index) {
-                if (buffer_index >= zero_copy_initialized.size() || zero_copy_initialized[buffer_index]) {
-                    return;
-                }
-
-                // Use dynamic_cast to check if our DisplayManager is the required type
-                auto* dmabuf_display = dynamic_cast<DrmDmaBufDisplayManager*>(display_manager.get());
-                if (dmabuf_display) {
-                    const auto& buffer_info = output_buffers_->get_info(buffer_index);
-                    if (dmabuf_display->setupZeroCopyBuffer(buffer_info.fd, frame_width, frame_height)) {
-                        zero_copy_initialized[buffer_index] = true;
-                        std::cout << "✅ Zero-copy buffer " << buffer_index << " configured via callback" << std::endl;
-                    }
-                }
-            }
-        );
+        selectFrameProcessor();
 
         return setupFormats() && setupBuffers();
     }
@@ -157,6 +214,8 @@ public:
         // Save frame size for display
         frame_width = fmt_out.fmt.pix_mp.width;
         frame_height = fmt_out.fmt.pix_mp.height;
+        frame_stride = fmt_out.fmt.pix_mp.plane_fmt[0].bytesperline;
+        withFrameProcessor([&](auto& processor) { processor.setFrameSize(frame_width, frame_height, frame_stride); });
         
         // Initialize display if already configured
         if (display_manager && display_type != V4L2Decoder::DisplayType::NONE) {
@@ -164,9 +223,14 @@ public:
             if (!display_manager->initialize(frame_width, frame_height)) {
                 std::cerr << "Display initialization error" << std::endl;
                 display_manager.reset();
+                selectFrameProcessor();
                 return false;
             }
             std::cout << "Display initialized: " << display_manager->getDisplayInfo() << std::endl;
+            if (!applyDecoderTransform()) {
+                return false;
+            }
+            enableOsd();
         } else {
             std::cout << "Display not initialized: display_manager=" << (display_manager ? "present" : "absent") 
                       << ", display_type=" << (int)display_type << std::endl;
@@ -176,27 +240,149 @@ public:
         return true;
     }
 
+    // Rotation/reflection the display planes cannot do is requested from the decoder instead.
+    // Drivers take these controls only before REQBUFS, and a quarter turn changes the
+    // capture format, so buffers that already exist are released and reallocated around it.
+    [[nodiscard]] bool applyDecoderTransform() {
+        const DisplayConfig& display = config_.display;
+        bool requested = display.rotation != 0 || display.reflect_x || display.reflect_y;
+        if (!requested || display_manager->transformApplied()) {
+            return true;
+        }
+
+        bool reallocate = output_buffers_ && output_buffers_->allocated();
+        if (reallocate) {
+            (void)input_buffers_->releaseOnDevice(*device_);
+            (void)output_buffers_->releaseOnDevice(*device_);
+            input_buffers_->reset_usage();
+            input_buffers_->deallocate();
+            output_buffers_->deallocate();
+        }
+
+        // All or nothing: a partial transform is worse than none
+        std::vector<uint32_t> applied;
+        auto setControl = [&](uint32_t id, __s32 value) {
+            if (!device_->set_control({id, value})) {
+                return false;
+            }
+            applied.push_back(id);
+            return true;
+        };
+        bool ok = (display.rotation == 0 || setControl(V4L2_CID_ROTATE, static_cast<__s32>(display.rotation))) &&
+                  (!display.reflect_x || setControl(V4L2_CID_HFLIP, 1)) &&
+                  (!display.reflect_y || setControl(V4L2_CID_VFLIP, 1));
+        if (!ok) {
+            for (uint32_t id : applied) {
+                (void)device_->set_control({id, 0});
+            }
+            std::cerr << "⚠️ WARNING: decoder cannot rotate/reflect either, showing frames as decoded" << std::endl;
+        }
+
+        // A quarter turn swaps the capture dimensions and changes the line pitch
+        struct v4l2_format fmt = {};
+        fmt.type = V4L2_BUF_TYPE_VIDEO_CAPTURE_MPLANE;
+        if (device_->get_format(fmt)) {
+            frame_width = fmt.fmt.pix_mp.width;
+            frame_height = fmt.fmt.pix_mp.height;
+            frame_stride = fmt.fmt.pix_mp.plane_fmt[0].bytesperline;
+            withFrameProcessor([&](auto& processor) { processor.setFrameSize(frame_width, frame_height, frame_stride); });
+        }
+        if (ok) {
+            std::cout << "✅ Rotation/reflection done by the decoder, frames are " << frame_width << "x" << frame_height << std::endl;
+        }
+
+        if (reallocate && !setupBuffers()) {
+            std::cerr << "❌ Error reallocating buffers for the decoder transform" << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    // The OSD is optional: a missing overlay plane never blocks video
+    void enableOsd() {
+        if (config_.osd.enabled && !display_manager->enableOsd(config_.osd)) {
+            std::cerr << "⚠️ WARNING: OSD overlay unavailable, continuing without it" << std::endl;
+        }
+    }
+
+    [[nodiscard]] DisplayBackend::Statistics getDisplayStatistics() const {
+        return display_manager ? display_manager->getStatistics() : DisplayBackend::Statistics{};
+    }
+
+    void setOsdText(const std::vector<std::string>& lines) {
+        if (display_manager) {
+            display_manager->setOsdText(lines);
+        }
+    }
+
+    // Run f on the active frame processor (no-op before initialize)
+    template <typename F>
+    void withFrameProcessor(F&& f) { visitFrameProcessor(frame_processor_, f); }
+    template <typename F>
+    void withFrameProcessor(F&& f) const { visitFrameProcessor(frame_processor_, f); }
+
+    template <typename Variant, typename F>
+    static void visitFrameProcessor(Variant& processors, F& f) {
+        std::visit([&](auto& processor) {
+            if constexpr (!std::is_same_v<std::decay_t<decltype(processor)>, std::monostate>) {
+                f(processor);
+            }
+        }, processors);
+    }
+
+    // DRM output gets the processor bound to the concrete display type
+    void selectFrameProcessor() {
+        if (!output_buffers_) {
+            return;
+        }
+        if (display_manager && display_type == V4L2Decoder::DisplayType::DRM_DMABUF) {
+            auto& processor = frame_processor_.emplace<DrmFrameProcessor>(output_buffers_.get());
+            processor.setDisplay(static_cast<DrmDmaBufDisplayManager*>(display_manager.get()));
+        } else {
+            frame_processor_.emplace<FrameProcessor>(output_buffers_.get()).setDisplay(display_manager.get());
+        }
+        withFrameProcessor([this](auto& processor) { processor.setFrameSize(frame_width, frame_height, frame_stride); });
+    }
+
     [[nodiscard]] bool setDisplay() {
-        display_type = V4L2Decoder::DisplayType::DRM_DMABUF;
-        
-        std::cout << "Setting up display: TRUE Zero-Copy DMA-buf" << std::endl;
-        
-        display_manager = std::make_unique<DrmDmaBufDisplayManager>();
+        if (config_.display.output == DisplayOutput::NONE) {
+            display_type = V4L2Decoder::DisplayType::NONE;
+            std::cout << "Setting up display: none (headless)" << std::endl;
+            return true;
+        }
+        if (config_.display.output == DisplayOutput::WAYLAND) {
+#ifdef RTP_PLAYER_ENABLE_WAYLAND
+            display_type = V4L2Decoder::DisplayType::WAYLAND;
+            std::cout << "Setting up display: Wayland linux-dmabuf" << std::endl;
+            display_manager = std::make_unique<WaylandDisplay>();
+#else
+            std::cerr << "❌ Wayland output requested but built without RTP_PLAYER_ENABLE_WAYLAND" << std::endl;
+            return false;
+#endif
+        } else {
+            display_type = V4L2Decoder::DisplayType::DRM_DMABUF;
+            std::cout << "Setting up display: TRUE Zero-Copy DMA-buf" << std::endl;
+            display_manager = std::make_unique<DrmDmaBufDisplayManager>();
+        }
+        display_manager->setConfig(config_.display);
         
         // If frame_width and frame_height are already known, initialize the display
         if (frame_width > 0 && frame_height > 0) {
             if (!display_manager->initialize(frame_width, frame_height)) {
                 std::cerr << "Display initialization error" << std::endl;
                 display_manager.reset();
+                selectFrameProcessor();
                 return false;
             }
             std::cout << "Display initialized: " << display_manager->getDisplayInfo() << std::endl;
+            if (!applyDecoderTransform()) {
+                return false;
+            }
+            enableOsd();
         }
         
-        // Update display_manager in frame_processor
-        if (frame_processor_) {
-            frame_processor_->setDisplayManager(display_manager.get());
-        }
+        // The frame processor is specialized for the display type
+        selectFrameProcessor();
         
         return true;
     }
@@ -208,8 +394,6 @@ public:
     [[nodiscard]] bool setupDmaBufs() {
         // Fully DMA-buf approach
         
-        zero_copy_initialized.assign(output_buffers_->count(), false);
-        
         // Get buffer sizes from V4L2
         struct v4l2_format fmt_out = {};
         fmt_out.type = V4L2_BUF_TYPE_VIDEO_OUTPUT_MPLANE;
@@ -254,10 +438,12 @@ public:
             auto& info = output_buffers_->get_info(i);
             if (info.mapped_addr && info.size > 0) {
                 uint8_t* buffer = static_cast<uint8_t*>(info.mapped_addr);
-                size_t y_size = frame_width * frame_height;
-                size_t uv_size = y_size / 2;
-                std::memset(buffer, 16, y_size);
-                std::memset(buffer + y_size, 128, uv_size);
+                const auto layout = DisplayBackend::i420Layout(frame_stride ? frame_stride : frame_width, frame_height);
+                size_t y_size = layout.offsets[1];
+                std::memset(buffer, 16, std::min(y_size, info.size));
+                if (layout.size <= info.size) {
+                    std::memset(buffer + y_size, 128, layout.size - y_size);
+                }
             }
         }
         if (!output_buffers_->requestOnDevice(*device_)) {
@@ -335,7 +521,35 @@ public:
         return streaming_manager_->stop();
     }
 
-    [[nodiscard]] bool decodeData(const uint8_t* data, size_t size) {
+    [[nodiscard]] bool decodeData(const uint8_t* data, size_t size, uint32_t rtp_timestamp) {
+        bool submitted = false;
+        if (!trySubmitData(data, size, rtp_timestamp, submitted)) {
+            return false;
+        }
+        if (!submitted) {
+            // If no free buffers, try to wait for one with a short timeout
+            if (device_->poll(POLLOUT | POLLERR, 20) && device_->is_ready_for_write() &&
+                !trySubmitData(data, size, rtp_timestamp, submitted)) {
+                return false;
+            }
+            if (!submitted) {
+                std::cerr << "❌ ERROR: No free input buffers!" << std::endl;
+                return false;
+            }
+            std::cout << "✅ Freed input buffer after waiting" << std::endl;
+        }
+
+        // --- Dequeue ready frames ---
+        if (!decoder_ready) {
+            std::cout << "⏭️ Data sent, waiting for decoder to be ready" << std::endl;
+            return true;
+        }
+        return drainCaptureQueue(false);
+    }
+
+    // Queue one access unit without blocking; submitted stays false while every OUTPUT buffer is busy
+    [[nodiscard]] bool trySubmitData(const uint8_t* data, size_t size, uint32_t rtp_timestamp, bool& submitted) {
+        submitted = false;
         if (!data || size == 0) {
             std::cerr << "❌ ERROR: Invalid input data (data=" << (void*)data 
                       << ", size=" << size << ")" << std::endl;
@@ -347,19 +561,22 @@ public:
             return false;
         }
 
-        // Check if a reset is needed due to a V4L2 event
+        // The device reported an error (or the watchdog a stall): recover with
+        // the cheapest step that works
+        int requested_step = requested_recovery_step.exchange(-1);
+        if (requested_step >= 0) {
+            needs_reset = true;
+        }
         if (needs_reset) {
-            std::cout << "🚀 Performing reset due to V4L2_EVENT_SOURCE_CHANGE..." << std::endl;
-            if (!resetBuffers()) {
-                std::cerr << "❌ Error resetting buffers after source change" << std::endl;
-                return false;
-            }
-            if (!streaming_manager_->start()) {
-                std::cerr << "❌ Error restarting streaming after reset" << std::endl;
+            if (!recover(std::max(requested_step, 0))) {
+                std::cerr << "❌ Decoder recovery failed, retrying with the next frame" << std::endl;
                 return false;
             }
-            needs_reset = false; // Reset the flag
-            std::cout << "✅ Reset and streaming restart successful" << std::endl;
+            needs_reset = false;
+        }
+
+        if (suspended && !resume()) {
+            return false;
         }
 
         // uvgRTP provides full frames - NAL processing is not required.
@@ -390,21 +607,9 @@ public:
         }
 
         int buffer_to_use = input_buffers_->get_free_buffer_index();
-        
         if (buffer_to_use == -1) {
-            // If no free buffers, try to wait for one with a short timeout
-            if (device_->poll(POLLOUT | POLLERR, 20) && device_->is_ready_for_write()) {
-                 if (device_->dequeue_buffer(dq_buf_in)) {
-                    input_buffers_->mark_free(dq_buf_in.index);
-                    buffer_to_use = dq_buf_in.index;
-                    std::cout << "✅ Freed input buffer " << buffer_to_use << " after waiting" << std::endl;
-                }
-            }
-        }
-
-        if (buffer_to_use == -1) {
-            std::cerr << "❌ ERROR: No free input buffers!" << std::endl;
-            return false;
+            submit_wait_count.fetch_add(1, std::memory_order_relaxed);
+            return true;
         }
         
         // Validate buffer bounds
@@ -453,19 +658,36 @@ public:
         plane.m.fd = input_buffers_->get_info(buffer_to_use).fd;
         plane.bytesused = chunk_size;
         plane.length = input_buffers_->get_info(buffer_to_use).size; // Specify the full buffer size
-        
+        // Copied by the driver to the CAPTURE buffer of the decoded frame
+        buf.timestamp = rtpToBufferTimestamp(rtp_timestamps.unwrap(rtp_timestamp));
+
         if (!device_->queue_buffer(buf)) {
             std::cerr << "❌ ERROR: Failed to queue buffer (buffer " << buffer_to_use 
                       << ")" << std::endl;
             return false;
         }
         input_buffers_->mark_in_use(buffer_to_use);
+        submitted = true;
+        uint64_t submission = submitted_count.fetch_add(1, std::memory_order_relaxed) + 1;
+        if (flight_recorder) {
+            flight_recorder->record(FlightRecorder::Event::SUBMITTED, static_cast<uint32_t>(submission),
+                                    static_cast<uint32_t>(chunk_size), 0, static_cast<int16_t>(buffer_to_use), 0,
+                                    rtp_timestamp);
+        }
+        return true;
+    }
 
-        // --- Dequeue ready frames ---
-        if (!decoder_ready) {
-            std::cout << "⏭️ Data sent, waiting for decoder to be ready" << std::endl;
-            return true;
+    // Handle pending events and decoded frames without blocking, up to the first
+    // frame that starts a page flip: the next one would wait for it in displayFrame
+    [[nodiscard]] bool collectFrames() {
+        return drainCaptureQueue(true);
+    }
+
+    [[nodiscard]] bool drainCaptureQueue(bool stop_at_flip) {
+        if (suspended) {
+            return false;   // Streaming is off; event loops wait for the next submission
         }
+        requeueReleasedBuffers();
 
         bool frames_processed;
         do {
@@ -478,6 +700,10 @@ public:
             if (device_->has_error()) { 
                 std::cerr << "❌ POLLERR" << std::endl; 
                 needs_reset = true; // Set flag for reset
+                if (flight_recorder) {
+                    flight_recorder->record(FlightRecorder::Event::DEVICE_ERROR, 0);
+                    flight_recorder->trigger("decoder POLLERR");
+                }
                 return false; 
             }
             
@@ -490,10 +716,12 @@ public:
                 out_buf.length = 1;
                 
                 if (device_->dequeue_buffer(out_buf)) {
-                    if (frame_processor_->processDecodedFrame(out_buf)) {
-                        requeueOutputBuffer(out_buf);
+                    if (!handleDecodedFrame(out_buf)) {
+                        std::cerr << "❌ Failed to requeue output buffer " << out_buf.index << std::endl;
                     }
-                    frames_processed = true;
+                    requeueReleasedBuffers();
+                    // The rest stay in the driver; the fd is still readable after the flip
+                    frames_processed = !(stop_at_flip && displayBusy());
                 } else {
                     // EAGAIN is normal, just means no data yet
                     break;
@@ -578,11 +806,10 @@ public:
                 out_buf.length = 1;
                 
                 if (device_->dequeue_buffer(out_buf)) {
-                    if (frame_processor_->processDecodedFrame(out_buf)) {
-                         if (!requeueOutputBuffer(out_buf)) {
-                            std::cerr << "❌ Failed to requeue flush output buffer" << std::endl;
-                        }
+                    if (!handleDecodedFrame(out_buf)) {
+                        std::cerr << "❌ Failed to requeue flush output buffer" << std::endl;
                     }
+                    requeueReleasedBuffers();
                     attempts = 0; // Reset counter on frame receipt
                 } else {
                     attempts++;
@@ -633,7 +860,8 @@ public:
         }
 
         // Reset zero-copy state AFTER clearing buffers
-        zero_copy_initialized.clear();
+        withFrameProcessor([](auto& processor) { processor.resetHeldBuffers(); });
+        releaseExportedBuffers();
 
         // Clearing MMAP buffers for input data - no longer needed
         /*
@@ -662,7 +890,413 @@ public:
         return true;
     }
 
+    [[nodiscard]] bool resetStream(bool blank_display) {
+        if (!device_->is_open()) {
+            return false;
+        }
+        if (blank_display && display_manager) {
+            display_manager->blank();
+        }
+        requeueReleasedBuffers();
+        // Timestamps of the new stream are unrelated to the old ones
+        rtp_timestamps.reset();
+        if (!streaming_manager_->is_active()) {
+            return true;
+        }
+
+        // The decoder restart step, but the stream ended rather than failed
+        if (!runRecoveryStep(V4L2Decoder::RecoveryStep::RESTART_DECODER)) {
+            std::cerr << "⚠️ Decoder restart for the new stream failed, recovering before the next frame" << std::endl;
+            needs_reset = true;
+            return false;
+        }
+        std::cout << "🔄 Decoder restarted for a new stream" << std::endl;
+        return true;
+    }
+
+    [[nodiscard]] bool suspend(bool blank_display, bool release_buffers) {
+        if (suspended || !device_->is_open()) {
+            return suspended;
+        }
+
+        // The display keeps a copy of the last frame, so it needs none of ours
+        bool display_released = !display_manager || display_manager->suspend(blank_display);
+        requeueReleasedBuffers();
+        if (display_released) {
+            withFrameProcessor([](auto& processor) { processor.resetHeldBuffers(); });
+        }
+        if (streaming_manager_->is_active()) {
+            (void)streaming_manager_->stop();
+        }
+        suspended = true;
+
+        bool exported = std::any_of(buffer_owners.begin(), buffer_owners.end(),
+                                    [](uint32_t owners) { return owners > 0; });
+        if (release_buffers && display_released && !exported) {
+            (void)input_buffers_->releaseOnDevice(*device_);
+            (void)output_buffers_->releaseOnDevice(*device_);
+            input_buffers_->reset_usage();
+            input_buffers_->deallocate();
+            output_buffers_->deallocate();
+            releaseExportedBuffers();
+            buffers_released = true;
+        } else if (release_buffers) {
+            std::cout << "⚠️ Keeping decoder buffers while idle: still on screen or held by consumers" << std::endl;
+        }
+
+        std::cout << "💤 Decoder idle: streaming stopped" << (buffers_released ? ", buffers released" : "")
+                  << std::endl;
+        return true;
+    }
+
+    [[nodiscard]] bool resume() {
+        if (buffers_released) {
+            if (!setupBuffers()) {
+                std::cerr << "❌ Error reallocating buffers after idle" << std::endl;
+                return false;
+            }
+            buffers_released = false;
+        } else if (!streaming_manager_->is_active()) {
+            // Kept buffers may still be on screen or with consumers; those are
+            // queued by releaseBufferOwner() once let go, never twice
+            requeueReleasedBuffers();
+            if (!streaming_manager_->start(idleCaptureBuffers())) {
+                std::cerr << "❌ Error restarting streaming after idle" << std::endl;
+                return false;
+            }
+        }
+        suspended = false;
+        std::cout << "⏰ Decoder leaving idle" << std::endl;
+        return true;    // Streaming restarts with this submission
+    }
+
+    [[nodiscard]] V4L2Decoder::RecoveryStatistics getRecoveryStatistics() const {
+        std::lock_guard<std::mutex> lock(recovery_mutex);
+        return recovery_stats;
+    }
+
+    void requestRecovery(V4L2Decoder::RecoveryStep from) {
+        int step = static_cast<int>(from);
+        if (flight_recorder) {
+            flight_recorder->record(FlightRecorder::Event::STALL, 0, 0, step);
+            flight_recorder->trigger("decoder stall");
+        }
+        int current = requested_recovery_step.load();
+        while (step > current && !requested_recovery_step.compare_exchange_weak(current, step)) {}
+    }
+
+    void requestDisplayRecovery() {
+        if (flight_recorder) {
+            flight_recorder->record(FlightRecorder::Event::STALL, 0, 0, -1);
+            flight_recorder->trigger("display stall");
+        }
+        if (display_manager) {
+            display_manager->requestRecovery();
+        }
+    }
+
+    [[nodiscard]] V4L2Decoder::Progress getProgress() const {
+        V4L2Decoder::Progress progress;
+        progress.submitted = submitted_count.load(std::memory_order_relaxed);
+        progress.submit_waits = submit_wait_count.load(std::memory_order_relaxed);
+        progress.dequeued = dequeued_count.load(std::memory_order_relaxed);
+        if (display_manager) {
+            auto display = display_manager->getStatistics();
+            progress.presented = display.flips;
+            progress.has_display = true;
+        }
+        return progress;
+    }
+
+    [[nodiscard]] int addFrameConsumer(V4L2Decoder::FrameConsumer consumer) {
+        std::lock_guard<std::mutex> lock(consumers_mutex);
+        int id = next_consumer_id++;
+        frame_consumers.emplace(id, std::move(consumer));
+        return id;
+    }
+
+    void removeFrameConsumer(int id) {
+        std::lock_guard<std::mutex> lock(consumers_mutex);
+        frame_consumers.erase(id);
+    }
+
+    void setFlightRecorder(FlightRecorder* recorder) { flight_recorder = recorder; }
+
 private:
+    // Show and export a dequeued CAPTURE buffer; requeue it if nobody holds it
+    [[nodiscard]] bool handleDecodedFrame(const v4l2_buffer& out_buf) {
+        auto begin = std::chrono::steady_clock::now();
+        capture_metrics.accepted(0);
+        dequeued_count.fetch_add(1, std::memory_order_relaxed);
+        bool exported = exportFrame(out_buf);
+        bool displayed = false;
+        withFrameProcessor([&](auto& processor) { displayed = !processor.processDecodedFrame(out_buf); });
+        capture_metrics.processed(std::chrono::nanoseconds(0), std::chrono::steady_clock::now() - begin);
+        if (flight_recorder) {
+            uint8_t flags = ((out_buf.flags & V4L2_BUF_FLAG_ERROR) ? FlightRecorder::BUFFER_ERROR : 0) |
+                            (displayed ? FlightRecorder::DISPLAYED : 0) | (exported ? FlightRecorder::EXPORTED : 0);
+            flight_recorder->record(FlightRecorder::Event::DEQUEUED, out_buf.sequence, out_buf.m.planes[0].bytesused,
+                                    0, static_cast<int16_t>(out_buf.index), flags,
+                                    static_cast<uint32_t>(rtpFromBufferTimestamp(out_buf.timestamp)));
+        }
+        if (!exported && !displayed) {
+            return requeueOutputBuffer(out_buf);
+        }
+
+        if (buffer_owners.size() != output_buffers_->count()) {
+            buffer_owners.assign(output_buffers_->count(), 0);
+        }
+        if (out_buf.index < buffer_owners.size()) {
+            buffer_owners[out_buf.index] = (exported ? 1 : 0) + (displayed ? 1 : 0);
+        }
+        return true;
+    }
+
+    // Hand the frame to the registered consumers; true if any were called
+    [[nodiscard]] bool exportFrame(const v4l2_buffer& out_buf) {
+        std::lock_guard<std::mutex> lock(consumers_mutex);
+        if (frame_consumers.empty() || (out_buf.flags & V4L2_BUF_FLAG_ERROR) ||
+            out_buf.index >= output_buffers_->count() || out_buf.m.planes[0].bytesused == 0) {
+            return false;
+        }
+
+        std::shared_ptr<ExportedBuffer> buffer = exportedBuffer(out_buf.index);
+        if (!buffer) {
+            return false;
+        }
+        auto* frame = new DecodedFrame();
+        frame->dma_fd = buffer->fd;
+        frame->data = buffer->data;
+        frame->size = out_buf.m.planes[0].bytesused;
+        frame->width = frame_width;
+        frame->height = frame_height;
+        frame->format = config_.output_pixel_format;
+        frame->stride = frame_stride ? frame_stride : frame_width;
+        frame->sequence = out_buf.sequence;
+        uint64_t extended = rtpFromBufferTimestamp(out_buf.timestamp);
+        frame->rtp_timestamp = static_cast<uint32_t>(extended);
+        frame->timestamp = rtpToMediaTime(extended);
+        frame->decoded_at = std::chrono::steady_clock::now();
+        frame->buffer_index = out_buf.index;
+        frame->buffer_generation = static_cast<uint32_t>(buffer_generation);
+
+        // The last handle may be dropped on any thread, possibly after the
+        // decoder is gone: only post the index, the decoder thread requeues it
+        DecodedFrameRef ref(frame, [returns = frame_returns, generation = buffer_generation,
+                                    buffer = std::move(buffer)](const DecodedFrame* f) {
+            {
+                std::lock_guard<std::mutex> lock(returns->mutex);
+                returns->returned.emplace_back(f->buffer_index, generation);
+            }
+            delete f;
+        });
+        for (auto& [id, consumer] : frame_consumers) {
+            consumer(ref);
+        }
+        return true;
+    }
+
+    // Created on the first export of each buffer and shared by all its handles
+    [[nodiscard]] std::shared_ptr<ExportedBuffer> exportedBuffer(unsigned int index) {
+        if (exported_buffers.size() != output_buffers_->count()) {
+            exported_buffers.assign(output_buffers_->count(), nullptr);
+        }
+        if (exported_buffers[index]) {
+            return exported_buffers[index];
+        }
+        const auto& info = output_buffers_->get_info(index);
+        auto buffer = std::make_shared<ExportedBuffer>();
+        buffer->fd = dup(info.fd);
+        if (buffer->fd >= 0) {
+            void* data = mmap(nullptr, info.size, PROT_READ, MAP_SHARED, buffer->fd, 0);
+            if (data != MAP_FAILED) {
+                buffer->data = data;
+                buffer->size = info.size;
+            }
+        }
+        if (!buffer->data) {
+            std::cerr << "❌ Cannot export buffer " << index << ": " << strerror(errno) << std::endl;
+            return nullptr;
+        }
+        exported_buffers[index] = buffer;
+        return buffer;
+    }
+
+    void releaseBufferOwner(unsigned int index) {
+        if (index >= buffer_owners.size() || buffer_owners[index] == 0) {
+            return;
+        }
+        if (--buffer_owners[index] == 0 && !queueOutputBuffer(index)) {
+            std::cerr << "❌ Failed to requeue released buffer " << index << std::endl;
+        }
+    }
+
+    // Give buffers that left scanout and the consumers back to the decoder
+    void requeueReleasedBuffers() {
+        withFrameProcessor([this](auto& processor) {
+            for (unsigned int index : processor.takeReleasedBuffers()) {
+                releaseBufferOwner(index);
+            }
+        });
+
+        std::vector<std::pair<unsigned int, uint64_t>> returned;
+        {
+            std::lock_guard<std::mutex> lock(frame_returns->mutex);
+            returned.swap(frame_returns->returned);
+        }
+        for (auto [index, generation] : returned) {
+            if (generation == buffer_generation) {
+                releaseBufferOwner(index);
+            }
+        }
+    }
+
+    // Forget exported buffers; handles still alive keep their own reference to the old memory
+    void releaseExportedBuffers() {
+        size_t outstanding = 0;
+        for (uint32_t owners : buffer_owners) {
+            outstanding += owners > 0;
+        }
+        if (outstanding > 0) {
+            std::cout << "⚠️ " << outstanding << " decoded buffer(s) still held at reset" << std::endl;
+        }
+        buffer_owners.clear();
+        exported_buffers.clear();
+        ++buffer_generation;
+    }
+
+    // Walk the recovery ladder; each step is timed and counted
+    [[nodiscard]] bool recover(size_t minimum_step) {
+        using Clock = std::chrono::steady_clock;
+        auto now = Clock::now();
+        if (last_recovery != Clock::time_point{} && now - last_recovery < RECOVERY_ESCALATION_WINDOW) {
+            // The step that worked last time did not hold
+            recovery_start_step = std::min(recovery_start_step + 1, V4L2Decoder::RECOVERY_STEPS - 1);
+        } else {
+            recovery_start_step = 0;
+        }
+        recovery_start_step = std::min(std::max(recovery_start_step, minimum_step), V4L2Decoder::RECOVERY_STEPS - 1);
+
+        for (size_t step = recovery_start_step; step < V4L2Decoder::RECOVERY_STEPS; ++step) {
+            auto recovery_step = static_cast<V4L2Decoder::RecoveryStep>(step);
+            auto begin = Clock::now();
+            bool recovered = runRecoveryStep(recovery_step) && deviceHealthy();
+            auto us = static_cast<uint64_t>(
+                std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - begin).count());
+            {
+                std::lock_guard<std::mutex> lock(recovery_mutex);
+                recovery_stats.attempts[step]++;
+                recovery_stats.recovered[step] += recovered;
+                recovery_stats.total_us[step] += us;
+                recovery_stats.max_us[step] = std::max(recovery_stats.max_us[step], us);
+            }
+            if (flight_recorder) {
+                flight_recorder->record(FlightRecorder::Event::RECOVERY, 0, 0, static_cast<int32_t>(step), -1,
+                                        recovered ? FlightRecorder::RECOVERED : 0);
+            }
+
+            if (recovered) {
+                std::cout << "✅ Decoder recovered by " << V4L2Decoder::recoveryStepName(recovery_step)
+                          << " in " << us << " us" << std::endl;
+                recovery_start_step = step;
+                last_recovery = Clock::now();
+                return true;
+            }
+            std::cerr << "⚠️ Recovery step " << V4L2Decoder::recoveryStepName(recovery_step)
+                      << " did not clear the error (" << us << " us)" << std::endl;
+        }
+
+        if (flight_recorder) {
+            flight_recorder->trigger("decoder recovery failed");
+        }
+        std::lock_guard<std::mutex> lock(recovery_mutex);
+        recovery_stats.failures++;
+        last_recovery = Clock::now();
+        return false;
+    }
+
+    [[nodiscard]] bool runRecoveryStep(V4L2Decoder::RecoveryStep step) {
+        switch (step) {
+            case V4L2Decoder::RecoveryStep::REQUEUE:
+                requeueReleasedBuffers();
+                return requeueIdleCaptureBuffers();
+
+            case V4L2Decoder::RecoveryStep::RESTART_CAPTURE:
+                // Clears a CAPTURE queue error; the OUTPUT queue keeps its bitstream
+                if (!device_->stream_off(V4L2_BUF_TYPE_VIDEO_CAPTURE_MPLANE)) {
+                    return false;
+                }
+                return requeueIdleCaptureBuffers() && device_->stream_on(V4L2_BUF_TYPE_VIDEO_CAPTURE_MPLANE);
+
+            case V4L2Decoder::RecoveryStep::RESTART_DECODER:
+                (void)device_->stream_off(V4L2_BUF_TYPE_VIDEO_OUTPUT_MPLANE);
+                (void)device_->stream_off(V4L2_BUF_TYPE_VIDEO_CAPTURE_MPLANE);
+                input_buffers_->reset_usage();
+                return requeueIdleCaptureBuffers() &&
+                       device_->stream_on(V4L2_BUF_TYPE_VIDEO_OUTPUT_MPLANE) &&
+                       device_->stream_on(V4L2_BUF_TYPE_VIDEO_CAPTURE_MPLANE);
+
+            case V4L2Decoder::RecoveryStep::REALLOCATE:
+                return resetBuffers() && streaming_manager_->start();
+        }
+        return false;
+    }
+
+    // POLLERR while every CAPTURE buffer is on screen or with a consumer is
+    // starvation, not an error: it clears once a buffer is released
+    [[nodiscard]] bool deviceHealthy() {
+        if (!device_->poll(POLLERR, 0) || !device_->has_error()) {
+            return true;
+        }
+        return queuedCaptureBuffers() == 0 && idleCaptureBuffers().empty();
+    }
+
+    [[nodiscard]] bool queryCaptureBuffer(unsigned int index, uint32_t& flags) {
+        struct v4l2_buffer buf = {};
+        struct v4l2_plane plane = {};
+        buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE_MPLANE;
+        buf.memory = V4L2_MEMORY_DMABUF;
+        buf.index = index;
+        buf.m.planes = &plane;
+        buf.length = 1;
+        if (!device_->query_buffer(buf)) {
+            return false;
+        }
+        flags = buf.flags;
+        return true;
+    }
+
+    // CAPTURE buffers owned by nobody: not in the driver, not displayed, not exported
+    [[nodiscard]] std::vector<unsigned int> idleCaptureBuffers() {
+        std::vector<unsigned int> idle;
+        for (unsigned int index = 0; index < output_buffers_->count(); ++index) {
+            uint32_t flags = 0;
+            bool owned = index < buffer_owners.size() && buffer_owners[index] > 0;
+            if (!owned && queryCaptureBuffer(index, flags) &&
+                !(flags & (V4L2_BUF_FLAG_QUEUED | V4L2_BUF_FLAG_DONE))) {
+                idle.push_back(index);
+            }
+        }
+        return idle;
+    }
+
+    [[nodiscard]] size_t queuedCaptureBuffers() {
+        size_t queued = 0;
+        for (unsigned int index = 0; index < output_buffers_->count(); ++index) {
+            uint32_t flags = 0;
+            queued += queryCaptureBuffer(index, flags) && (flags & V4L2_BUF_FLAG_QUEUED);
+        }
+        return queued;
+    }
+
+    [[nodiscard]] bool requeueIdleCaptureBuffers() {
+        bool ok = true;
+        for (unsigned int index : idleCaptureBuffers()) {
+            ok = queueOutputBuffer(index) && ok;
+        }
+        return ok;
+    }
+
     [[nodiscard]] bool requeueOutputBuffer(const v4l2_buffer& out_buf) {
         struct v4l2_buffer requeue_buf = out_buf;
         struct v4l2_plane requeue_plane = {};
@@ -705,11 +1339,14 @@ public:
             if (output_buffers_) {
                 output_buffers_->deallocate();
             }
-            zero_copy_initialized.clear();
         }
 
         // Cleanup display manager before closing device
         if (display_manager) {
+            withFrameProcessor([](auto& processor) {
+                processor.resetHeldBuffers();
+                processor.setDisplay(nullptr);
+            });
             display_manager.reset();
         }
 
@@ -722,7 +1359,7 @@ public:
         frame_width = 0;
         frame_height = 0;
 
-        std::cout << "V4L2 decoder shut down. Decoded frames: " << decoded_frame_count << std::endl;
+        std::cout << "V4L2 decoder shut down. Decoded frames: " << getDecodedFrameCount() << std::endl;
     }
 };
 
@@ -733,7 +1370,39 @@ V4L2Decoder::~V4L2Decoder() = default;
 
 bool V4L2Decoder::initialize(const DecoderConfig& config) { return impl->initialize(config); }
 bool V4L2Decoder::setDisplay() { return impl->setDisplay(); }
-bool V4L2Decoder::decodeData(const uint8_t* data, size_t size) { return impl->decodeData(data, size); }
+bool V4L2Decoder::decodeData(const uint8_t* data, size_t size, uint32_t rtp_timestamp) {
+    return impl->decodeData(data, size, rtp_timestamp);
+}
+bool V4L2Decoder::trySubmitData(const uint8_t* data, size_t size, uint32_t rtp_timestamp, bool& submitted) {
+    return impl->trySubmitData(data, size, rtp_timestamp, submitted);
+}
+bool V4L2Decoder::collectFrames() { return impl->collectFrames(); }
+int V4L2Decoder::deviceFd() const { return impl->deviceFd(); }
+int V4L2Decoder::displayEventFd() const { return impl->displayEventFd(); }
+bool V4L2Decoder::displayBusy() const { return impl->displayBusy(); }
+void V4L2Decoder::dispatchDisplayEvents() { impl->dispatchDisplayEvents(); }
 bool V4L2Decoder::flushDecoder() { return impl->flushDecoder(); }
 bool V4L2Decoder::resetBuffers() { return impl->resetBuffers(); }
+bool V4L2Decoder::resetStream(bool blank_display) { return impl->resetStream(blank_display); }
+bool V4L2Decoder::suspend(bool blank_display, bool release_buffers) { return impl->suspend(blank_display, release_buffers); }
 int V4L2Decoder::getDecodedFrameCount() const { return impl->getDecodedFrameCount(); }
+V4L2Decoder::RecoveryStatistics V4L2Decoder::getRecoveryStatistics() const { return impl->getRecoveryStatistics(); }
+void V4L2Decoder::requestRecovery(RecoveryStep from) { impl->requestRecovery(from); }
+void V4L2Decoder::requestDisplayRecovery() { impl->requestDisplayRecovery(); }
+V4L2Decoder::Progress V4L2Decoder::getProgress() const { return impl->getProgress(); }
+
+const char* V4L2Decoder::recoveryStepName(RecoveryStep step) {
+    switch (step) {
+        case RecoveryStep::REQUEUE:         return "requeue";
+        case RecoveryStep::RESTART_CAPTURE: return "capture restart";
+        case RecoveryStep::RESTART_DECODER: return "decoder restart";
+        case RecoveryStep::REALLOCATE:      return "reallocation";
+    }
+    return "unknown";
+}
+std::vector<pipeline::StageMetrics> V4L2Decoder::getStageMetrics() const { return impl->getStageMetrics(); }
+DisplayBackend::Statistics V4L2Decoder::getDisplayStatistics() const { return impl->getDisplayStatistics(); }
+void V4L2Decoder::setOsdText(const std::vector<std::string>& lines) { impl->setOsdText(lines); }
+int V4L2Decoder::addFrameConsumer(FrameConsumer consumer) { return impl->addFrameConsumer(std::move(consumer)); }
+void V4L2Decoder::removeFrameConsumer(int id) { impl->removeFrameConsumer(id); }
+void V4L2Decoder::setFlightRecorder(FlightRecorder* recorder) { impl->setFlightRecorder(recorder); }
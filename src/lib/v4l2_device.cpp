@@ -99,6 +99,10 @@ bool V4L2Device::stream_on(enum v4l2_buf_type type) {
     return ioctl_helper(VIDIOC_STREAMON, &type, "VIDIOC_STREAMON");
 }
 
+bool V4L2Device::query_buffer(v4l2_buffer& buf) {
+    return ioctl_helper(VIDIOC_QUERYBUF, &buf, "VIDIOC_QUERYBUF");
+}
+
 bool V4L2Device::stream_off(enum v4l2_buf_type type) {
     return ioctl_helper(VIDIOC_STREAMOFF, &type, "VIDIOC_STREAMOFF");
 }
@@ -0,0 +1,199 @@
+#include "watchdog.h"
+#include "v4l2_decoder.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <ctime>
+#include <mutex>
+#include <thread>
+
+class Watchdog::Impl {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    // Output of one stage and whether a recovery for it is in flight
+    struct StageState {
+        Clock::time_point progressed;
+        Clock::time_point last_action;
+        uint32_t actions = 0;               // Since the stage last made progress
+    };
+
+    [[nodiscard]] bool start(V4L2Decoder& watched) {
+        if (thread.joinable()) {
+            return true;
+        }
+        decoder = &watched;
+        stopping = false;
+        thread = std::thread(&Impl::run, this);
+        pipeline::setThreadName(thread, "watchdog");
+        std::cout << "🐕 Watchdog started: stall after " << config.stall_frames << " frames (at least "
+                  << config.min_stall_ms << " ms) without progress" << std::endl;
+        return true;
+    }
+
+    void stop() noexcept {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+
+    void run() {
+        auto now = Clock::now();
+        V4L2Decoder::Progress last = decoder->getProgress();
+        Clock::time_point input_progressed = now;
+        StageState decode{now, {}, 0};
+        StageState display{now, {}, 0};
+        double frame_interval_ms = 1000.0 / 30;     // Until frames are measured
+
+        std::unique_lock<std::mutex> lock(mutex);
+        while (!wake.wait_for(lock, std::chrono::milliseconds(config.check_interval_ms), [this] { return stopping; })) {
+            lock.unlock();
+            now = Clock::now();
+            V4L2Decoder::Progress progress = decoder->getProgress();
+
+            if (progress.submitted != last.submitted || progress.submit_waits != last.submit_waits) {
+                input_progressed = now;
+            }
+            if (progress.dequeued != last.dequeued) {
+                // Frame rate from steady decoding only; pauses in the stream are not frames
+                double elapsed_ms = std::chrono::duration<double, std::milli>(now - decode.progressed).count();
+                double interval = elapsed_ms / static_cast<double>(progress.dequeued - last.dequeued);
+                if (elapsed_ms < 1000.0) {
+                    frame_interval_ms = frame_interval_ms * 0.8 + interval * 0.2;
+                }
+                decode = {now, {}, 0};
+            }
+            if (progress.presented != last.presented) {
+                display = {now, {}, 0};
+            }
+
+            auto threshold = std::chrono::milliseconds(std::max<int64_t>(
+                config.min_stall_ms, static_cast<int64_t>(config.stall_frames * frame_interval_ms)));
+
+            // Decoder: access units keep coming, decoded frames stopped
+            if (input_progressed > decode.progressed && stalled(decode, now, threshold)) {
+                onDecoderStall(decode, progress, now, threshold, frame_interval_ms);
+            } else if (progress.has_display && decode.progressed > display.progressed &&
+                       stalled(display, now, threshold)) {
+                // Display: frames are decoded, flips stopped
+                onDisplayStall(display, progress, now, threshold, frame_interval_ms);
+            }
+
+            last = progress;
+            lock.lock();
+        }
+    }
+
+    // Silent for the threshold, and for longer after each recovery that did not help
+    static bool stalled(const StageState& stage, Clock::time_point now, std::chrono::milliseconds threshold) {
+        if (now - stage.progressed < threshold) {
+            return false;
+        }
+        auto backoff = threshold * (1 << std::min<uint32_t>(stage.actions, 4));
+        return stage.actions == 0 || now - stage.last_action >= backoff;
+    }
+
+    void onDecoderStall(StageState& stage, const V4L2Decoder::Progress& progress, Clock::time_point now,
+                        std::chrono::milliseconds threshold, double frame_interval_ms) {
+        // A restart that did not bring frames back escalates to reallocation
+        auto step = stage.actions == 0 ? V4L2Decoder::RecoveryStep::RESTART_DECODER
+                                       : V4L2Decoder::RecoveryStep::REALLOCATE;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stats.decoder_stalls++;
+            stats.escalations += stage.actions > 0;
+        }
+        report("decoder", progress, now - stage.progressed, threshold, frame_interval_ms,
+               V4L2Decoder::recoveryStepName(step));
+        decoder->requestRecovery(step);
+        stage.last_action = now;
+        stage.actions++;
+    }
+
+    void onDisplayStall(StageState& stage, const V4L2Decoder::Progress& progress, Clock::time_point now,
+                        std::chrono::milliseconds threshold, double frame_interval_ms) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stats.display_stalls++;
+        }
+        report("display", progress, now - stage.progressed, threshold, frame_interval_ms, "display re-probe");
+        decoder->requestDisplayRecovery();
+        stage.last_action = now;
+        stage.actions++;
+    }
+
+    // Diagnostic snapshot: everything needed to tell where the pipeline stopped
+    void report(const char* stage, const V4L2Decoder::Progress& progress, Clock::duration stalled_for,
+                std::chrono::milliseconds threshold, double frame_interval_ms, const char* action) {
+        std::ostringstream out;
+        out << "🐕 Watchdog: " << stage << " stalled for "
+            << std::chrono::duration_cast<std::chrono::milliseconds>(stalled_for).count() << " ms (threshold "
+            << threshold.count() << " ms at ~" << static_cast<int>(1000.0 / frame_interval_ms) << " fps), requesting "
+            << action << "\n";
+        out << "   submitted " << progress.submitted << ", waits for OUTPUT buffers " << progress.submit_waits
+            << ", dequeued " << progress.dequeued << ", presented " << progress.presented << "\n";
+        for (const auto& metrics : decoder->getStageMetrics()) {
+            out << "   " << metrics.name << ": accepted " << metrics.accepted << ", processed " << metrics.processed
+                << ", dropped " << metrics.dropped << ", max " << metrics.max_process_us << " us\n";
+        }
+        auto display = decoder->getDisplayStatistics();
+        out << "   display: flips " << display.flips << ", timeouts " << display.flip_timeouts
+            << ", avg flip " << display.avg_flip_latency_us << " us\n";
+        auto recovery = decoder->getRecoveryStatistics();
+        out << "   recovery:";
+        for (size_t step = 0; step < V4L2Decoder::RECOVERY_STEPS; ++step) {
+            out << " " << V4L2Decoder::recoveryStepName(static_cast<V4L2Decoder::RecoveryStep>(step)) << " "
+                << recovery.recovered[step] << "/" << recovery.attempts[step];
+        }
+        out << ", failed " << recovery.failures << "\n";
+
+        std::cerr << out.str() << std::flush;
+        if (!config.snapshot_path.empty()) {
+            std::ofstream file(config.snapshot_path, std::ios::app);
+            if (file) {
+                char stamp[32];
+                std::time_t wall = std::time(nullptr);
+                std::strftime(stamp, sizeof(stamp), "%Y-%m-%d %H:%M:%S", std::localtime(&wall));
+                file << stamp << "\n" << out.str();
+            }
+        }
+    }
+
+    Config config;
+    V4L2Decoder* decoder = nullptr;
+    std::thread thread;
+    mutable std::mutex mutex;
+    std::condition_variable wake;
+    bool stopping = false;
+    Statistics stats;
+};
+
+Watchdog::Watchdog(const Config& config) : impl_(std::make_unique<Impl>()) {
+    impl_->config = config;
+}
+
+Watchdog::~Watchdog() {
+    impl_->stop();
+}
+
+bool Watchdog::start(V4L2Decoder& decoder) {
+    return impl_->start(decoder);
+}
+
+void Watchdog::stop() noexcept {
+    impl_->stop();
+}
+
+Watchdog::Statistics Watchdog::getStatistics() const {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    return impl_->stats;
+}
@@ -0,0 +1,575 @@
+#include "wayland_display.h"
+#include <iostream>
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <ctime>
+#include <mutex>
+#include <poll.h>
+#include <drm_fourcc.h>
+#include <wayland-client.h>
+#include "xdg-shell-client-protocol.h"
+#include "linux-dmabuf-unstable-v1-client-protocol.h"
+#include "presentation-time-client-protocol.h"
+#ifdef RTP_PLAYER_WAYLAND_FIFO
+#include "fifo-v1-client-protocol.h"
+#endif
+#ifdef RTP_PLAYER_WAYLAND_COMMIT_TIMING
+#include "commit-timing-v1-client-protocol.h"
+#endif
+
+namespace {
+
+constexpr int FEEDBACK_TIMEOUT_MS = 100;
+constexpr int CONFIGURE_TIMEOUT_MS = 2000;
+
+uint64_t nowNs(clockid_t clock) {
+    timespec ts = {};
+    clock_gettime(clock, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + ts.tv_nsec;
+}
+
+} // namespace
+
+class WaylandDisplay::Impl {
+public:
+    // One decoder buffer wrapped as a wl_buffer
+    struct Buffer {
+        Impl* owner = nullptr;
+        int dma_fd = -1;
+        wl_buffer* buffer = nullptr;
+    };
+
+    // Presentation feedback of one commit
+    struct Feedback {
+        Impl* owner = nullptr;
+        // Elaborated: the scanner also generates a wp_presentation_feedback() request function
+        struct wp_presentation_feedback* feedback = nullptr;
+        uint64_t submit_ns = 0;
+    };
+
+    DisplayConfig config;
+    PresentMode present_mode = PresentMode::VSYNC;
+    uint32_t width = 0;
+    uint32_t height = 0;
+
+    wl_display* display = nullptr;
+    wl_registry* registry = nullptr;
+    wl_compositor* compositor = nullptr;
+    xdg_wm_base* wm_base = nullptr;
+    zwp_linux_dmabuf_v1* dmabuf = nullptr;
+    wp_presentation* presentation = nullptr;
+    wl_surface* surface = nullptr;
+    xdg_surface* shell_surface = nullptr;
+    xdg_toplevel* toplevel = nullptr;
+#ifdef RTP_PLAYER_WAYLAND_FIFO
+    wp_fifo_manager_v1* fifo_manager = nullptr;
+    wp_fifo_v1* fifo = nullptr;
+#endif
+#ifdef RTP_PLAYER_WAYLAND_COMMIT_TIMING
+    wp_commit_timing_manager_v1* timing_manager = nullptr;
+    wp_commit_timer_v1* timer = nullptr;
+#endif
+
+    clockid_t presentation_clock = CLOCK_MONOTONIC;
+    bool configured = false;
+    bool closed = false;
+    bool yuv420_supported = false;
+
+    std::vector<std::unique_ptr<Buffer>> buffers;
+    std::vector<std::unique_ptr<Feedback>> feedbacks;
+    std::vector<int> released_fds;
+
+    // Last presentation, for targeting the next refresh cycle
+    uint64_t last_presented_ns = 0;
+    uint64_t refresh_ns = 0;
+
+    mutable std::mutex stats_mutex;
+    Statistics stats;
+    uint64_t latency_total_us = 0;
+
+    ~Impl() { cleanup(); }
+
+    // --- Listeners ---
+
+    static void onGlobal(void* data, wl_registry* reg, uint32_t name, const char* interface, uint32_t version) {
+        auto* impl = static_cast<Impl*>(data);
+        if (std::strcmp(interface, wl_compositor_interface.name) == 0) {
+            impl->compositor = static_cast<wl_compositor*>(
+                wl_registry_bind(reg, name, &wl_compositor_interface, std::min<uint32_t>(version, 4)));
+        } else if (std::strcmp(interface, xdg_wm_base_interface.name) == 0) {
+            impl->wm_base = static_cast<xdg_wm_base*>(wl_registry_bind(reg, name, &xdg_wm_base_interface, 1));
+            xdg_wm_base_add_listener(impl->wm_base, &wm_base_listener, impl);
+        } else if (std::strcmp(interface, zwp_linux_dmabuf_v1_interface.name) == 0 && version >= 3) {
+            // v3 still announces format/modifier pairs directly (v4 moved them to feedback objects)
+            impl->dmabuf = static_cast<zwp_linux_dmabuf_v1*>(
+                wl_registry_bind(reg, name, &zwp_linux_dmabuf_v1_interface, 3));
+            zwp_linux_dmabuf_v1_add_listener(impl->dmabuf, &dmabuf_listener, impl);
+        } else if (std::strcmp(interface, wp_presentation_interface.name) == 0) {
+            impl->presentation = static_cast<wp_presentation*>(
+                wl_registry_bind(reg, name, &wp_presentation_interface, 1));
+            wp_presentation_add_listener(impl->presentation, &presentation_listener, impl);
+        }
+#ifdef RTP_PLAYER_WAYLAND_FIFO
+        else if (std::strcmp(interface, wp_fifo_manager_v1_interface.name) == 0) {
+            impl->fifo_manager = static_cast<wp_fifo_manager_v1*>(
+                wl_registry_bind(reg, name, &wp_fifo_manager_v1_interface, 1));
+        }
+#endif
+#ifdef RTP_PLAYER_WAYLAND_COMMIT_TIMING
+        else if (std::strcmp(interface, wp_commit_timing_manager_v1_interface.name) == 0) {
+            impl->timing_manager = static_cast<wp_commit_timing_manager_v1*>(
+                wl_registry_bind(reg, name, &wp_commit_timing_manager_v1_interface, 1));
+        }
+#endif
+    }
+
+    static void onGlobalRemove(void*, wl_registry*, uint32_t) {}
+
+    static void onPing(void*, xdg_wm_base* base, uint32_t serial) {
+        xdg_wm_base_pong(base, serial);
+    }
+
+    static void onFormat(void*, zwp_linux_dmabuf_v1*, uint32_t) {}
+
+    static void onModifier(void* data, zwp_linux_dmabuf_v1*, uint32_t format, uint32_t modifier_hi, uint32_t modifier_lo) {
+        uint64_t modifier = (static_cast<uint64_t>(modifier_hi) << 32) | modifier_lo;
+        if (format == DRM_FORMAT_YUV420 && (modifier == DRM_FORMAT_MOD_LINEAR || modifier == DRM_FORMAT_MOD_INVALID)) {
+            static_cast<Impl*>(data)->yuv420_supported = true;
+        }
+    }
+
+    static void onClockId(void* data, wp_presentation*, uint32_t clock_id) {
+        static_cast<Impl*>(data)->presentation_clock = static_cast<clockid_t>(clock_id);
+    }
+
+    static void onSurfaceConfigure(void* data, xdg_surface* surf, uint32_t serial) {
+        xdg_surface_ack_configure(surf, serial);
+        static_cast<Impl*>(data)->configured = true;
+    }
+
+    static void onToplevelConfigure(void*, xdg_toplevel*, int32_t, int32_t, wl_array*) {}
+
+    static void onToplevelBounds(void*, xdg_toplevel*, int32_t, int32_t) {}
+    static void onToplevelCapabilities(void*, xdg_toplevel*, wl_array*) {}
+
+    static void onToplevelClose(void* data, xdg_toplevel*) {
+        std::cout << "🪟 Compositor closed the video window" << std::endl;
+        static_cast<Impl*>(data)->closed = true;
+    }
+
+    static void onBufferRelease(void* data, wl_buffer*) {
+        auto* buffer = static_cast<Buffer*>(data);
+        buffer->owner->released_fds.push_back(buffer->dma_fd);
+    }
+
+    static void onSyncOutput(void*, struct wp_presentation_feedback*, wl_output*) {}
+
+    static void onPresented(void* data, struct wp_presentation_feedback*, uint32_t tv_sec_hi, uint32_t tv_sec_lo,
+                            uint32_t tv_nsec, uint32_t refresh, uint32_t, uint32_t, uint32_t flags) {
+        auto* feedback = static_cast<Feedback*>(data);
+        Impl* impl = feedback->owner;
+        uint64_t presented_ns = ((static_cast<uint64_t>(tv_sec_hi) << 32 | tv_sec_lo) * 1000000000ULL) + tv_nsec;
+        uint64_t latency = presented_ns > feedback->submit_ns ? (presented_ns - feedback->submit_ns) / 1000 : 0;
+
+        impl->last_presented_ns = presented_ns;
+        impl->refresh_ns = refresh;
+        {
+            std::lock_guard<std::mutex> lock(impl->stats_mutex);
+            Statistics& stats = impl->stats;
+            stats.flips++;
+            if (!(flags & WP_PRESENTATION_FEEDBACK_KIND_VSYNC)) {
+                stats.async_flips++;
+            }
+            impl->latency_total_us += latency;
+            stats.avg_flip_latency_us = static_cast<double>(impl->latency_total_us) / stats.flips;
+            stats.max_flip_latency_us = std::max<uint64_t>(stats.max_flip_latency_us, latency);
+            if (stats.flips % 300 == 0) {
+                std::cout << "📺 Presented: " << stats.flips << " (" << stats.discarded << " discarded), latency avg "
+                          << static_cast<int>(stats.avg_flip_latency_us) << " us, max " << stats.max_flip_latency_us
+                          << " us" << std::endl;
+            }
+        }
+        impl->finishFeedback(feedback);
+    }
+
+    static void onDiscarded(void* data, struct wp_presentation_feedback*) {
+        auto* feedback = static_cast<Feedback*>(data);
+        {
+            std::lock_guard<std::mutex> lock(feedback->owner->stats_mutex);
+            feedback->owner->stats.discarded++;
+        }
+        feedback->owner->finishFeedback(feedback);
+    }
+
+    static constexpr wl_registry_listener registry_listener = {
+        .global = &Impl::onGlobal, .global_remove = &Impl::onGlobalRemove};
+    static constexpr xdg_wm_base_listener wm_base_listener = {.ping = &Impl::onPing};
+    static constexpr zwp_linux_dmabuf_v1_listener dmabuf_listener = {
+        .format = &Impl::onFormat, .modifier = &Impl::onModifier};
+    static constexpr wp_presentation_listener presentation_listener = {.clock_id = &Impl::onClockId};
+    static constexpr xdg_surface_listener surface_listener = {.configure = &Impl::onSurfaceConfigure};
+    static constexpr xdg_toplevel_listener toplevel_listener = {
+        .configure = &Impl::onToplevelConfigure, .close = &Impl::onToplevelClose,
+        .configure_bounds = &Impl::onToplevelBounds, .wm_capabilities = &Impl::onToplevelCapabilities};
+    static constexpr wl_buffer_listener buffer_listener = {.release = &Impl::onBufferRelease};
+    static constexpr wp_presentation_feedback_listener feedback_listener = {
+        .sync_output = &Impl::onSyncOutput, .presented = &Impl::onPresented, .discarded = &Impl::onDiscarded};
+
+    // --- Setup ---
+
+    bool initialize() {
+        display = wl_display_connect(nullptr);
+        if (!display) {
+            std::cerr << "Cannot connect to the Wayland compositor (WAYLAND_DISPLAY unset?)" << std::endl;
+            return false;
+        }
+
+        registry = wl_display_get_registry(display);
+        wl_registry_add_listener(registry, &registry_listener, this);
+        // First roundtrip binds the globals, the second collects the dmabuf modifiers
+        if (wl_display_roundtrip(display) < 0 || wl_display_roundtrip(display) < 0) {
+            std::cerr << "Wayland registry roundtrip failed" << std::endl;
+            return false;
+        }
+
+        if (!compositor || !wm_base || !dmabuf) {
+            std::cerr << "Compositor lacks wl_compositor, xdg_wm_base or zwp_linux_dmabuf_v1 (v3+)" << std::endl;
+            return false;
+        }
+        if (!yuv420_supported) {
+            std::cerr << "Compositor does not import linear YUV420 dma-bufs" << std::endl;
+            return false;
+        }
+
+        surface = wl_compositor_create_surface(compositor);
+        shell_surface = xdg_wm_base_get_xdg_surface(wm_base, surface);
+        xdg_surface_add_listener(shell_surface, &surface_listener, this);
+        toplevel = xdg_surface_get_toplevel(shell_surface);
+        xdg_toplevel_add_listener(toplevel, &toplevel_listener, this);
+        xdg_toplevel_set_title(toplevel, "RTP Player");
+        xdg_toplevel_set_app_id(toplevel, "rtp_player");
+        // The compositor centres (and may letterbox) a fullscreen surface smaller than the output
+        xdg_toplevel_set_fullscreen(toplevel, nullptr);
+        wl_surface_set_buffer_transform(surface, bufferTransform());
+
+#ifdef RTP_PLAYER_WAYLAND_FIFO
+        if (fifo_manager) {
+            fifo = wp_fifo_manager_v1_get_fifo(fifo_manager, surface);
+        }
+#endif
+#ifdef RTP_PLAYER_WAYLAND_COMMIT_TIMING
+        if (timing_manager) {
+            timer = wp_commit_timing_manager_v1_get_timer(timing_manager, surface);
+        }
+#endif
+
+        // Buffers may only be attached after the first configure
+        wl_surface_commit(surface);
+        uint64_t deadline = nowNs(CLOCK_MONOTONIC) + CONFIGURE_TIMEOUT_MS * 1000000ULL;
+        while (!configured && nowNs(CLOCK_MONOTONIC) < deadline) {
+            if (!dispatchEvents(FEEDBACK_TIMEOUT_MS)) {
+                std::cerr << "Wayland connection error: " << strerror(errno) << std::endl;
+                return false;
+            }
+        }
+        if (!configured) {
+            std::cerr << "No xdg_surface configure from the compositor" << std::endl;
+            return false;
+        }
+
+        std::cout << "✅ Wayland output: presentation feedback " << (presentation ? "yes" : "no")
+                  << ", fifo " << (hasFifo() ? "yes" : "no")
+                  << ", commit timing " << (hasCommitTiming() ? "yes" : "no") << std::endl;
+        return true;
+    }
+
+    bool hasFifo() const {
+#ifdef RTP_PLAYER_WAYLAND_FIFO
+        return fifo != nullptr;
+#else
+        return false;
+#endif
+    }
+
+    bool hasCommitTiming() const {
+#ifdef RTP_PLAYER_WAYLAND_COMMIT_TIMING
+        return timer != nullptr;
+#else
+        return false;
+#endif
+    }
+
+    // wl_output.transform rotates counter-clockwise and the compositor applies
+    // the inverse, so a clockwise rotation maps to the same quarter count.
+    // A vertical reflection is a horizontal one turned by 180 degrees.
+    int32_t bufferTransform() const {
+        bool flipped = config.reflect_x != config.reflect_y;
+        uint32_t quarters = (config.rotation / 90 + (config.reflect_y ? 2 : 0)) % 4;
+        return static_cast<int32_t>((flipped ? WL_OUTPUT_TRANSFORM_FLIPPED : WL_OUTPUT_TRANSFORM_NORMAL) + quarters);
+    }
+
+    bool setupZeroCopyBuffer(int dma_fd, uint32_t w, uint32_t h, uint32_t stride) {
+        if (dma_fd < 0 || w == 0 || h == 0) {
+            std::cerr << "Invalid buffer for Wayland import: fd=" << dma_fd << ", " << w << "x" << h << std::endl;
+            return false;
+        }
+        if (findBuffer(dma_fd)) {
+            return true;
+        }
+
+        // Same single-buffer I420 layout as the DRM framebuffer
+        const auto layout = DisplayBackend::i420Layout(stride ? stride : w, h);
+        const uint64_t modifier = DRM_FORMAT_MOD_LINEAR;
+
+        zwp_linux_buffer_params_v1* params = zwp_linux_dmabuf_v1_create_params(dmabuf);
+        for (uint32_t plane = 0; plane < 3; plane++) {
+            zwp_linux_buffer_params_v1_add(params, dma_fd, plane, layout.offsets[plane], layout.pitches[plane],
+                                           static_cast<uint32_t>(modifier >> 32), static_cast<uint32_t>(modifier));
+        }
+        // Import errors are protocol errors, reported on the next roundtrip
+        wl_buffer* wl_buf = zwp_linux_buffer_params_v1_create_immed(params, static_cast<int32_t>(w),
+                                                                    static_cast<int32_t>(h), DRM_FORMAT_YUV420, 0);
+        zwp_linux_buffer_params_v1_destroy(params);
+        if (!wl_buf || wl_display_roundtrip(display) < 0) {
+            std::cerr << "Error importing DMA-buf " << dma_fd << " into the compositor" << std::endl;
+            return false;
+        }
+
+        auto buffer = std::make_unique<Buffer>();
+        buffer->owner = this;
+        buffer->dma_fd = dma_fd;
+        buffer->buffer = wl_buf;
+        wl_buffer_add_listener(wl_buf, &buffer_listener, buffer.get());
+        buffers.push_back(std::move(buffer));
+
+        std::cout << "✅ Wayland zero-copy buffer: DMA-fd=" << dma_fd << ", " << w << "x" << h << std::endl;
+        return true;
+    }
+
+    Buffer* findBuffer(int dma_fd) {
+        for (auto& buffer : buffers) {
+            if (buffer->dma_fd == dma_fd) {
+                return buffer.get();
+            }
+        }
+        return nullptr;
+    }
+
+    // --- Presentation ---
+
+    void finishFeedback(Feedback* feedback) {
+        wp_presentation_feedback_destroy(feedback->feedback);
+        feedbacks.erase(std::remove_if(feedbacks.begin(), feedbacks.end(),
+                                       [feedback](const auto& f) { return f.get() == feedback; }),
+                        feedbacks.end());
+    }
+
+    // Read and dispatch what the compositor sent, waiting at most timeout_ms
+    bool dispatchEvents(int timeout_ms) {
+        while (wl_display_prepare_read(display) != 0) {
+            if (wl_display_dispatch_pending(display) < 0) {
+                return false;
+            }
+        }
+        if (wl_display_flush(display) < 0 && errno != EAGAIN) {
+            wl_display_cancel_read(display);
+            return false;
+        }
+
+        pollfd pfd = {wl_display_get_fd(display), POLLIN, 0};
+        int ret = poll(&pfd, 1, timeout_ms);
+        if (ret > 0) {
+            if (wl_display_read_events(display) < 0) {
+                return false;
+            }
+        } else {
+            wl_display_cancel_read(display);
+            if (ret < 0 && errno != EINTR) {
+                return false;
+            }
+        }
+        return wl_display_dispatch_pending(display) >= 0;
+    }
+
+    // VSYNC keeps one commit in flight, like a page flip; ASYNC lets newer commits replace older ones
+    bool waitForPresentation() {
+        uint64_t deadline = nowNs(CLOCK_MONOTONIC) + FEEDBACK_TIMEOUT_MS * 1000000ULL;
+        while (!feedbacks.empty()) {
+            uint64_t now = nowNs(CLOCK_MONOTONIC);
+            if (now >= deadline) {
+                std::cerr << "⚠️ Presentation feedback timeout" << std::endl;
+                return false;
+            }
+            if (!dispatchEvents(static_cast<int>((deadline - now) / 1000000ULL) + 1)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Ask for the refresh cycle after the last presented one
+    void setTargetTime() {
+#ifdef RTP_PLAYER_WAYLAND_COMMIT_TIMING
+        if (!timer || last_presented_ns == 0 || refresh_ns == 0) {
+            return;
+        }
+        uint64_t now = nowNs(presentation_clock);
+        uint64_t cycles = now > last_presented_ns ? (now - last_presented_ns) / refresh_ns + 1 : 1;
+        uint64_t target = last_presented_ns + cycles * refresh_ns;
+        uint64_t seconds = target / 1000000000ULL;
+        wp_commit_timer_v1_set_timestamp(timer, static_cast<uint32_t>(seconds >> 32), static_cast<uint32_t>(seconds),
+                                         static_cast<uint32_t>(target % 1000000000ULL));
+#endif
+    }
+
+    bool displayZeroCopyFrame(int dma_fd) {
+        Buffer* buffer = findBuffer(dma_fd);
+        if (!buffer) {
+            std::cerr << "Buffer not found for DMA-fd " << dma_fd << std::endl;
+            return false;
+        }
+        if (closed) {
+            return false;
+        }
+
+        bool vsync = present_mode == PresentMode::VSYNC;
+        if (vsync) {
+            (void)waitForPresentation();
+        }
+
+#ifdef RTP_PLAYER_WAYLAND_FIFO
+        if (fifo && vsync) {
+            // Never latch before the previous commit has been shown
+            wp_fifo_v1_wait_barrier(fifo);
+            wp_fifo_v1_set_barrier(fifo);
+        }
+#endif
+        if (vsync) {
+            setTargetTime();
+        }
+
+        wl_surface_attach(surface, buffer->buffer, 0, 0);
+        wl_surface_damage_buffer(surface, 0, 0, INT32_MAX, INT32_MAX);
+        if (presentation) {
+            auto feedback = std::make_unique<Feedback>();
+            feedback->owner = this;
+            feedback->feedback = wp_presentation_feedback(presentation, surface);
+            feedback->submit_ns = nowNs(presentation_clock);
+            wp_presentation_feedback_add_listener(feedback->feedback, &feedback_listener, feedback.get());
+            feedbacks.push_back(std::move(feedback));
+        }
+        wl_surface_commit(surface);
+
+        // Pick up releases and feedback without blocking
+        if (!dispatchEvents(0)) {
+            std::cerr << "Wayland connection error: " << strerror(errno) << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    std::vector<int> takeReleasedBuffers() {
+        std::vector<int> released;
+        released.swap(released_fds);
+        return released;
+    }
+
+    void cleanup() noexcept {
+        for (auto& feedback : feedbacks) {
+            wp_presentation_feedback_destroy(feedback->feedback);
+        }
+        feedbacks.clear();
+        for (auto& buffer : buffers) {
+            wl_buffer_destroy(buffer->buffer);
+        }
+        buffers.clear();
+        released_fds.clear();
+
+#ifdef RTP_PLAYER_WAYLAND_COMMIT_TIMING
+        if (timer) { wp_commit_timer_v1_destroy(timer); timer = nullptr; }
+        if (timing_manager) { wp_commit_timing_manager_v1_destroy(timing_manager); timing_manager = nullptr; }
+#endif
+#ifdef RTP_PLAYER_WAYLAND_FIFO
+        if (fifo) { wp_fifo_v1_destroy(fifo); fifo = nullptr; }
+        if (fifo_manager) { wp_fifo_manager_v1_destroy(fifo_manager); fifo_manager = nullptr; }
+#endif
+        if (toplevel) { xdg_toplevel_destroy(toplevel); toplevel = nullptr; }
+        if (shell_surface) { xdg_surface_destroy(shell_surface); shell_surface = nullptr; }
+        if (surface) { wl_surface_destroy(surface); surface = nullptr; }
+        if (presentation) { wp_presentation_destroy(presentation); presentation = nullptr; }
+        if (dmabuf) { zwp_linux_dmabuf_v1_destroy(dmabuf); dmabuf = nullptr; }
+        if (wm_base) { xdg_wm_base_destroy(wm_base); wm_base = nullptr; }
+        if (compositor) { wl_compositor_destroy(compositor); compositor = nullptr; }
+        if (registry) { wl_registry_destroy(registry); registry = nullptr; }
+        if (display) {
+            wl_display_flush(display);
+            wl_display_disconnect(display);
+            display = nullptr;
+        }
+        configured = false;
+        closed = false;
+        yuv420_supported = false;
+    }
+};
+
+WaylandDisplay::WaylandDisplay() : impl_(std::make_unique<Impl>()) {}
+
+WaylandDisplay::~WaylandDisplay() = default;
+
+void WaylandDisplay::setConfig(const DisplayConfig& config) {
+    impl_->config = config;
+    impl_->present_mode = config.present_mode;
+    if (config.wall_columns * config.wall_rows > 1 || config.mirror_outputs) {
+        std::cerr << "⚠️ WARNING: mirroring and video wall are DRM-only, the compositor places the window" << std::endl;
+    }
+}
+
+bool WaylandDisplay::transformApplied() const {
+    return true;
+}
+
+bool WaylandDisplay::initialize(uint32_t width, uint32_t height) {
+    impl_->width = width;
+    impl_->height = height;
+    if (!impl_->initialize()) {
+        impl_->cleanup();
+        return false;
+    }
+    return true;
+}
+
+bool WaylandDisplay::displayFrame(const FrameInfo& frame) {
+    if (frame.is_dmabuf && frame.dma_fd >= 0) {
+        return impl_->displayZeroCopyFrame(frame.dma_fd);
+    }
+    std::cerr << "WaylandDisplay requires DMA-buf frames!" << std::endl;
+    return false;
+}
+
+void WaylandDisplay::cleanup() noexcept {
+    impl_->cleanup();
+}
+
+std::string WaylandDisplay::getDisplayInfo() const {
+    if (!impl_->display) {
+        return "Wayland (not connected)";
+    }
+    return "Wayland linux-dmabuf: " + std::to_string(impl_->width) + "x" + std::to_string(impl_->height) +
+           (impl_->hasFifo() ? ", fifo" : "") + (impl_->hasCommitTiming() ? ", commit-timing" : "") +
+           (impl_->presentation ? ", presentation feedback" : "");
+}
+
+bool WaylandDisplay::setupZeroCopyBuffer(int dma_fd, uint32_t width, uint32_t height, uint32_t stride) {
+    return impl_->setupZeroCopyBuffer(dma_fd, width, height, stride);
+}
+
+std::vector<int> WaylandDisplay::takeReleasedBuffers() {
+    return impl_->takeReleasedBuffers();
+}
+
+DisplayBackend::Statistics WaylandDisplay::getStatistics() const {
+    std::lock_guard<std::mutex> lock(impl_->stats_mutex);
+    return impl_->stats;
+}
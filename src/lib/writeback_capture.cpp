@@ -0,0 +1,553 @@
+#include "writeback_capture.h"
+#include "pipeline.h"
+#include <iostream>
+#include <fstream>
+#include <cstring>
+#include <cerrno>
+#include <cstdio>
+#include <ctime>
+#include <algorithm>
+#include <deque>
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/ioctl.h>
+#include <linux/sync_file.h>
+#include <xf86drm.h>
+#include <xf86drmMode.h>
+#include <drm_fourcc.h>
+
+namespace {
+
+constexpr int FENCE_TIMEOUT_MS = 1000;
+
+uint64_t monotonicNs() {
+    timespec ts = {};
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + ts.tv_nsec;
+}
+
+// When the out-fence signaled (CLOCK_MONOTONIC, like monotonicNs()); 0 if the driver does not say
+uint64_t fenceSignalNs(int fence_fd) {
+    sync_file_info info = {};
+    if (ioctl(fence_fd, SYNC_IOC_FILE_INFO, &info) < 0 || info.num_fences == 0) {
+        return 0;
+    }
+    std::vector<sync_fence_info> fences(info.num_fences);
+    info.sync_fence_info = reinterpret_cast<uint64_t>(fences.data());
+    if (ioctl(fence_fd, SYNC_IOC_FILE_INFO, &info) < 0) {
+        return 0;
+    }
+    uint64_t signaled_ns = 0;
+    for (const auto& fence : fences) {
+        if (fence.status != 1) {
+            return 0;
+        }
+        signaled_ns = std::max<uint64_t>(signaled_ns, fence.timestamp_ns);
+    }
+    return signaled_ns;
+}
+
+// The X byte of XRGB8888 is undefined in a capture
+constexpr uint32_t RGB_MASK = 0x00ffffff;
+
+} // namespace
+
+class WritebackCapture::Impl {
+public:
+    struct CaptureBuffer {
+        uint32_t handle = 0;
+        uint32_t pitch = 0;
+        uint64_t size = 0;
+        uint32_t fb_id = 0;
+        int dma_fd = -1;            // Exported so the capture can be handed on as a dma-buf
+        const uint8_t* pixels = nullptr;
+        bool busy = false;
+    };
+
+    // A committed capture waiting for its out-fence
+    struct PendingCapture {
+        CaptureBuffer* buffer = nullptr;
+        int fence_fd = -1;
+        uint64_t sequence = 0;
+        uint32_t source_fb_id = 0;
+        uint64_t commit_ns = 0;
+        bool test_pattern = false;
+    };
+
+    WritebackConfig config;
+    int drm_fd = -1;
+    uint32_t crtc_id = 0;
+    uint32_t connector_id = 0;
+    uint32_t width = 0;
+    uint32_t height = 0;
+
+    // Connector properties
+    uint32_t crtc_prop = 0;
+    uint32_t fb_prop = 0;
+    uint32_t fence_prop = 0;
+
+    std::vector<CaptureBuffer> buffers;
+
+    // Known frame for the self-check: its capture must match its own checksum
+    CaptureBuffer pattern;
+    uint64_t pattern_checksum = 0;
+
+    // Capture staged by addToCommit(); the kernel writes the fence into out_fence
+    CaptureBuffer* staged = nullptr;
+    uint32_t staged_source_fb_id = 0;
+    uint64_t staged_commit_ns = 0;
+    bool staged_test_pattern = false;
+    int32_t out_fence = -1;
+    uint64_t sequence = 0;
+
+    std::thread worker;
+    mutable std::mutex mutex;
+    std::condition_variable condition;
+    std::deque<PendingCapture> pending;
+    std::condition_variable drained;
+    bool processing = false;
+    bool running = false;
+
+    Statistics stats;
+    uint64_t latency_total_us = 0;
+    uint64_t last_checksum = 0;
+    std::ofstream log;
+
+    uint32_t findProperty(uint32_t object_id, const char* name, uint64_t* value = nullptr) {
+        drmModeObjectProperties* props = drmModeObjectGetProperties(drm_fd, object_id, DRM_MODE_OBJECT_CONNECTOR);
+        if (!props) {
+            return 0;
+        }
+        uint32_t id = 0;
+        for (uint32_t i = 0; i < props->count_props && id == 0; ++i) {
+            drmModePropertyRes* prop = drmModeGetProperty(drm_fd, props->props[i]);
+            if (prop) {
+                if (std::strcmp(prop->name, name) == 0) {
+                    id = prop->prop_id;
+                    if (value) {
+                        *value = props->prop_values[i];
+                    }
+                }
+                drmModeFreeProperty(prop);
+            }
+        }
+        drmModeFreeObjectProperties(props);
+        return id;
+    }
+
+    bool supportsXrgb(uint32_t id) {
+        uint64_t blob_id = 0;
+        if (!findProperty(id, "WRITEBACK_PIXEL_FORMATS", &blob_id) || blob_id == 0) {
+            return false;
+        }
+        drmModePropertyBlobRes* blob = drmModeGetPropertyBlob(drm_fd, static_cast<uint32_t>(blob_id));
+        if (!blob) {
+            return false;
+        }
+        const auto* formats = static_cast<const uint32_t*>(blob->data);
+        bool found = std::find(formats, formats + blob->length / sizeof(uint32_t), DRM_FORMAT_XRGB8888) !=
+                     formats + blob->length / sizeof(uint32_t);
+        drmModeFreePropertyBlob(blob);
+        return found;
+    }
+
+    bool canDriveCrtc(drmModeConnector* conn, uint32_t crtc_index) {
+        for (int i = 0; i < conn->count_encoders; ++i) {
+            drmModeEncoder* enc = drmModeGetEncoder(drm_fd, conn->encoders[i]);
+            if (!enc) {
+                continue;
+            }
+            bool possible = enc->possible_crtcs & (1u << crtc_index);
+            drmModeFreeEncoder(enc);
+            if (possible) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool findConnector(uint32_t crtc_index) {
+        // Writeback connectors are only listed for clients that ask for them
+        if (drmSetClientCap(drm_fd, DRM_CLIENT_CAP_WRITEBACK_CONNECTORS, 1) != 0) {
+            std::cerr << "Writeback: driver has no writeback connector support" << std::endl;
+            return false;
+        }
+
+        drmModeRes* resources = drmModeGetResources(drm_fd);
+        if (!resources) {
+            return false;
+        }
+        for (int i = 0; i < resources->count_connectors && connector_id == 0; ++i) {
+            drmModeConnector* conn = drmModeGetConnector(drm_fd, resources->connectors[i]);
+            if (!conn) {
+                continue;
+            }
+            if (conn->connector_type == DRM_MODE_CONNECTOR_WRITEBACK && canDriveCrtc(conn, crtc_index) &&
+                supportsXrgb(conn->connector_id)) {
+                connector_id = conn->connector_id;
+            }
+            drmModeFreeConnector(conn);
+        }
+        drmModeFreeResources(resources);
+
+        if (connector_id == 0) {
+            std::cerr << "Writeback: no XRGB8888 writeback connector for CRTC " << crtc_id << std::endl;
+            return false;
+        }
+
+        crtc_prop = findProperty(connector_id, "CRTC_ID");
+        fb_prop = findProperty(connector_id, "WRITEBACK_FB_ID");
+        fence_prop = findProperty(connector_id, "WRITEBACK_OUT_FENCE_PTR");
+        if (!crtc_prop || !fb_prop || !fence_prop) {
+            std::cerr << "Writeback: connector " << connector_id << " lacks writeback properties" << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    bool createBuffer(CaptureBuffer& buffer, bool writable = false) {
+        drm_mode_create_dumb create = {};
+        create.width = width;
+        create.height = height;
+        create.bpp = 32;
+        if (drmIoctl(drm_fd, DRM_IOCTL_MODE_CREATE_DUMB, &create) < 0) {
+            std::cerr << "Writeback: failed to create dumb buffer: " << strerror(errno) << std::endl;
+            return false;
+        }
+        buffer.handle = create.handle;
+        buffer.pitch = create.pitch;
+        buffer.size = create.size;
+
+        uint32_t handles[4] = {buffer.handle, 0, 0, 0};
+        uint32_t pitches[4] = {buffer.pitch, 0, 0, 0};
+        uint32_t offsets[4] = {0, 0, 0, 0};
+        if (drmModeAddFB2(drm_fd, width, height, DRM_FORMAT_XRGB8888,
+                          handles, pitches, offsets, &buffer.fb_id, 0) < 0) {
+            std::cerr << "Writeback: failed to create framebuffer: " << strerror(errno) << std::endl;
+            return false;
+        }
+        if (drmPrimeHandleToFD(drm_fd, buffer.handle, DRM_CLOEXEC | DRM_RDWR, &buffer.dma_fd) < 0) {
+            std::cerr << "Writeback: failed to export dma-buf: " << strerror(errno) << std::endl;
+            return false;
+        }
+
+        drm_mode_map_dumb map = {};
+        map.handle = buffer.handle;
+        if (drmIoctl(drm_fd, DRM_IOCTL_MODE_MAP_DUMB, &map) < 0) {
+            std::cerr << "Writeback: failed to map dumb buffer: " << strerror(errno) << std::endl;
+            return false;
+        }
+        void* addr = mmap(nullptr, buffer.size, PROT_READ | (writable ? PROT_WRITE : 0), MAP_SHARED, drm_fd, map.offset);
+        if (addr == MAP_FAILED) {
+            std::cerr << "Writeback: mmap failed: " << strerror(errno) << std::endl;
+            return false;
+        }
+        buffer.pixels = static_cast<const uint8_t*>(addr);
+        return true;
+    }
+
+    void destroyBuffer(CaptureBuffer& buffer) noexcept {
+        if (buffer.pixels) {
+            munmap(const_cast<uint8_t*>(buffer.pixels), buffer.size);
+            buffer.pixels = nullptr;
+        }
+        if (buffer.dma_fd >= 0) {
+            close(buffer.dma_fd);
+            buffer.dma_fd = -1;
+        }
+        if (buffer.fb_id) {
+            drmModeRmFB(drm_fd, buffer.fb_id);
+            buffer.fb_id = 0;
+        }
+        if (buffer.handle) {
+            drm_mode_destroy_dumb destroy = {};
+            destroy.handle = buffer.handle;
+            drmIoctl(drm_fd, DRM_IOCTL_MODE_DESTROY_DUMB, &destroy);
+            buffer.handle = 0;
+        }
+    }
+
+    // FNV-1a over 64-bit words of the visible pixels (the pitch padding is skipped)
+    uint64_t checksum(const CaptureBuffer& buffer, uint32_t pixel_mask = 0xffffffff) const {
+        uint64_t hash = 0xcbf29ce484222325ULL;
+        const uint64_t word_mask = (static_cast<uint64_t>(pixel_mask) << 32) | pixel_mask;
+        const size_t row_bytes = static_cast<size_t>(width) * 4;
+        for (uint32_t row = 0; row < height; ++row) {
+            const uint8_t* line = buffer.pixels + static_cast<size_t>(row) * buffer.pitch;
+            size_t i = 0;
+            for (; i + 8 <= row_bytes; i += 8) {
+                uint64_t word;
+                std::memcpy(&word, line + i, sizeof(word));
+                hash = (hash ^ (word & word_mask)) * 0x100000001b3ULL;
+            }
+            for (; i < row_bytes; ++i) {
+                hash = (hash ^ (line[i] & static_cast<uint8_t>(pixel_mask >> (i % 4 * 8)))) * 0x100000001b3ULL;
+            }
+        }
+        return hash;
+    }
+
+    // Colour bars over a gradient: every row and column differs, so a shifted,
+    // scaled or channel-swapped capture cannot match
+    bool createPattern() {
+        if (pattern.fb_id) {
+            return true;
+        }
+        if (!createBuffer(pattern, true)) {
+            destroyBuffer(pattern);
+            return false;
+        }
+        static constexpr uint32_t BARS[] = {0xffffff, 0xffff00, 0x00ffff, 0x00ff00,
+                                            0xff00ff, 0xff0000, 0x0000ff, 0x000000};
+        auto* pixels = const_cast<uint8_t*>(pattern.pixels);
+        for (uint32_t row = 0; row < height; ++row) {
+            auto* line = reinterpret_cast<uint32_t*>(pixels + static_cast<size_t>(row) * pattern.pitch);
+            for (uint32_t col = 0; col < width; ++col) {
+                uint32_t bar = BARS[static_cast<uint64_t>(col) * 8 / width];
+                line[col] = 0xff000000u | (bar ^ ((row & 0xff) << 8) ^ (col & 0xff));
+            }
+        }
+        pattern_checksum = checksum(pattern, RGB_MASK);
+        return true;
+    }
+
+    void dumpFrame(const CaptureBuffer& buffer, uint64_t seq) {
+        char name[64];
+        std::snprintf(name, sizeof(name), "/capture_%06llu.xrgb8888", static_cast<unsigned long long>(seq));
+        std::ofstream file(config.output_dir + name, std::ios::binary);
+        for (uint32_t row = 0; row < height && file; ++row) {
+            file.write(reinterpret_cast<const char*>(buffer.pixels + static_cast<size_t>(row) * buffer.pitch),
+                       static_cast<std::streamsize>(width) * 4);
+        }
+    }
+
+    void process(const PendingCapture& capture) {
+        pollfd pfd = {capture.fence_fd, POLLIN, 0};
+        int ret = poll(&pfd, 1, FENCE_TIMEOUT_MS);
+        // The fence carries when the hardware finished; the clock after poll() would also count
+        // the time this thread spent on earlier captures
+        uint64_t written_ns = ret > 0 ? fenceSignalNs(capture.fence_fd) : 0;
+        if (written_ns == 0) {
+            written_ns = monotonicNs();
+        }
+        close(capture.fence_fd);
+        if (ret <= 0) {
+            std::cerr << "⚠️ Writeback: capture " << capture.sequence << " fence timeout" << std::endl;
+            std::lock_guard<std::mutex> lock(mutex);
+            capture.buffer->busy = false;
+            return;
+        }
+
+        // Reading a dumb buffer is uncached on many SoCs; this thread absorbs the cost
+        uint64_t sum = checksum(*capture.buffer);
+        uint64_t latency = written_ns > capture.commit_ns ? (written_ns - capture.commit_ns) / 1000 : 0;
+        if (capture.test_pattern) {
+            bool match = checksum(*capture.buffer, RGB_MASK) == pattern_checksum;
+            std::lock_guard<std::mutex> lock(mutex);
+            (match ? stats.verified : stats.mismatches)++;
+            if (match) {
+                std::cout << "✅ Writeback self-check: test pattern captured intact" << std::endl;
+            } else {
+                std::cerr << "❌ Writeback self-check: capture of the test pattern does not match what was committed,"
+                          << " checksums are not trustworthy" << std::endl;
+            }
+        }
+        if (log) {
+            log << capture.sequence << ',' << capture.source_fb_id << ',' << capture.commit_ns << ','
+                << written_ns << ',' << latency << ',' << std::hex << sum << std::dec << '\n';
+        }
+        if (config.dump_frames && !config.output_dir.empty()) {
+            dumpFrame(*capture.buffer, capture.sequence);
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        capture.buffer->busy = false;
+        stats.captured++;
+        if (stats.captured > 1 && sum == last_checksum) {
+            stats.repeated++;
+        }
+        last_checksum = sum;
+        latency_total_us += latency;
+        stats.avg_latency_us = static_cast<double>(latency_total_us) / stats.captured;
+        stats.max_latency_us = std::max<uint64_t>(stats.max_latency_us, latency);
+        if (stats.captured % 300 == 0) {
+            std::cout << "🎞️ Writeback: " << stats.captured << " captured, " << stats.repeated << " repeated, "
+                      << stats.skipped << " skipped, commit->writeback avg " << static_cast<int>(stats.avg_latency_us)
+                      << " us, max " << stats.max_latency_us << " us" << std::endl;
+        }
+    }
+
+    void workerLoop() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            condition.wait(lock, [this] { return !pending.empty() || !running; });
+            if (pending.empty()) {
+                break;  // Stopped and drained
+            }
+            PendingCapture capture = pending.front();
+            pending.pop_front();
+            processing = true;
+            lock.unlock();
+            process(capture);
+            lock.lock();
+            processing = false;
+            if (pending.empty()) {
+                drained.notify_all();
+            }
+        }
+    }
+
+    bool initialize(int fd, uint32_t crtc, uint32_t crtc_index, uint32_t display_width, uint32_t display_height) {
+        drm_fd = fd;
+        crtc_id = crtc;
+        width = display_width;
+        height = display_height;
+
+        if (config.buffer_count == 0 || !findConnector(crtc_index)) {
+            return false;
+        }
+        buffers.resize(config.buffer_count);
+        for (auto& buffer : buffers) {
+            if (!createBuffer(buffer)) {
+                shutdown();
+                return false;
+            }
+        }
+
+        if (!config.output_dir.empty()) {
+            log.open(config.output_dir + "/writeback.csv");
+            if (!log) {
+                std::cerr << "⚠️ Writeback: cannot write " << config.output_dir << "/writeback.csv" << std::endl;
+            } else {
+                log << "sequence,source_fb,commit_ns,written_ns,latency_us,checksum\n";
+            }
+        }
+
+        running = true;
+        worker = std::thread(&Impl::workerLoop, this);
+        pipeline::setThreadName(worker, "writeback");
+
+        std::cout << "✅ Writeback capture: connector " << connector_id << " on CRTC " << crtc_id << ", "
+                  << width << "x" << height << " XRGB8888, " << buffers.size() << " buffers" << std::endl;
+        return true;
+    }
+
+    bool addToCommit(drmModeAtomicReq* req, bool modeset, uint32_t source_fb_id) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (modeset) {
+            drmModeAtomicAddProperty(req, connector_id, crtc_prop, crtc_id);
+        }
+
+        auto it = std::find_if(buffers.begin(), buffers.end(), [](const CaptureBuffer& b) { return !b.busy; });
+        if (it == buffers.end()) {
+            stats.skipped++;
+            return false;
+        }
+
+        out_fence = -1;
+        drmModeAtomicAddProperty(req, connector_id, fb_prop, it->fb_id);
+        drmModeAtomicAddProperty(req, connector_id, fence_prop, reinterpret_cast<uint64_t>(&out_fence));
+        it->busy = true;
+        staged = &*it;
+        staged_source_fb_id = source_fb_id;
+        staged_test_pattern = pattern.fb_id && source_fb_id == pattern.fb_id;
+        staged_commit_ns = monotonicNs();
+        return true;
+    }
+
+    void addUnbind(drmModeAtomicReq* req) {
+        drmModeAtomicAddProperty(req, connector_id, fb_prop, 0);
+        drmModeAtomicAddProperty(req, connector_id, crtc_prop, 0);
+    }
+
+    void commitDone(bool committed) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!staged) {
+            return;
+        }
+        if (committed && out_fence >= 0) {
+            pending.push_back({staged, out_fence, ++sequence, staged_source_fb_id, staged_commit_ns,
+                               staged_test_pattern});
+            condition.notify_one();
+        } else {
+            staged->busy = false;
+        }
+        staged = nullptr;
+        out_fence = -1;
+    }
+
+    bool drain(int timeout_ms) {
+        std::unique_lock<std::mutex> lock(mutex);
+        return drained.wait_for(lock, std::chrono::milliseconds(timeout_ms),
+                                [this] { return (pending.empty() && !processing) || !running; });
+    }
+
+    void shutdown() noexcept {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            running = false;
+        }
+        condition.notify_one();
+        if (worker.joinable()) {
+            worker.join();
+            std::cout << "🎞️ Writeback summary: " << stats.captured << " captured, " << stats.repeated
+                      << " repeated, " << stats.skipped << " skipped, commit->writeback avg "
+                      << static_cast<int>(stats.avg_latency_us) << " us, max " << stats.max_latency_us << " us"
+                      << std::endl;
+        }
+        log.close();
+        for (auto& buffer : buffers) {
+            destroyBuffer(buffer);
+        }
+        buffers.clear();
+        destroyBuffer(pattern);
+    }
+};
+
+WritebackCapture::WritebackCapture(const WritebackConfig& config) : impl_(std::make_unique<Impl>()) {
+    impl_->config = config;
+}
+
+WritebackCapture::~WritebackCapture() {
+    impl_->shutdown();
+}
+
+bool WritebackCapture::initialize(int drm_fd, uint32_t crtc_id, uint32_t crtc_index,
+                                  uint32_t display_width, uint32_t display_height) {
+    return impl_->initialize(drm_fd, crtc_id, crtc_index, display_width, display_height);
+}
+
+bool WritebackCapture::addToCommit(drmModeAtomicReq* req, bool modeset, uint32_t source_fb_id) {
+    return impl_->addToCommit(req, modeset, source_fb_id);
+}
+
+void WritebackCapture::commitDone(bool committed) {
+    impl_->commitDone(committed);
+}
+
+void WritebackCapture::addUnbind(_drmModeAtomicReq* req) {
+    impl_->addUnbind(req);
+}
+
+uint32_t WritebackCapture::testPatternFb() {
+    return impl_->createPattern() ? impl_->pattern.fb_id : 0;
+}
+
+bool WritebackCapture::drain(int timeout_ms) {
+    return impl_->drain(timeout_ms);
+}
+
+WritebackCapture::Statistics WritebackCapture::getStatistics() const {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    return impl_->stats;
+}
+
+void WritebackCapture::shutdown() noexcept {
+    impl_->shutdown();
+}
@@ -0,0 +1,120 @@
+// Timestamps submitted to a V4L2 decoder come back on the decoded frames.
+// Needs hardware: RTP_PLAYER_TEST_DECODER=/dev/videoN and
+// RTP_PLAYER_TEST_STREAM=<Annex-B H.264 file>; skipped (77) otherwise.
+
+#include "v4l2_decoder.h"
+#include <poll.h>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <mutex>
+#include <set>
+#include <vector>
+
+#define CHECK(cond)                                                             \
+    do {                                                                        \
+        if (!(cond)) {                                                          \
+            std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+            std::exit(1);                                                       \
+        }                                                                       \
+    } while (0)
+
+static constexpr int SKIP = 77;
+
+// Start of the next start code at or after pos (data.size() if none)
+static size_t findStartCode(const std::vector<uint8_t>& data, size_t pos) {
+    for (; pos + 3 <= data.size(); ++pos) {
+        if (data[pos] == 0 && data[pos + 1] == 0 && data[pos + 2] == 1) {
+            return (pos > 0 && data[pos - 1] == 0) ? pos - 1 : pos;
+        }
+    }
+    return data.size();
+}
+
+// Split an Annex-B stream into access units: a new one starts at the first
+// slice of a picture, or at SEI / parameter sets / delimiters after a slice
+static std::vector<std::vector<uint8_t>> accessUnits(const std::vector<uint8_t>& data) {
+    std::vector<std::vector<uint8_t>> units;
+    std::vector<uint8_t> current;
+    bool has_slice = false;
+    size_t pos = findStartCode(data, 0);
+    while (pos < data.size()) {
+        size_t header = pos + (data[pos + 2] == 1 ? 3 : 4);
+        size_t next = findStartCode(data, header);
+        if (header < next) {
+            uint8_t type = data[header] & 0x1F;
+            bool slice = type == 1 || type == 5;
+            bool first_slice = slice && header + 1 < next && (data[header + 1] & 0x80);
+            bool starts_unit = first_slice || type == 6 || type == 7 || type == 8 || type == 9;
+            if (starts_unit && has_slice) {
+                units.push_back(std::move(current));
+                current.clear();
+                has_slice = false;
+            }
+            has_slice = has_slice || slice;
+            current.insert(current.end(), data.begin() + pos, data.begin() + next);
+        }
+        pos = next;
+    }
+    if (has_slice) {
+        units.push_back(std::move(current));
+    }
+    return units;
+}
+
+int main() {
+    const char* device = std::getenv("RTP_PLAYER_TEST_DECODER");
+    const char* stream = std::getenv("RTP_PLAYER_TEST_STREAM");
+    if (!device || !stream) {
+        std::printf("decoder_timestamp_test: skipped (RTP_PLAYER_TEST_DECODER / RTP_PLAYER_TEST_STREAM not set)\n");
+        return SKIP;
+    }
+
+    std::ifstream file(stream, std::ios::binary);
+    std::vector<uint8_t> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    std::vector<std::vector<uint8_t>> units = accessUnits(data);
+    CHECK(!units.empty());
+
+    DecoderConfig config;
+    config.device_path = device;
+    config.display.output = DisplayOutput::NONE;
+    V4L2Decoder decoder;
+    if (!decoder.initialize(config) || !decoder.setDisplay()) {
+        std::printf("decoder_timestamp_test: skipped (no usable decoder at %s)\n", device);
+        return SKIP;
+    }
+
+    std::mutex mutex;
+    std::vector<uint32_t> returned;
+    int consumer = decoder.addFrameConsumer([&](const DecodedFrameRef& frame) {
+        std::lock_guard<std::mutex> lock(mutex);
+        returned.push_back(frame->rtp_timestamp);
+    });
+
+    // Start just below the wrap so the extension is exercised too
+    std::set<uint32_t> submitted;
+    uint32_t timestamp = 0xFFFFFFFFu - 4 * 3000;
+    for (const auto& unit : units) {
+        CHECK(decoder.decodeData(unit.data(), unit.size(), timestamp));
+        submitted.insert(timestamp);
+        timestamp += 3000;
+    }
+
+    // Collect what is still in the decoder
+    pollfd pfd{decoder.deviceFd(), POLLIN | POLLPRI, 0};
+    while (poll(&pfd, 1, 500) > 0) {
+        CHECK(decoder.collectFrames());
+    }
+    decoder.removeFrameConsumer(consumer);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    CHECK(!returned.empty());
+    std::set<uint32_t> unique(returned.begin(), returned.end());
+    CHECK(unique.size() == returned.size());
+    for (uint32_t value : returned) {
+        CHECK(submitted.count(value) == 1);
+    }
+    std::printf("decoder_timestamp_test: ok (%zu of %zu frames)\n", returned.size(), units.size());
+    return 0;
+}
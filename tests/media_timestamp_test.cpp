@@ -0,0 +1,71 @@
+// RTP timestamp extension and its round trip through v4l2_buffer.timestamp
+
+#include "media_timestamp.h"
+#include <cstdio>
+#include <cstdlib>
+
+#define CHECK(cond)                                                             \
+    do {                                                                        \
+        if (!(cond)) {                                                          \
+            std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+            std::exit(1);                                                       \
+        }                                                                       \
+    } while (0)
+
+// What vb2 does with the field: timeval to nanoseconds and back
+static timeval throughKernel(const timeval& tv) {
+    uint64_t ns = static_cast<uint64_t>(tv.tv_sec) * 1000000000 + static_cast<uint64_t>(tv.tv_usec) * 1000;
+    timeval out{};
+    out.tv_sec = static_cast<decltype(out.tv_sec)>(ns / 1000000000);
+    out.tv_usec = static_cast<decltype(out.tv_usec)>((ns % 1000000000) / 1000);
+    return out;
+}
+
+static void testUnwrapAcrossWrap() {
+    RtpTimestampUnwrapper unwrapper;
+    uint32_t start = 0xFFFFFFFFu - 2 * 3000;
+    uint64_t first = unwrapper.unwrap(start);
+    CHECK(first == RtpTimestampUnwrapper::FIRST_CYCLE + start);
+
+    uint64_t previous = first;
+    for (uint32_t i = 1; i <= 5; ++i) {
+        uint64_t extended = unwrapper.unwrap(start + i * 3000);
+        CHECK(extended == previous + 3000);
+        CHECK(static_cast<uint32_t>(extended) == start + i * 3000);
+        previous = extended;
+    }
+
+    // A reordered frame from before the wrap
+    CHECK(unwrapper.unwrap(start + 3000) == first + 3000);
+
+    unwrapper.reset();
+    CHECK(unwrapper.unwrap(90000) == RtpTimestampUnwrapper::FIRST_CYCLE + 90000);
+}
+
+static void testBufferRoundTrip() {
+    RtpTimestampUnwrapper unwrapper;
+    const uint32_t samples[] = {0, 1, 999999, 1000000, 0x7FFFFFFFu, 0xFFFFFFFFu};
+    for (uint32_t sample : samples) {
+        unwrapper.reset();
+        uint64_t extended = unwrapper.unwrap(sample);
+        timeval tv = rtpToBufferTimestamp(extended);
+        CHECK(tv.tv_usec < 1000000);
+        uint64_t back = rtpFromBufferTimestamp(throughKernel(tv));
+        CHECK(back == extended);
+        CHECK(static_cast<uint32_t>(back) == sample);
+    }
+}
+
+static void testMediaTime() {
+    CHECK(rtpToMediaTime(RtpTimestampUnwrapper::FIRST_CYCLE).count() == 0);
+    CHECK(rtpToMediaTime(RtpTimestampUnwrapper::FIRST_CYCLE + 90000).count() == 1000000);
+    CHECK(rtpToMediaTime(RtpTimestampUnwrapper::FIRST_CYCLE - 3000).count() < 0);
+}
+
+int main() {
+    testUnwrapAcrossWrap();
+    testBufferRoundTrip();
+    testMediaTime();
+    std::printf("media_timestamp_test: ok\n");
+    return 0;
+}
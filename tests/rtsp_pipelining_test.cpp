@@ -0,0 +1,201 @@
+// Round trips an RtspClient needs to start a session, against a scripted
+// server on loopback. Requests that arrive together count as one exchange.
+
+#include "rtsp_client.h"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+#define CHECK(cond)                                                             \
+    do {                                                                        \
+        if (!(cond)) {                                                          \
+            std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+            std::exit(1);                                                       \
+        }                                                                       \
+    } while (0)
+
+namespace {
+
+// Requests closer together than this were sent without waiting for a response
+constexpr int BATCH_GAP_MS = 50;
+
+const char SDP[] =
+    "v=0\r\n"
+    "o=- 0 0 IN IP4 127.0.0.1\r\n"
+    "s=test\r\n"
+    "t=0 0\r\n"
+    "m=video 0 RTP/AVP 96\r\n"
+    "a=rtpmap:96 H264/90000\r\n"
+    "a=control:track1\r\n";
+
+struct ServerResult {
+    int exchanges_to_play = 0;      // Exchanges up to the accepted PLAY
+    bool setup_and_play_together = false;
+    int rejected_plays = 0;
+};
+
+std::string header(const std::string& request, const std::string& name) {
+    size_t pos = request.find("\r\n" + name + ":");
+    if (pos == std::string::npos) {
+        return {};
+    }
+    pos += name.size() + 3;
+    size_t end = request.find("\r\n", pos);
+    std::string value = request.substr(pos, end - pos);
+    return value.substr(value.find_first_not_of(' '));
+}
+
+class ScriptedServer {
+public:
+    // strict: PLAY without a Session header gets 454, as RTSP/1.0 servers do
+    explicit ScriptedServer(bool strict) : strict_(strict) {
+        listen_fd_ = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        CHECK(listen_fd_ >= 0);
+        sockaddr_in addr = {};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        CHECK(bind(listen_fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0);
+        CHECK(listen(listen_fd_, 1) == 0);
+        socklen_t len = sizeof(addr);
+        CHECK(getsockname(listen_fd_, reinterpret_cast<sockaddr*>(&addr), &len) == 0);
+        port_ = ntohs(addr.sin_port);
+        thread_ = std::thread(&ScriptedServer::run, this);
+    }
+
+    ~ScriptedServer() {
+        if (thread_.joinable()) {
+            thread_.join();
+        }
+        close(listen_fd_);
+    }
+
+    [[nodiscard]] uint16_t port() const { return port_; }
+
+    ServerResult finish() {
+        thread_.join();
+        return result_;
+    }
+
+private:
+    void run() {
+        int fd = accept4(listen_fd_, nullptr, nullptr, SOCK_CLOEXEC);
+        CHECK(fd >= 0);
+
+        std::string buffer;
+        bool playing = false;
+        int exchanges = 0;
+        while (true) {
+            // One exchange: everything the client sends before it needs an answer
+            if (!readBatch(fd, buffer, 2000)) {
+                break;
+            }
+            ++exchanges;
+
+            std::vector<std::string> requests;
+            size_t end;
+            while ((end = buffer.find("\r\n\r\n")) != std::string::npos) {
+                requests.push_back(buffer.substr(0, end + 2));
+                buffer.erase(0, end + 4);
+            }
+
+            bool saw_setup = false;
+            bool done = false;
+            std::string responses;
+            for (const auto& request : requests) {
+                std::string method = request.substr(0, request.find(' '));
+                std::string reply = "RTSP/1.0 200 OK\r\nCSeq: " + header(request, "CSeq") + "\r\n";
+                if (method == "DESCRIBE") {
+                    reply += "Content-Type: application/sdp\r\nContent-Length: " +
+                             std::to_string(sizeof(SDP) - 1) + "\r\n\r\n" + SDP;
+                    responses += reply;
+                    continue;
+                }
+                if (method == "SETUP") {
+                    saw_setup = true;
+                    reply += "Session: 12345678;timeout=60\r\n"
+                             "Transport: " + header(request, "Transport") + "\r\n";
+                } else if (method == "PLAY") {
+                    if (strict_ && header(request, "Session").empty()) {
+                        reply = "RTSP/1.0 454 Session Not Found\r\nCSeq: " + header(request, "CSeq") + "\r\n";
+                        ++result_.rejected_plays;
+                    } else {
+                        reply += "Session: 12345678\r\n";
+                        if (!playing) {
+                            playing = true;
+                            result_.exchanges_to_play = exchanges;
+                            result_.setup_and_play_together = saw_setup;
+                        }
+                    }
+                } else if (method == "TEARDOWN") {
+                    done = true;
+                }
+                responses += reply + "\r\n";
+            }
+            CHECK(send(fd, responses.data(), responses.size(), MSG_NOSIGNAL) ==
+                  static_cast<ssize_t>(responses.size()));
+            if (done) {
+                break;
+            }
+        }
+        close(fd);
+    }
+
+    // Wait up to timeout_ms for data, then read until the client pauses
+    static bool readBatch(int fd, std::string& buffer, int timeout_ms) {
+        pollfd pfd = {fd, POLLIN, 0};
+        bool any = false;
+        while (poll(&pfd, 1, any ? BATCH_GAP_MS : timeout_ms) > 0) {
+            char chunk[4096];
+            ssize_t received = recv(fd, chunk, sizeof(chunk), 0);
+            if (received <= 0) {
+                break;
+            }
+            buffer.append(chunk, static_cast<size_t>(received));
+            any = true;
+        }
+        return any;
+    }
+
+    bool strict_;
+    int listen_fd_ = -1;
+    uint16_t port_ = 0;
+    std::thread thread_;
+    ServerResult result_;
+};
+
+ServerResult runSession(bool strict) {
+    ScriptedServer server(strict);
+    RtspClient::Config config;
+    config.url = "rtsp://127.0.0.1:" + std::to_string(server.port()) + "/stream";
+    config.transport = RtspClient::Transport::UDP;
+    config.timeout_ms = 2000;
+    RtspClient client(config);
+    CHECK(client.start());
+    client.stop();
+    return server.finish();
+}
+
+}  // namespace
+
+int main() {
+    // SETUP and PLAY in one exchange: DESCRIBE plus one round trip
+    ServerResult tolerant = runSession(false);
+    CHECK(tolerant.setup_and_play_together);
+    CHECK(tolerant.exchanges_to_play == 2);
+    CHECK(tolerant.rejected_plays == 0);
+
+    // The early PLAY is rejected and resent: no worse than not pipelining
+    ServerResult strict = runSession(true);
+    CHECK(strict.rejected_plays == 1);
+    CHECK(strict.exchanges_to_play == 3);
+
+    std::printf("rtsp_pipelining_test: ok\n");
+    return 0;
+}